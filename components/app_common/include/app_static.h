@@ -0,0 +1,85 @@
+/*
+ * app_static.h
+ *
+ *  Created on: 19 oct 2026
+ *      Author: Filippo
+ */
+
+#ifndef COMPONENTS_APP_STATIC_H_
+#	define COMPONENTS_APP_STATIC_H_
+
+#	include "freertos/FreeRTOS.h"
+#	include "freertos/task.h"
+#	include "freertos/queue.h"
+#	include "freertos/semphr.h"
+#	include "freertos/event_groups.h"
+#	include "sdkconfig.h"
+
+// Object creation for CONFIG_APP_STATIC_ALLOCATION. The static versions
+// declare their storage at the call site, so a call site creates one
+// object for the whole run: never use them in a loop or for objects
+// that are deleted and created again.
+//
+#	if CONFIG_APP_STATIC_ALLOCATION
+
+// Stack sizes are in bytes and StackType_t is a byte
+//
+#		define APP_TASK_CREATE_PINNED(task, p_name, stack_size, p_param, priority, core_id)	\
+	({																						\
+		static StackType_t s_stack[(stack_size)];											\
+		static StaticTask_t s_task;															\
+		xTaskCreateStaticPinnedToCore((task), (p_name), (stack_size), (p_param),			\
+									  (priority), s_stack, &s_task, (core_id));				\
+	})
+
+#		define APP_QUEUE_CREATE(length, item_size)											\
+	({																						\
+		static uint8_t s_storage[(length) * (item_size)];									\
+		static StaticQueue_t s_queue;														\
+		xQueueCreateStatic((length), (item_size), s_storage, &s_queue);					\
+	})
+
+#		define APP_EVENT_GROUP_CREATE()													\
+	({																						\
+		static StaticEventGroup_t s_event_group;											\
+		xEventGroupCreateStatic(&s_event_group);											\
+	})
+
+#		define APP_SEMAPHORE_CREATE_BINARY()												\
+	({																						\
+		static StaticSemaphore_t s_semaphore;												\
+		xSemaphoreCreateBinaryStatic(&s_semaphore);										\
+	})
+
+#		define APP_MUTEX_CREATE()															\
+	({																						\
+		static StaticSemaphore_t s_mutex;													\
+		xSemaphoreCreateMutexStatic(&s_mutex);												\
+	})
+
+#	else
+
+#		define APP_TASK_CREATE_PINNED(task, p_name, stack_size, p_param, priority, core_id)	\
+	app_task_create_pinned((task), (p_name), (stack_size), (p_param), (priority), (core_id))
+
+#		define APP_QUEUE_CREATE(length, item_size)	xQueueCreate((length), (item_size))
+#		define APP_EVENT_GROUP_CREATE()				xEventGroupCreate()
+#		define APP_SEMAPHORE_CREATE_BINARY()			xSemaphoreCreateBinary()
+#		define APP_MUTEX_CREATE()					xSemaphoreCreateMutex()
+
+static inline TaskHandle_t
+app_task_create_pinned (TaskFunction_t task, const char * p_name,
+						uint32_t stack_size, void * p_param,
+						UBaseType_t priority, BaseType_t core_id)
+{
+	TaskHandle_t h_task = NULL;
+
+	xTaskCreatePinnedToCore(task, p_name, stack_size, p_param, priority,
+							&h_task, core_id);
+
+	return h_task;
+}
+
+#	endif
+
+#endif /* COMPONENTS_APP_STATIC_H_ */
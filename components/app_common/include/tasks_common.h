@@ -0,0 +1,26 @@
+/*
+ * tasks_common.h
+ *
+ *  Created on: 8 apr 2023
+ *      Author: Filippo
+ */
+
+#ifndef COMPONENTS_TASKS_COMMON_H_
+#	define COMPONENTS_TASKS_COMMON_H_
+
+// Priorities and cores come from the task_plan component
+//
+#	define WIFI_APP_TASK_STACK_SIZE			4096
+#	define HTTP_SERVER_TASK_STACK_SIZE		4096
+#	define HTTP_SERVER_MONITOR_STACK_SIZE	4096
+// The upload handler runs inflate, bspatch, SHA-256 and the signature
+// check of ota_app like the pull task does, with the same stack
+//
+#	define HTTP_SERVER_BULK_TASK_STACK_SIZE	8192
+#	define BUTTON_TASK_STACK_SIZE			2048
+#	define AWS_IOT_TASK_STACK_SIZE			9216
+#	define OTA_APP_PULL_TASK_STACK_SIZE		8192
+#	define CAPTIVE_DNS_TASK_STACK_SIZE		3072
+#	define RGB_LED_TASK_STACK_SIZE			2048
+
+#endif /* COMPONENTS_TASKS_COMMON_H_ */
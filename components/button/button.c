@@ -0,0 +1,363 @@
+/*
+ * button.c
+ *
+ *  Created on: 19 oct 2026
+ *      Author: Filippo
+ */
+
+#include "button.h"
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "driver/gpio.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+#include "sdkconfig.h"
+#include "tasks_common.h"
+#include "task_plan.h"
+#include "app_static.h"
+
+typedef struct button
+{
+	button_config_t config;
+	bool b_pressed;					// Debounced level
+	bool b_long_sent;
+	uint16_t held_ms;				// Press waiting for the double window
+	int64_t press_ms;
+	int64_t debounce_ms;			// Deadlines, 0 when not running
+	int64_t double_ms;
+} button_t;
+
+static const char g_tag[] = "button";
+
+static TaskHandle_t gh_button_task = NULL;
+static button_t g_buttons[CONFIG_BUTTON_MAX] = {0};
+static uint8_t g_button_count = 0;
+
+// The count grows while the task runs, an entry is complete before it
+// is counted
+//
+static portMUX_TYPE g_button_mux = portMUX_INITIALIZER_UNLOCKED;
+
+static void task_button(void * p_param);
+static void IRAM_ATTR isr_button_handler(void * p_arg);
+static void button_update(uint8_t id, int64_t now_ms);
+static void button_released(uint8_t id, int64_t now_ms);
+static void button_send(uint8_t id, button_event_type_t type, uint16_t held_ms);
+static TickType_t button_next_wait(uint8_t count, int64_t now_ms);
+static bool button_is_pressed(const button_config_t * p_config);
+static int64_t button_now_ms(void);
+
+esp_err_t
+button_register (const button_config_t * p_config, uint8_t * p_id)
+{
+	gpio_config_t io_config = {0};
+	esp_err_t ret = ESP_OK;
+	uint8_t id = 0;
+
+	if ((NULL == p_config) || (false == GPIO_IS_VALID_GPIO(p_config->gpio)) ||
+		((NULL == p_config->h_queue) && (NULL == p_config->cb)))
+	{
+		return ESP_ERR_INVALID_ARG;
+	}
+
+	if (NULL == gh_button_task)
+	{
+		gh_button_task = APP_TASK_CREATE_PINNED(task_button,
+												"button",
+												BUTTON_TASK_STACK_SIZE,
+												NULL,
+												task_plan_get(TASK_PLAN_BUTTON)->priority,
+												task_plan_get(TASK_PLAN_BUTTON)->core_id);
+
+		if (NULL == gh_button_task)
+		{
+			return ESP_ERR_NO_MEM;
+		}
+
+		// Other components may have installed the service already
+		//
+		ret = gpio_install_isr_service(0);
+
+		if ((ESP_OK != ret) && (ESP_ERR_INVALID_STATE != ret))
+		{
+			return ret;
+		}
+	}
+
+	portENTER_CRITICAL(&g_button_mux);
+	id = g_button_count;
+	portEXIT_CRITICAL(&g_button_mux);
+
+	if (id >= CONFIG_BUTTON_MAX)
+	{
+		return ESP_ERR_NO_MEM;
+	}
+
+	// Both edges wake the task, the level is only read once it has been
+	// stable for the debounce time
+	//
+	io_config.pin_bit_mask = 1ULL << p_config->gpio;
+	io_config.mode = GPIO_MODE_INPUT;
+	io_config.pull_up_en = (true == p_config->b_active_low) ?
+						   GPIO_PULLUP_ENABLE : GPIO_PULLUP_DISABLE;
+	io_config.pull_down_en = (true == p_config->b_active_low) ?
+							 GPIO_PULLDOWN_DISABLE : GPIO_PULLDOWN_ENABLE;
+	io_config.intr_type = GPIO_INTR_ANYEDGE;
+
+	ret = gpio_config(&io_config);
+
+	if (ESP_OK != ret)
+	{
+		return ret;
+	}
+
+	g_buttons[id].config = *p_config;
+	g_buttons[id].b_pressed = button_is_pressed(p_config);
+
+	// A button held at boot does not count as a press
+	//
+	g_buttons[id].b_long_sent = g_buttons[id].b_pressed;
+
+	portENTER_CRITICAL(&g_button_mux);
+	++g_button_count;
+	portEXIT_CRITICAL(&g_button_mux);
+
+	ret = gpio_isr_handler_add(p_config->gpio, isr_button_handler,
+							   (void *) (uintptr_t) id);
+
+	if (ESP_OK != ret)
+	{
+		return ret;
+	}
+
+	ESP_LOGI(g_tag, "button %u on GPIO %d", id, p_config->gpio);
+
+	if (NULL != p_id)
+	{
+		*p_id = id;
+	}
+
+	return ESP_OK;
+}
+
+// Sleeps until an edge or the nearest deadline, there is no polling
+//
+static void
+task_button (void * p_param)
+{
+	uint32_t edges = 0;
+	uint8_t count = 0;
+	int64_t now_ms = 0;
+
+	for (;;)
+	{
+		portENTER_CRITICAL(&g_button_mux);
+		count = g_button_count;
+		portEXIT_CRITICAL(&g_button_mux);
+
+		edges = 0;
+		xTaskNotifyWait(0, UINT32_MAX, &edges,
+						button_next_wait(count, button_now_ms()));
+
+		// A button added during the wait may have sent the edge
+		//
+		portENTER_CRITICAL(&g_button_mux);
+		count = g_button_count;
+		portEXIT_CRITICAL(&g_button_mux);
+
+		now_ms = button_now_ms();
+
+		for (uint8_t id = 0; id < count; ++id)
+		{
+			// Any number of bounces only moves the deadline
+			//
+			if (0 != (edges & (1UL << id)))
+			{
+				g_buttons[id].debounce_ms = now_ms + CONFIG_BUTTON_DEBOUNCE_MS;
+			}
+
+			button_update(id, now_ms);
+		}
+	}
+}
+
+// Edges since the last wake up are merged in the notification value,
+// one bit per button
+//
+static void IRAM_ATTR
+isr_button_handler (void * p_arg)
+{
+	BaseType_t b_woken = pdFALSE;
+
+	xTaskNotifyFromISR(gh_button_task, 1UL << (uintptr_t) p_arg, eSetBits,
+					   &b_woken);
+
+	if (pdTRUE == b_woken)
+	{
+		portYIELD_FROM_ISR();
+	}
+}
+
+static void
+button_update (uint8_t id, int64_t now_ms)
+{
+	button_t * p_button = &g_buttons[id];
+
+	if ((0 != p_button->debounce_ms) && (now_ms >= p_button->debounce_ms))
+	{
+		bool b_pressed = button_is_pressed(&p_button->config);
+
+		p_button->debounce_ms = 0;
+
+		if ((true == b_pressed) && (false == p_button->b_pressed))
+		{
+			p_button->b_pressed = true;
+			p_button->b_long_sent = false;
+			p_button->press_ms = now_ms;
+		}
+		else if ((false == b_pressed) && (true == p_button->b_pressed))
+		{
+			p_button->b_pressed = false;
+			button_released(id, now_ms);
+		}
+	}
+
+	// A long press is reported while held, the release adds nothing
+	//
+	if ((true == p_button->b_pressed) && (false == p_button->b_long_sent) &&
+		(now_ms - p_button->press_ms >= CONFIG_BUTTON_LONG_PRESS_MS))
+	{
+		p_button->b_long_sent = true;
+		p_button->double_ms = 0;
+		button_send(id, BUTTON_EVENT_LONG_PRESS,
+					(uint16_t) (now_ms - p_button->press_ms));
+	}
+
+	// The second press has to start within the window, it may end later
+	//
+	if ((0 != p_button->double_ms) && (false == p_button->b_pressed) &&
+		(now_ms >= p_button->double_ms))
+	{
+		p_button->double_ms = 0;
+		button_send(id, BUTTON_EVENT_SHORT_PRESS, p_button->held_ms);
+	}
+}
+
+static void
+button_released (uint8_t id, int64_t now_ms)
+{
+	button_t * p_button = &g_buttons[id];
+	int64_t held_ms = now_ms - p_button->press_ms;
+
+	if (held_ms > UINT16_MAX)
+	{
+		held_ms = UINT16_MAX;
+	}
+
+	if (true == p_button->b_long_sent)
+	{
+		return;
+	}
+
+	if (false == p_button->config.b_double_press)
+	{
+		button_send(id, BUTTON_EVENT_SHORT_PRESS, (uint16_t) held_ms);
+	}
+	else if (0 != p_button->double_ms)
+	{
+		p_button->double_ms = 0;
+		button_send(id, BUTTON_EVENT_DOUBLE_PRESS, (uint16_t) held_ms);
+	}
+	else
+	{
+		p_button->double_ms = now_ms + CONFIG_BUTTON_DOUBLE_PRESS_MS;
+		p_button->held_ms = (uint16_t) held_ms;
+	}
+}
+
+static void
+button_send (uint8_t id, button_event_type_t type, uint16_t held_ms)
+{
+	button_event_t event = {
+		.button_id = id,
+		.type = type,
+		.held_ms = held_ms
+	};
+
+	ESP_LOGI(g_tag, "button %u: event %d after %u ms", id, type, held_ms);
+
+	if (NULL != g_buttons[id].config.h_queue)
+	{
+		if (pdTRUE != xQueueSend(g_buttons[id].config.h_queue, &event, 0))
+		{
+			ESP_LOGW(g_tag, "button %u: queue full, event dropped", id);
+		}
+	}
+	else
+	{
+		g_buttons[id].config.cb(&event, g_buttons[id].config.p_arg);
+	}
+}
+
+// Ticks to the nearest debounce, long press or double press deadline
+//
+static TickType_t
+button_next_wait (uint8_t count, int64_t now_ms)
+{
+	int64_t next_ms = INT64_MAX;
+	TickType_t ticks = 0;
+
+	for (uint8_t id = 0; id < count; ++id)
+	{
+		const button_t * p_button = &g_buttons[id];
+
+		if ((0 != p_button->debounce_ms) && (p_button->debounce_ms < next_ms))
+		{
+			next_ms = p_button->debounce_ms;
+		}
+
+		if ((true == p_button->b_pressed) && (false == p_button->b_long_sent) &&
+			(p_button->press_ms + CONFIG_BUTTON_LONG_PRESS_MS < next_ms))
+		{
+			next_ms = p_button->press_ms + CONFIG_BUTTON_LONG_PRESS_MS;
+		}
+
+		if ((0 != p_button->double_ms) && (false == p_button->b_pressed) &&
+			(p_button->double_ms < next_ms))
+		{
+			next_ms = p_button->double_ms;
+		}
+	}
+
+	if (INT64_MAX == next_ms)
+	{
+		return portMAX_DELAY;
+	}
+
+	if (next_ms <= now_ms)
+	{
+		return 0;
+	}
+
+	// Rounded up, waking early would only sleep again
+	//
+	ticks = (TickType_t) ((next_ms - now_ms + portTICK_PERIOD_MS - 1) /
+						  portTICK_PERIOD_MS);
+
+	return ticks;
+}
+
+static bool
+button_is_pressed (const button_config_t * p_config)
+{
+	int level = gpio_get_level(p_config->gpio);
+
+	return (true == p_config->b_active_low) ? (0 == level) : (1 == level);
+}
+
+static int64_t
+button_now_ms (void)
+{
+	return esp_timer_get_time() / 1000;
+}
@@ -0,0 +1,49 @@
+/*
+ * button.h
+ *
+ *  Created on: 19 oct 2026
+ *      Author: Filippo
+ */
+
+#ifndef COMPONENTS_BUTTON_H_
+#	define COMPONENTS_BUTTON_H_
+
+#	include <stdbool.h>
+#	include <stdint.h>
+#	include "freertos/FreeRTOS.h"
+#	include "freertos/queue.h"
+#	include "esp_err.h"
+
+typedef enum button_event_type
+{
+	BUTTON_EVENT_SHORT_PRESS = 0,
+	BUTTON_EVENT_LONG_PRESS,		// Sent while the button is still held
+	BUTTON_EVENT_DOUBLE_PRESS
+} button_event_type_t;
+
+typedef struct button_event
+{
+	uint8_t button_id;
+	uint8_t type;					// button_event_type_t
+	uint16_t held_ms;				// Of the last press
+} button_event_t;
+
+typedef void (*button_cb_t)(const button_event_t * p_event, void * p_arg);
+
+typedef struct button_config
+{
+	int32_t gpio;
+	bool b_active_low;				// Pressed reads 0, the pull-up is enabled
+	bool b_double_press;			// Holds a short press back for the double window
+	QueueHandle_t h_queue;			// Receives button_event_t, not blocking
+	button_cb_t cb;					// Or runs on the button task
+	void * p_arg;
+} button_config_t;
+
+// Adds a button, the shared task and the GPIO ISR service start with the
+// first one. Events go to the queue when there is one, to the callback
+// otherwise.
+//
+esp_err_t button_register(const button_config_t * p_config, uint8_t * p_id);
+
+#endif /* COMPONENTS_BUTTON_H_ */
@@ -0,0 +1,197 @@
+/*
+ * captive_dns.c
+ *
+ *  Created on: 19 oct 2026
+ *      Author: Filippo
+ */
+
+#include "captive_dns.h"
+#include <stdbool.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "lwip/sockets.h"
+#include "esp_log.h"
+#include "tasks_common.h"
+#include "task_plan.h"
+#include "app_static.h"
+
+#define CAPTIVE_DNS_PORT			53
+
+// Plain DNS over UDP, no EDNS: 512 bytes at most
+//
+#define CAPTIVE_DNS_MSG_SIZE		512
+#define CAPTIVE_DNS_HEADER_LEN		12
+
+// Name pointer to the question, type, class, TTL, length, address
+//
+#define CAPTIVE_DNS_ANSWER_LEN		16
+#define CAPTIVE_DNS_TTL_S			60
+
+#define CAPTIVE_DNS_TYPE_A			1
+#define CAPTIVE_DNS_CLASS_IN		1
+
+static const char g_tag[] = "captive_dns";
+
+static bool gb_started = false;
+static uint32_t g_ap_ip = 0;
+
+// Only the DNS task uses it, off its stack
+//
+static uint8_t g_msg[CAPTIVE_DNS_MSG_SIZE] = {0};
+
+static void task_captive_dns(void * p_param);
+static size_t captive_dns_answer(uint8_t * p_msg, size_t len);
+
+void
+captive_dns_start (uint32_t ap_ip)
+{
+	if (true == gb_started)
+	{
+		return;
+	}
+
+	gb_started = true;
+	g_ap_ip = ap_ip;
+
+	APP_TASK_CREATE_PINNED(task_captive_dns,
+						   "captive_dns",
+						   CAPTIVE_DNS_TASK_STACK_SIZE,
+						   NULL,
+						   task_plan_get(TASK_PLAN_CAPTIVE_DNS)->priority,
+						   task_plan_get(TASK_PLAN_CAPTIVE_DNS)->core_id);
+}
+
+static void
+task_captive_dns (void * p_param)
+{
+	struct sockaddr_in addr = {0};
+	struct sockaddr_in from = {0};
+	socklen_t from_len = 0;
+	int32_t len = 0;
+	size_t answer_len = 0;
+	int sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+
+	// Bound to the access point address: the station side keeps its own
+	// DNS
+	//
+	addr.sin_family = AF_INET;
+	addr.sin_port = htons(CAPTIVE_DNS_PORT);
+	addr.sin_addr.s_addr = g_ap_ip;
+
+	if ((sock < 0) || (0 != bind(sock, (struct sockaddr *) &addr, sizeof(addr))))
+	{
+		ESP_LOGE(g_tag, "task_captive_dns: no socket on port %d (errno %d)",
+				 CAPTIVE_DNS_PORT, errno);
+
+		if (sock >= 0)
+		{
+			close(sock);
+		}
+
+		vTaskDelete(NULL);
+
+		return;
+	}
+
+	ESP_LOGI(g_tag, "answering DNS queries with %s", inet_ntoa(addr.sin_addr));
+
+	for (;;)
+	{
+		from_len = sizeof(from);
+		len = recvfrom(sock, g_msg, sizeof(g_msg), 0,
+					   (struct sockaddr *) &from, &from_len);
+
+		if (len <= 0)
+		{
+			continue;
+		}
+
+		answer_len = captive_dns_answer(g_msg, (size_t) len);
+
+		if (answer_len > 0)
+		{
+			sendto(sock, g_msg, answer_len, 0,
+				   (struct sockaddr *) &from, from_len);
+		}
+	}
+}
+
+// Turns the query in p_msg into its answer, in place. Returns the answer
+// length, 0 to drop the message.
+//
+static size_t
+captive_dns_answer (uint8_t * p_msg, size_t len)
+{
+	size_t pos = CAPTIVE_DNS_HEADER_LEN;
+	uint16_t qtype = 0;
+	uint16_t qclass = 0;
+	bool b_address = false;
+
+	// Standard queries with one question only
+	//
+	if ((len < CAPTIVE_DNS_HEADER_LEN) || (0 != (p_msg[2] & 0x80)) ||
+		(0 != ((p_msg[2] >> 3) & 0x0F)) || (0 != p_msg[4]) || (1 != p_msg[5]))
+	{
+		return 0;
+	}
+
+	// Labels up to the root, a query has no compressed names
+	//
+	while ((pos < len) && (0 != p_msg[pos]))
+	{
+		if (0 != (p_msg[pos] & 0xC0))
+		{
+			return 0;
+		}
+
+		pos += p_msg[pos] + 1;
+	}
+
+	if (pos + 5 > len)
+	{
+		return 0;
+	}
+
+	qtype = (uint16_t) ((p_msg[pos + 1] << 8) | p_msg[pos + 2]);
+	qclass = (uint16_t) ((p_msg[pos + 3] << 8) | p_msg[pos + 4]);
+	pos += 5;
+
+	b_address = (CAPTIVE_DNS_TYPE_A == qtype) && (CAPTIVE_DNS_CLASS_IN == qclass);
+
+	if ((true == b_address) && (pos + CAPTIVE_DNS_ANSWER_LEN > CAPTIVE_DNS_MSG_SIZE))
+	{
+		return 0;
+	}
+
+	// Response, authoritative, recursion desired copied, no error. The
+	// additional records of the query (EDNS) are dropped.
+	//
+	p_msg[2] = (uint8_t) (0x84 | (p_msg[2] & 0x01));
+	p_msg[3] = 0;
+	p_msg[6] = 0;
+	p_msg[7] = (true == b_address) ? 1 : 0;
+	memset(&p_msg[8], 0, 4);
+
+	if (false == b_address)
+	{
+		return pos;
+	}
+
+	p_msg[pos++] = 0xC0;
+	p_msg[pos++] = CAPTIVE_DNS_HEADER_LEN;
+	p_msg[pos++] = 0;
+	p_msg[pos++] = CAPTIVE_DNS_TYPE_A;
+	p_msg[pos++] = 0;
+	p_msg[pos++] = CAPTIVE_DNS_CLASS_IN;
+	p_msg[pos++] = 0;
+	p_msg[pos++] = 0;
+	p_msg[pos++] = 0;
+	p_msg[pos++] = CAPTIVE_DNS_TTL_S;
+	p_msg[pos++] = 0;
+	p_msg[pos++] = 4;
+	memcpy(&p_msg[pos], &g_ap_ip, 4);
+	pos += 4;
+
+	return pos;
+}
@@ -0,0 +1,20 @@
+/*
+ * captive_dns.h
+ *
+ *  Created on: 19 oct 2026
+ *      Author: Filippo
+ */
+
+#ifndef COMPONENTS_CAPTIVE_DNS_H_
+#	define COMPONENTS_CAPTIVE_DNS_H_
+
+#	include <stdint.h>
+
+// Starts answering every DNS query made to the access point with its
+// own address (network byte order), so the clients find the captive
+// portal by themselves. Only A records are answered, other types get
+// an empty answer and the clients fall back to IPv4.
+//
+void captive_dns_start(uint32_t ap_ip);
+
+#endif /* COMPONENTS_CAPTIVE_DNS_H_ */
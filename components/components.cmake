@@ -0,0 +1,21 @@
+# Shared components used by the example projects.
+#
+# Include this file from a project CMakeLists.txt before project.cmake and
+# append COMMON_COMPONENT_DIRS to EXTRA_COMPONENT_DIRS. Features are then
+# selected per project through Kconfig (see sdkconfig.defaults).
+set(COMMON_COMPONENT_DIRS "${CMAKE_CURRENT_LIST_DIR}/app_common"
+                          "${CMAKE_CURRENT_LIST_DIR}/rgb_led"
+                          "${CMAKE_CURRENT_LIST_DIR}/wifi_app"
+                          "${CMAKE_CURRENT_LIST_DIR}/captive_dns"
+                          "${CMAKE_CURRENT_LIST_DIR}/http_server"
+                          "${CMAKE_CURRENT_LIST_DIR}/nvs_app"
+                          "${CMAKE_CURRENT_LIST_DIR}/sntp_time_sync"
+                          "${CMAKE_CURRENT_LIST_DIR}/button"
+                          "${CMAKE_CURRENT_LIST_DIR}/wifi_reset_button"
+                          "${CMAKE_CURRENT_LIST_DIR}/sensor"
+                          "${CMAKE_CURRENT_LIST_DIR}/metrics"
+                          "${CMAKE_CURRENT_LIST_DIR}/trace"
+                          "${CMAKE_CURRENT_LIST_DIR}/log_defer"
+                          "${CMAKE_CURRENT_LIST_DIR}/task_plan"
+                          "${CMAKE_CURRENT_LIST_DIR}/ota_app"
+)
@@ -0,0 +1,1372 @@
+/*
+ * http_server.c
+ *
+ *  Created on: 9 apr 2023
+ *      Author: Filippo
+ */
+
+#include "http_server.h"
+#include "esp_http_server.h"
+#include "esp_log.h"
+#include "tasks_common.h"
+#include "wifi_app.h"
+#include "wifi_app_scan.h"
+#include "esp_ota_ops.h"
+#include "sys/param.h"
+#include "stdint.h"
+#include "esp_wifi.h"
+#include "sensor.h"
+#include "sensor_log.h"
+#include "sntp_time_sync.h"
+#include "metrics.h"
+#include "trace.h"
+#include "log_defer.h"
+#include "task_plan.h"
+#include "app_static.h"
+#include "http_server_scratch.h"
+#include "http_server_conn.h"
+#include "http_server_export.h"
+#include "http_server_portal.h"
+#include "http_server_multipart.h"
+#include "ota_app.h"
+#include "ota_app_firmware.h"
+#include "ota_app_health.h"
+#include "sdkconfig.h"
+
+static const char g_tag[] = "http_server";
+
+static int32_t g_wifi_connect_status = NONE;
+
+// Task handler
+//
+static httpd_handle_t g_http_server_handle = NULL;
+
+#if CONFIG_HTTP_SERVER_BULK
+// Second server for the uploads and exports, on its own task
+//
+static httpd_handle_t g_http_bulk_handle = NULL;
+#endif
+
+// HTTP monitor task handler
+//
+static TaskHandle_t g_task_http_server_monitor = NULL;
+
+// Queue to manipulate the main queue of events
+//
+static QueueHandle_t g_http_server_queue = NULL;
+
+// Firmware update status
+//
+static int32_t g_fw_update_status = OTA_UPDATE_PENDING;
+
+static const esp_timer_create_args_t g_fw_update_reset_args = {
+	.callback = http_server_fw_update_reset_callback,
+	.arg = NULL,
+	.dispatch_method = ESP_TIMER_TASK,
+	.name = "fw_update_reset"
+};
+
+esp_timer_handle_t gh_fw_update_reset = NULL;
+
+extern esp_netif_t * gp_esp_netif_sta;
+// Embedded dashboard: index.html with JQuery, js, css and ico inlined,
+// gzipped at build time by tools/web_bundle.py
+//
+extern const uint8_t g_index_html_gz_start[] asm("_binary_index_html_gz_start");
+extern const uint8_t g_index_html_gz_end[] asm("_binary_index_html_gz_end");
+
+static httpd_handle_t http_server_configure(void);
+#if CONFIG_HTTP_SERVER_BULK
+static httpd_handle_t http_server_bulk_configure(void);
+#endif
+static void http_server_register_bulk(httpd_handle_t h_server);
+static esp_err_t http_server_index_html_handler(httpd_req_t * p_req);
+#if CONFIG_HTTP_SERVER_OTA
+static esp_err_t http_server_ota_update_handler(httpd_req_t * p_req);
+static esp_err_t http_server_ota_status_handler(httpd_req_t * p_req);
+static esp_err_t http_server_ota_progress_handler(httpd_req_t * p_req);
+static esp_err_t http_server_firmware_json_handler(httpd_req_t * p_req);
+#endif
+#if CONFIG_HTTP_SERVER_SENSOR
+static esp_err_t http_server_get_dht_sensor_readings_json_handler(httpd_req_t * p_req);
+#endif
+#if CONFIG_HTTP_SERVER_WIFI_CONNECT
+static esp_err_t http_server_wifi_connect_json_handler(httpd_req_t * p_req);
+static esp_err_t http_server_wifi_connect_status_json_handler(httpd_req_t * p_req);
+static esp_err_t http_server_get_wifi_connect_info_json_handler(httpd_req_t * p_req);
+static esp_err_t http_server_wifi_disconnect_json_handler(httpd_req_t * p_req);
+static esp_err_t http_server_wifi_scan_json_handler(httpd_req_t * p_req);
+#endif
+#if CONFIG_HTTP_SERVER_LOCAL_TIME
+static esp_err_t http_server_get_local_time_info_json_handler(httpd_req_t * p_req);
+static esp_err_t http_server_get_ap_ssid_json_handler(httpd_req_t * p_req);
+#endif
+#if CONFIG_HTTP_SERVER_METRICS
+static esp_err_t http_server_metrics_handler(httpd_req_t * p_req);
+static esp_err_t http_server_metrics_write(const char * p_text, void * p_arg);
+static esp_err_t http_server_metrics_write_scratch(httpd_req_t * p_req);
+static esp_err_t http_server_metrics_write_conns(httpd_req_t * p_req);
+#	if CONFIG_SENSOR_LOG
+static esp_err_t http_server_metrics_write_sensor_log(httpd_req_t * p_req);
+#	endif
+#endif
+#if CONFIG_HTTP_SERVER_LOG
+static esp_err_t http_server_log_json_handler(httpd_req_t * p_req);
+static esp_err_t http_server_log_level_handler(httpd_req_t * p_req);
+#endif
+#if CONFIG_HTTP_SERVER_TASK_PLAN
+static esp_err_t http_server_task_plan_json_handler(httpd_req_t * p_req);
+static esp_err_t http_server_task_plan_set_handler(httpd_req_t * p_req);
+#endif
+#if CONFIG_TRACE_ENABLE
+static esp_err_t http_server_trace_handler(httpd_req_t * p_req);
+static esp_err_t http_server_trace_write(const void * p_data, size_t len,
+										 void * p_arg);
+#endif
+static void http_server_monitor(void * p_param);
+static void http_server_fw_update_reset_timer(void);
+
+void
+http_server_start (void)
+{
+	if (NULL == g_http_server_handle)
+	{
+		g_http_server_handle = http_server_configure();
+	}
+}
+
+void http_server_stop(void)
+{
+#if CONFIG_HTTP_SERVER_BULK
+	if (NULL != g_http_bulk_handle)
+	{
+		httpd_stop(g_http_bulk_handle);
+		g_http_bulk_handle = NULL;
+	}
+#endif
+
+	if (NULL != g_http_server_handle)
+	{
+		http_server_conn_stop();
+		httpd_stop(g_http_server_handle);
+		ESP_LOGI(g_tag, "http_server_stop: stopping HTTP server");
+		g_http_server_handle = NULL;
+	}
+}
+
+void
+http_server_fw_update_reset_callback (void * p_arg)
+{
+	ESP_LOGI(g_tag, "http_server_fw_update_reset_callback: timer timed out, restarting the device");
+
+	esp_restart();
+}
+
+BaseType_t
+http_server_monitor_send_message (http_server_message_t msg_id)
+{
+	http_server_queue_message_t msg = {0};
+
+	msg.msg_id = msg_id;
+
+	// Server not started (or disabled), nobody to notify
+	//
+	if (NULL == g_http_server_queue)
+	{
+		return pdFALSE;
+	}
+
+	return xQueueSend(g_http_server_queue, &msg, portMAX_DELAY);
+}
+
+static httpd_handle_t
+http_server_configure (void)
+{
+	// Default configuration
+	//
+	httpd_config_t config = HTTPD_DEFAULT_CONFIG();
+
+	// The monitor and its queue are created once and kept across server
+	// restarts
+	//
+	if (NULL == g_http_server_queue)
+	{
+		g_http_server_queue = APP_QUEUE_CREATE(3, sizeof(http_server_queue_message_t));
+		metrics_register_queue("http_server", g_http_server_queue);
+
+		g_task_http_server_monitor =
+			APP_TASK_CREATE_PINNED(http_server_monitor, "http_server_monitor",
+								   HTTP_SERVER_MONITOR_STACK_SIZE, NULL,
+								   task_plan_get(TASK_PLAN_HTTP_SERVER_MONITOR)->priority,
+								   task_plan_get(TASK_PLAN_HTTP_SERVER_MONITOR)->core_id);
+	}
+
+	// Core of HTTP server
+	// task_priority = 1 as default
+	// stack_size = 4096 as default
+	//
+	config.core_id = task_plan_get(TASK_PLAN_HTTP_SERVER)->core_id;
+	config.task_priority = task_plan_get(TASK_PLAN_HTTP_SERVER)->priority;
+#if CONFIG_HTTP_SERVER_OTA && !CONFIG_HTTP_SERVER_BULK
+	// The uploads run on this task
+	//
+	config.stack_size = HTTP_SERVER_BULK_TASK_STACK_SIZE;
+#else
+	config.stack_size = HTTP_SERVER_TASK_STACK_SIZE;
+#endif
+	config.max_uri_handlers = 28;
+	config.recv_wait_timeout = CONFIG_HTTP_SERVER_SOCKET_TIMEOUT_S;
+	config.send_wait_timeout = CONFIG_HTTP_SERVER_SOCKET_TIMEOUT_S;
+	http_server_conn_configure(&config);
+
+	ESP_LOGI(g_tag, "http_server_configure:"
+					"Starting server on port: %d"
+					"with task priority: %d",
+					config.server_port, config.task_priority);
+
+	if (ESP_OK == httpd_start(&g_http_server_handle, &config))
+	{
+		ESP_LOGI(g_tag, "http_server_configure: Registering the URI handlers");
+
+		http_server_conn_start(g_http_server_handle);
+
+		httpd_uri_t index_html = {
+			.uri = "/",
+			.method = HTTP_GET,
+			.handler = http_server_scratch_dispatch,
+			.user_ctx = (void *) http_server_index_html_handler
+		};
+
+		httpd_register_uri_handler(g_http_server_handle, &index_html);
+
+#if CONFIG_WIFI_APP_CAPTIVE_PORTAL
+		http_server_portal_register(g_http_server_handle);
+#endif
+
+#if CONFIG_HTTP_SERVER_OTA
+		httpd_uri_t ota_status = {
+			.uri = "/OTAstatus",
+			.method = HTTP_POST,
+			.handler = http_server_scratch_dispatch,
+			.user_ctx = (void *) http_server_ota_status_handler
+		};
+
+		httpd_register_uri_handler(g_http_server_handle, &ota_status);
+
+		httpd_uri_t ota_progress = {
+			.uri = "/OTAprogress.json",
+			.method = HTTP_GET,
+			.handler = http_server_scratch_dispatch,
+			.user_ctx = (void *) http_server_ota_progress_handler
+		};
+
+		httpd_register_uri_handler(g_http_server_handle, &ota_progress);
+
+		// Read from flash once here, every request is served from RAM
+		//
+		ota_app_firmware_init();
+
+		httpd_uri_t firmware_json = {
+			.uri = "/firmware.json",
+			.method = HTTP_GET,
+			.handler = http_server_scratch_dispatch,
+			.user_ctx = (void *) http_server_firmware_json_handler
+		};
+
+		httpd_register_uri_handler(g_http_server_handle, &firmware_json);
+#endif
+
+#if CONFIG_HTTP_SERVER_SENSOR
+		httpd_uri_t dht_sensor_json = {
+			.uri = "/dhtSensor.json",
+			.method = HTTP_GET,
+			.handler = http_server_scratch_dispatch,
+			.user_ctx = (void *) http_server_get_dht_sensor_readings_json_handler
+		};
+
+		httpd_register_uri_handler(g_http_server_handle, &dht_sensor_json);
+#endif
+
+#if CONFIG_HTTP_SERVER_WIFI_CONNECT
+		httpd_uri_t wifi_connect_json = {
+			.uri = "/wifiConnect.json",
+			.method = HTTP_POST,
+			.handler = http_server_scratch_dispatch,
+			.user_ctx = (void *) http_server_wifi_connect_json_handler
+		};
+
+		httpd_register_uri_handler(g_http_server_handle, &wifi_connect_json);
+
+		httpd_uri_t wifi_connect_status_json = {
+			.uri = "/wifiConnectStatus",
+			.method = HTTP_POST,
+			.handler = http_server_scratch_dispatch,
+			.user_ctx = (void *) http_server_wifi_connect_status_json_handler
+		};
+
+		httpd_register_uri_handler(g_http_server_handle, &wifi_connect_status_json);
+
+		httpd_uri_t wifi_connect_info_json = {
+			.uri = "/wifiConnectInfo.json",
+			.method = HTTP_GET,
+			.handler = http_server_scratch_dispatch,
+			.user_ctx = (void *) http_server_get_wifi_connect_info_json_handler
+		};
+
+		httpd_register_uri_handler(g_http_server_handle, &wifi_connect_info_json);
+#endif
+
+#if CONFIG_HTTP_SERVER_LOCAL_TIME
+		httpd_uri_t local_time_json = {
+			.uri = "/localTime.json",
+			.method = HTTP_GET,
+			.handler = http_server_scratch_dispatch,
+			.user_ctx = (void *) http_server_get_local_time_info_json_handler
+		};
+
+		httpd_register_uri_handler(g_http_server_handle, &local_time_json);
+
+		httpd_uri_t ap_ssid_json = {
+			.uri = "/apSSID.json",
+			.method = HTTP_GET,
+			.handler = http_server_scratch_dispatch,
+			.user_ctx = (void *) http_server_get_ap_ssid_json_handler
+		};
+
+		httpd_register_uri_handler(g_http_server_handle, &ap_ssid_json);
+#endif
+
+#if CONFIG_HTTP_SERVER_WIFI_CONNECT
+		httpd_uri_t wifi_disconnect_json = {
+			.uri = "/wifiDisconnect.json",
+			.method = HTTP_DELETE,
+			.handler = http_server_scratch_dispatch,
+			.user_ctx = (void *) http_server_wifi_disconnect_json_handler
+		};
+
+		httpd_register_uri_handler(g_http_server_handle, &wifi_disconnect_json);
+
+		httpd_uri_t wifi_scan_json = {
+			.uri = "/wifiScan.json",
+			.method = HTTP_GET,
+			.handler = http_server_scratch_dispatch,
+			.user_ctx = (void *) http_server_wifi_scan_json_handler
+		};
+
+		httpd_register_uri_handler(g_http_server_handle, &wifi_scan_json);
+#endif
+
+#if CONFIG_HTTP_SERVER_METRICS
+		httpd_uri_t metrics = {
+			.uri = "/metrics",
+			.method = HTTP_GET,
+			.handler = http_server_scratch_dispatch,
+			.user_ctx = (void *) http_server_metrics_handler
+		};
+
+		httpd_register_uri_handler(g_http_server_handle, &metrics);
+		metrics_start();
+#endif
+
+#if CONFIG_HTTP_SERVER_LOG
+		httpd_uri_t log_json = {
+			.uri = "/log.json",
+			.method = HTTP_GET,
+			.handler = http_server_scratch_dispatch,
+			.user_ctx = (void *) http_server_log_json_handler
+		};
+
+		httpd_register_uri_handler(g_http_server_handle, &log_json);
+
+		httpd_uri_t log_level = {
+			.uri = "/logLevel",
+			.method = HTTP_POST,
+			.handler = http_server_scratch_dispatch,
+			.user_ctx = (void *) http_server_log_level_handler
+		};
+
+		httpd_register_uri_handler(g_http_server_handle, &log_level);
+#endif
+
+#if CONFIG_HTTP_SERVER_TASK_PLAN
+		httpd_uri_t task_plan_json = {
+			.uri = "/taskPlan.json",
+			.method = HTTP_GET,
+			.handler = http_server_scratch_dispatch,
+			.user_ctx = (void *) http_server_task_plan_json_handler
+		};
+
+		httpd_register_uri_handler(g_http_server_handle, &task_plan_json);
+
+		httpd_uri_t task_plan_set = {
+			.uri = "/taskPlan",
+			.method = HTTP_POST,
+			.handler = http_server_scratch_dispatch,
+			.user_ctx = (void *) http_server_task_plan_set_handler
+		};
+
+		httpd_register_uri_handler(g_http_server_handle, &task_plan_set);
+#endif
+
+		// Needs the server up, no-op unless CONFIG_TASK_PLAN_BENCHMARK
+		//
+		task_plan_benchmark_start();
+
+#if CONFIG_TRACE_ENABLE
+		httpd_uri_t trace_bin = {
+			.uri = "/trace.bin",
+			.method = HTTP_GET,
+			.handler = http_server_scratch_dispatch,
+			.user_ctx = (void *) http_server_trace_handler
+		};
+
+		httpd_register_uri_handler(g_http_server_handle, &trace_bin);
+#endif
+
+#if CONFIG_HTTP_SERVER_BULK
+		g_http_bulk_handle = http_server_bulk_configure();
+#else
+		http_server_register_bulk(g_http_server_handle);
+#endif
+
+		// Every URI is served, an update can be pushed again
+		//
+		ota_app_health_report(OTA_APP_HEALTH_HTTP);
+
+		return g_http_server_handle;
+	}
+
+	return NULL;
+}
+
+#if CONFIG_HTTP_SERVER_BULK
+// IDF 4.4 runs every handler of a server on its one task: an upload or
+// an export there would hold every dashboard request until it ends
+//
+static httpd_handle_t
+http_server_bulk_configure (void)
+{
+	httpd_config_t config = HTTPD_DEFAULT_CONFIG();
+	httpd_handle_t h_server = NULL;
+
+	config.server_port = CONFIG_HTTP_SERVER_BULK_PORT;
+	config.ctrl_port = config.ctrl_port + 1;
+	config.core_id = task_plan_get(TASK_PLAN_HTTP_BULK)->core_id;
+	config.task_priority = task_plan_get(TASK_PLAN_HTTP_BULK)->priority;
+	config.stack_size = HTTP_SERVER_BULK_TASK_STACK_SIZE;
+	config.max_uri_handlers = 3;
+	config.max_open_sockets = CONFIG_HTTP_SERVER_BULK_MAX_OPEN;
+	config.recv_wait_timeout = CONFIG_HTTP_SERVER_SOCKET_TIMEOUT_S;
+	config.send_wait_timeout = CONFIG_HTTP_SERVER_SOCKET_TIMEOUT_S;
+
+	if (ESP_OK != httpd_start(&h_server, &config))
+	{
+		ESP_LOGE(g_tag, "http_server_bulk_configure: cannot start on port %d",
+				 config.server_port);
+
+		return NULL;
+	}
+
+	ESP_LOGI(g_tag, "http_server_bulk_configure: uploads and exports on port %d",
+			 config.server_port);
+
+	http_server_register_bulk(h_server);
+
+	return h_server;
+}
+#endif
+
+// Uploads and exports, the handlers that hold their task for seconds
+//
+static void
+http_server_register_bulk (httpd_handle_t h_server)
+{
+#if CONFIG_HTTP_SERVER_OTA
+	httpd_uri_t ota_update = {
+		.uri = "/OTAupdate",
+		.method = HTTP_POST,
+		.handler = http_server_scratch_dispatch,
+		.user_ctx = (void *) http_server_ota_update_handler
+	};
+
+	httpd_register_uri_handler(h_server, &ota_update);
+#endif
+
+#if CONFIG_HTTP_SERVER_EXPORT
+	httpd_uri_t export_csv = {
+		.uri = "/export.csv",
+		.method = HTTP_GET,
+		.handler = http_server_scratch_dispatch,
+		.user_ctx = (void *) http_server_export_csv_handler
+	};
+
+	httpd_register_uri_handler(h_server, &export_csv);
+
+	httpd_uri_t export_bin = {
+		.uri = "/export.bin",
+		.method = HTTP_GET,
+		.handler = http_server_scratch_dispatch,
+		.user_ctx = (void *) http_server_export_bin_handler
+	};
+
+	httpd_register_uri_handler(h_server, &export_bin);
+#endif
+}
+
+static esp_err_t
+http_server_index_html_handler (httpd_req_t * p_req)
+{
+	TRACE_BEGIN("http index.html");
+
+	ESP_LOGD(g_tag, "index.html requested");
+
+	// Every browser takes gzip, the page comes in one response
+	//
+	httpd_resp_set_type(p_req, "text/html");
+	httpd_resp_set_hdr(p_req, "Content-Encoding", "gzip");
+	httpd_resp_send(p_req, (const char *) g_index_html_gz_start,
+					g_index_html_gz_end - g_index_html_gz_start);
+	TRACE_END("http index.html");
+
+	return ESP_OK;
+}
+
+#if CONFIG_HTTP_SERVER_OTA
+static esp_err_t
+http_server_ota_update_handler (httpd_req_t * p_req)
+{
+	char * p_ota_buff = http_server_scratch_get(p_req);
+	char content_type[128] = {0};
+	http_server_multipart_t part = {0};
+	const char * p_file = NULL;
+	size_t file_len = 0;
+	int32_t content_length = p_req->content_len;
+	int32_t content_received = 0;
+	int32_t recv_len = 0;
+	uint8_t timeouts = 0;
+	bool b_is_req_body_started = false;
+	bool b_flash_successful = false;
+	esp_err_t err = ESP_OK;
+
+	TRACE_BEGIN("http OTAupdate");
+
+	if (NULL == p_ota_buff)
+	{
+		TRACE_END("http OTAupdate");
+
+		return http_server_scratch_busy(p_req);
+	}
+
+	// Only the file goes to ota_app: the closing boundary is not part of
+	// the image, its last bytes would be taken for the appended SHA-256
+	//
+	httpd_req_get_hdr_value_str(p_req, "Content-Type", content_type, sizeof(content_type));
+	http_server_multipart_init(&part, content_type, content_length);
+
+	do
+	{
+		// Read the data for the request
+		//
+		if ((recv_len = httpd_req_recv(p_req, p_ota_buff,
+									   MIN(content_length - content_received,
+									   HTTP_SERVER_SCRATCH_SIZE))) < 0)
+		{
+			if ((HTTPD_SOCK_ERR_TIMEOUT == recv_len) &&
+				(++timeouts < OTA_MAX_SOCKET_TIMEOUTS))
+			{
+				ESP_LOGI(g_tag, "http_server_ota_update_handler: Socket timeout");
+
+				// Try again
+				//
+				continue;
+			}
+
+			ESP_LOGI(g_tag, "http_server_ota_update_handler: OTA other error %d", recv_len);
+
+			if (true == b_is_req_body_started)
+			{
+				ota_app_abort();
+			}
+
+			TRACE_END("http OTAupdate");
+
+			return ESP_FAIL;
+		}
+
+		timeouts = 0;
+
+		if (false == http_server_multipart_feed(&part, p_ota_buff, recv_len,
+												&p_file, &file_len))
+		{
+			ESP_LOGE(g_tag, "http_server_ota_update_handler: no form data in the first %d bytes",
+					 recv_len);
+			TRACE_END("http OTAupdate");
+
+			return ESP_FAIL;
+		}
+
+		content_received += recv_len;
+
+		// First part received
+		//
+		if (false == b_is_req_body_started)
+		{
+			b_is_req_body_started = true;
+
+			ESP_LOGI(g_tag, "http_server_ota_update_handler: OTA file size: %d", content_length);
+
+			// Plain, compressed or delta image, ota_app tells them apart
+			//
+			err = ota_app_begin();
+
+			if (ESP_OK != err)
+			{
+				ESP_LOGE(g_tag, "http_server_ota_update_handler: Error %s with OTA begin", esp_err_to_name(err));
+				TRACE_END("http OTAupdate");
+				return ESP_FAIL;
+			}
+
+			// Progress at /OTAprogress.json, nothing is logged per chunk
+			//
+			ota_app_set_total(content_length);
+		}
+
+		if (file_len > 0)
+		{
+			TRACE_BEGIN("ota_write");
+			err = ota_app_write(p_file, file_len);
+			TRACE_END("ota_write");
+		}
+	} while ((ESP_OK == err) &&
+			 ((recv_len > 0) || (HTTPD_SOCK_ERR_TIMEOUT == recv_len)) &&
+			 (content_received < content_length));
+
+	TRACE_BEGIN("ota_end");
+
+	if (ESP_OK != err)
+	{
+		ESP_LOGI(g_tag, "http_server_ota_update_handler: image refused, %s",
+				 esp_err_to_name(err));
+		ota_app_abort();
+	}
+	else if (ESP_OK == ota_app_end())
+	{
+		const esp_partition_t * p_boot_partition = esp_ota_get_boot_partition();
+		ESP_LOGI(g_tag,
+				 "http_server_ota_update_handler: next boot partition subtype %d at offset 0x%X\n",
+				 p_boot_partition->subtype, p_boot_partition->address);
+		b_flash_successful = true;
+	}
+	else
+	{
+		ESP_LOGI(g_tag, "http_server_ota_update_handler: ota_app_end ERROR\n");
+	}
+
+	TRACE_END("ota_end");
+
+	if (true == b_flash_successful)
+	{
+		http_server_monitor_send_message(HTTP_MSG_OTA_UPDATE_SUCCESSFUL);
+	}
+	else
+	{
+		http_server_monitor_send_message(HTTP_MSG_OTA_UPDATE_FAILED);
+	}
+
+	// Answered like every other request, the connection stays usable.
+	// The dashboard posts from the main server's origin.
+	//
+	httpd_resp_set_type(p_req, "application/json");
+	httpd_resp_set_hdr(p_req, "Access-Control-Allow-Origin", "*");
+	httpd_resp_sendstr(p_req, (true == b_flash_successful) ?
+							  "{\"ota_update_status\":1}" :
+							  "{\"ota_update_status\":-1}");
+	TRACE_END("http OTAupdate");
+
+	return ESP_OK;
+}
+
+static esp_err_t
+http_server_ota_status_handler (httpd_req_t * p_req)
+{
+	char ota_json[128] = {0};
+
+	TRACE_BEGIN("http OTAstatus");
+
+	ESP_LOGD(g_tag, "ota_status requested");
+
+	// upload_port 0: /OTAupdate is on this server
+	//
+	snprintf(ota_json, sizeof(ota_json),
+			 "{\"ota_update_status\":%d,\"compile_time\":\"%s\",\"compile_date\":\"%s\","
+			 "\"upload_port\":%d}", g_fw_update_status, __TIME__, __DATE__,
+#if CONFIG_HTTP_SERVER_BULK
+			 CONFIG_HTTP_SERVER_BULK_PORT
+#else
+			 0
+#endif
+			 );
+	httpd_resp_set_type(p_req, "application/json");
+	httpd_resp_send(p_req, ota_json, strlen(ota_json));
+	TRACE_END("http OTAstatus");
+
+	return ESP_OK;
+}
+
+// Snapshot of the writer state, never waits for the update
+//
+static esp_err_t
+http_server_ota_progress_handler (httpd_req_t * p_req)
+{
+	char * p_json = http_server_scratch_get(p_req);
+	size_t len = 0;
+
+	TRACE_BEGIN("http OTAprogress");
+
+	if (NULL == p_json)
+	{
+		TRACE_END("http OTAprogress");
+
+		return http_server_scratch_busy(p_req);
+	}
+
+	len = ota_app_format_progress_json(p_json, HTTP_SERVER_SCRATCH_SIZE);
+	httpd_resp_set_type(p_req, "application/json");
+	httpd_resp_set_hdr(p_req, "Cache-Control", "no-store");
+	httpd_resp_send(p_req, p_json, len);
+	TRACE_END("http OTAprogress");
+
+	return ESP_OK;
+}
+
+// Partitions, app descriptors and OTA states, cached by ota_app_firmware
+//
+static esp_err_t
+http_server_firmware_json_handler (httpd_req_t * p_req)
+{
+	char * p_json = http_server_scratch_get(p_req);
+	size_t len = 0;
+
+	TRACE_BEGIN("http firmware.json");
+
+	if (NULL == p_json)
+	{
+		TRACE_END("http firmware.json");
+
+		return http_server_scratch_busy(p_req);
+	}
+
+	len = ota_app_firmware_format_json(p_json, HTTP_SERVER_SCRATCH_SIZE);
+
+	if (0 == len)
+	{
+		httpd_resp_send_err(p_req, HTTPD_500_INTERNAL_SERVER_ERROR,
+							"Inventory larger than the scratch block");
+	}
+	else
+	{
+		httpd_resp_set_type(p_req, "application/json");
+		httpd_resp_send(p_req, p_json, len);
+	}
+
+	TRACE_END("http firmware.json");
+
+	return ESP_OK;
+}
+#endif
+
+static void
+http_server_monitor (void * p_param)
+{
+	http_server_queue_message_t msg = {0};
+
+	for (;;)
+	{
+		if (pdTRUE == xQueueReceive(g_http_server_queue,
+									&msg, portMAX_DELAY))
+		{
+			switch (msg.msg_id)
+			{
+				case HTTP_MSG_WIFI_CONNECT_INIT:
+					ESP_LOGI(g_tag, "HTTP_MSG_WIFI_CONNECT_INIT");
+
+					g_wifi_connect_status = HTTP_WIFI_STATUS_CONNECTING;
+				break;
+
+				case HTTP_MSG_WIFI_CONNECT_SUCCESS:
+					ESP_LOGI(g_tag, "HTTP_MSG_WIFI_CONNECT_SUCCESS");
+
+					g_wifi_connect_status = HTTP_WIFI_STATUS_CONNECT_SUCCESS;
+				break;
+
+				case HTTP_MSG_WIFI_CONNECT_FAIL:
+					ESP_LOGI(g_tag, "HTTP_MSG_WIFI_CONNECT_FAIL");
+
+					g_wifi_connect_status = HTTP_WIFI_STATUS_CONNECT_FAILED;
+				break;
+
+				case HTTP_MSG_USER_DISCONNECTED:
+					ESP_LOGI(g_tag, "HTTP_MSG_USER_DISCONNECTED");
+
+					g_wifi_connect_status = HTTP_WIFI_STATUS_DISCONNECTED;
+				break;
+
+				case HTTP_MSG_OTA_UPDATE_SUCCESSFUL:
+					ESP_LOGI(g_tag, "HTTP_MSG_OTA_UPDATE_SUCCESSFUL");
+
+					g_fw_update_status = OTA_UPDATE_SUCCESSFUL;
+					http_server_fw_update_reset_timer();
+				break;
+
+				case HTTP_MSG_OTA_UPDATE_FAILED:
+					ESP_LOGI(g_tag, "HTTP_MSG_OTA_UPDATE_FAILED");
+
+					g_fw_update_status = OTA_UPDATE_FAILED;
+				break;
+
+				default:
+				break;
+			}
+		}
+	}
+}
+
+static void
+http_server_fw_update_reset_timer (void)
+{
+	if (OTA_UPDATE_SUCCESSFUL == g_fw_update_status)
+	{
+		ESP_LOGI(g_tag, "http_server_fw_update_reset_timer: FW update successfully");
+
+		ESP_ERROR_CHECK(esp_timer_create(&g_fw_update_reset_args, &gh_fw_update_reset));
+		ESP_ERROR_CHECK(esp_timer_start_once(gh_fw_update_reset, 8000000));
+	}
+	else
+	{
+		ESP_LOGI(g_tag, "http_server_fw_update_reset_timer: FW update unsuccessful");
+	}
+}
+
+#if CONFIG_HTTP_SERVER_SENSOR
+static esp_err_t
+http_server_get_dht_sensor_readings_json_handler (httpd_req_t * p_req)
+{
+	TRACE_BEGIN("http dhtSensor.json");
+
+	ESP_LOGD(g_tag, "/dhtSensor.json requested");
+
+	char dht_sensor_json[100] = {0};
+
+	sprintf(dht_sensor_json, "{\"temp\":\"%.1f\",\"humidity\":\"%.1f\"}",
+			sensor_get_latest_value(SENSOR_QUANTITY_TEMPERATURE),
+			sensor_get_latest_value(SENSOR_QUANTITY_HUMIDITY));
+
+	httpd_resp_set_type(p_req, "application/json");
+	httpd_resp_send(p_req, dht_sensor_json, strlen(dht_sensor_json));
+	TRACE_END("http dhtSensor.json");
+
+	return ESP_OK;
+}
+#endif
+
+#if CONFIG_HTTP_SERVER_WIFI_CONNECT
+static esp_err_t
+http_server_wifi_connect_json_handler (httpd_req_t * p_req)
+{
+	TRACE_BEGIN("http wifiConnect.json");
+
+	ESP_LOGD(g_tag, "/wifiConnect.json requested");
+
+	// Fixed buffers: longer headers are truncated, not allocated
+	//
+	char ssid_str[MAX_SSID_LENGTH + 1] = {0};
+	char pass_str[MAX_PASSWORD_LENGTH + 1] = {0};
+
+	if (ESP_OK == httpd_req_get_hdr_value_str(p_req, "my-connect-ssid",
+											  ssid_str, sizeof(ssid_str)))
+	{
+		ESP_LOGI(g_tag, "http_server_wifi_connect_json_handler: Found header => %s", ssid_str);
+	}
+
+	if (ESP_OK == httpd_req_get_hdr_value_str(p_req, "my-connect-pwd",
+											  pass_str, sizeof(pass_str)))
+	{
+		ESP_LOGI(g_tag, "http_server_wifi_connect_json_handler: Found header => %s", pass_str);
+	}
+
+	wifi_config_t * p_wifi_config = wifi_app_get_wifi_config();
+	memset(p_wifi_config, 0, sizeof(wifi_config_t));
+	memcpy(p_wifi_config->sta.ssid, ssid_str,
+		   strnlen(ssid_str, sizeof(p_wifi_config->sta.ssid)));
+	memcpy(p_wifi_config->sta.password, pass_str,
+		   strnlen(pass_str, sizeof(p_wifi_config->sta.password)));
+	wifi_app_send_message(WIFI_APP_MSG_CONNECTING_FROM_HTTP_SERVER);
+	TRACE_END("http wifiConnect.json");
+
+	return ESP_OK;
+}
+
+static esp_err_t
+http_server_wifi_connect_status_json_handler (httpd_req_t * p_req)
+{
+	TRACE_BEGIN("http wifiConnectStatus");
+
+	ESP_LOGD(g_tag, "/wifiConnectStatus requested");
+
+	char status_json[100] = {0};
+
+	sprintf(status_json, "{\"wifi_connect_status\":%d}", g_wifi_connect_status);
+	httpd_resp_set_type(p_req, "application/json");
+	httpd_resp_send(p_req, status_json, strlen(status_json));
+	TRACE_END("http wifiConnectStatus");
+
+	return ESP_OK;
+}
+
+static esp_err_t
+http_server_get_wifi_connect_info_json_handler (httpd_req_t * p_req)
+{
+	TRACE_BEGIN("http wifiConnectInfo.json");
+
+	ESP_LOGD(g_tag, "/wifiConnectInfo requested");
+
+	char * p_ip_info_json = http_server_scratch_get(p_req);
+
+	if (NULL == p_ip_info_json)
+	{
+		TRACE_END("http wifiConnectInfo.json");
+
+		return http_server_scratch_busy(p_req);
+	}
+
+	p_ip_info_json[0] = '\0';
+
+	char ip_addr[IP4ADDR_STRLEN_MAX] = {0};
+	char netmask_addr[IP4ADDR_STRLEN_MAX] = {0};
+	char gw_addr[IP4ADDR_STRLEN_MAX] = {0};
+
+	if (HTTP_WIFI_STATUS_CONNECT_SUCCESS == g_wifi_connect_status)
+	{
+		wifi_ap_record_t wifi_data = {0};
+		ESP_ERROR_CHECK(esp_wifi_sta_get_ap_info(&wifi_data));
+
+		char * p_ssid = (char *) wifi_data.ssid;
+
+		esp_netif_ip_info_t ip_info = {0};
+		ESP_ERROR_CHECK(esp_netif_get_ip_info(gp_esp_netif_sta, &ip_info));
+
+		// From IP address to ascii.
+		//
+		esp_ip4addr_ntoa(&ip_info.ip, ip_addr, IP4ADDR_STRLEN_MAX);
+		esp_ip4addr_ntoa(&ip_info.netmask, netmask_addr, IP4ADDR_STRLEN_MAX);
+		esp_ip4addr_ntoa(&ip_info.gw, gw_addr, IP4ADDR_STRLEN_MAX);
+
+		snprintf(p_ip_info_json, HTTP_SERVER_SCRATCH_SIZE, "{\"ip\":\"%s\",\"netmask\":\"%s\",\"gw\":\"%s\",\"ap\":\"%s\"}",
+				ip_addr, netmask_addr, gw_addr, p_ssid);
+	}
+
+	httpd_resp_set_type(p_req, "application/json");
+	httpd_resp_send(p_req, p_ip_info_json, strlen(p_ip_info_json));
+	TRACE_END("http wifiConnectInfo.json");
+
+	return ESP_OK;
+}
+
+static esp_err_t
+http_server_wifi_disconnect_json_handler (httpd_req_t * p_req)
+{
+	TRACE_BEGIN("http wifiDisconnect.json");
+
+	ESP_LOGD(g_tag, "/wifiDisconnect requested");
+
+	wifi_app_send_message(WIFI_APP_MSG_USER_REQUESTED_STA_DISCONNECT);
+	TRACE_END("http wifiDisconnect.json");
+
+	return ESP_OK;
+}
+
+// Answers from the scan cache at once. A scan, when due, runs in the
+// background and the page polls until "scanning" is false. refresh=1
+// asks for a scan before the cache expires.
+//
+static esp_err_t
+http_server_wifi_scan_json_handler (httpd_req_t * p_req)
+{
+	char query[16] = {0};
+	char refresh[4] = {0};
+	bool b_refresh = false;
+	size_t len = 0;
+
+	TRACE_BEGIN("http wifiScan.json");
+
+	char * p_scan_json = http_server_scratch_get(p_req);
+
+	if (NULL == p_scan_json)
+	{
+		TRACE_END("http wifiScan.json");
+
+		return http_server_scratch_busy(p_req);
+	}
+
+	if ((ESP_OK == httpd_req_get_url_query_str(p_req, query, sizeof(query))) &&
+		(ESP_OK == httpd_query_key_value(query, "refresh", refresh, sizeof(refresh))))
+	{
+		b_refresh = ('1' == refresh[0]);
+	}
+
+	wifi_app_scan_request(b_refresh);
+	len = wifi_app_scan_format_json(p_scan_json, HTTP_SERVER_SCRATCH_SIZE);
+
+	httpd_resp_set_type(p_req, "application/json");
+	httpd_resp_set_hdr(p_req, "Cache-Control", "no-store");
+	httpd_resp_send(p_req, p_scan_json, len);
+	TRACE_END("http wifiScan.json");
+
+	return ESP_OK;
+}
+#endif
+
+#if CONFIG_HTTP_SERVER_LOCAL_TIME
+static esp_err_t
+http_server_get_local_time_info_json_handler (httpd_req_t * p_req)
+{
+	TRACE_BEGIN("http localTime.json");
+
+	ESP_LOGD(g_tag, "/localTime requested");
+
+	char local_time_json[64] = {0};
+	char local_time[SNTP_TIME_SYNC_TIME_LEN + 1] = {0};
+	int64_t now_ms = sntp_time_sync_now_ms();
+
+	if ((0 != now_ms) &&
+		(0 != sntp_time_sync_format(now_ms, local_time, sizeof(local_time))))
+	{
+		snprintf(local_time_json, sizeof(local_time_json),
+				 "{\"time\":\"%s\",\"epoch_ms\":%lld}", local_time, now_ms);
+	}
+
+	httpd_resp_set_type(p_req, "application/json");
+	httpd_resp_send(p_req, local_time_json, strlen(local_time_json));
+	TRACE_END("http localTime.json");
+
+	return ESP_OK;
+}
+
+static esp_err_t
+http_server_get_ap_ssid_json_handler (httpd_req_t * p_req)
+{
+	TRACE_BEGIN("http apSSID.json");
+
+	ESP_LOGD(g_tag, "/apSSID requested");
+
+	char ssid_json[50] = {0};
+	wifi_config_t * p_wifi_config = wifi_app_get_wifi_config();
+	esp_wifi_get_config(ESP_IF_WIFI_AP, p_wifi_config);
+	char * p_ssid = (char *) p_wifi_config->ap.ssid;
+
+	sprintf(ssid_json, "{\"ssid\":\"%s\"}", p_ssid);
+	httpd_resp_set_type(p_req, "application/json");
+	httpd_resp_send(p_req, ssid_json, strlen(ssid_json));
+	TRACE_END("http apSSID.json");
+
+	return ESP_OK;
+}
+#endif
+
+#if CONFIG_HTTP_SERVER_METRICS
+static esp_err_t
+http_server_metrics_handler (httpd_req_t * p_req)
+{
+	esp_err_t err = ESP_OK;
+
+	TRACE_BEGIN("http metrics");
+
+	httpd_resp_set_type(p_req, "text/plain; version=0.0.4");
+	err = metrics_write_prometheus(http_server_metrics_write, p_req);
+
+	if (ESP_OK == err)
+	{
+		err = http_server_metrics_write_scratch(p_req);
+	}
+
+	if (ESP_OK == err)
+	{
+		err = http_server_metrics_write_conns(p_req);
+	}
+
+#if CONFIG_SENSOR_LOG
+	if (ESP_OK == err)
+	{
+		err = http_server_metrics_write_sensor_log(p_req);
+	}
+#endif
+
+	if (ESP_OK != err)
+	{
+		ESP_LOGE(g_tag, "/metrics: %s", esp_err_to_name(err));
+	}
+
+	// Terminates the chunked response
+	//
+	httpd_resp_send_chunk(p_req, NULL, 0);
+	TRACE_END("http metrics");
+
+	return ESP_OK;
+}
+
+static esp_err_t
+http_server_metrics_write (const char * p_text, void * p_arg)
+{
+	return httpd_resp_sendstr_chunk((httpd_req_t *) p_arg, p_text);
+}
+
+static esp_err_t
+http_server_metrics_write_scratch (httpd_req_t * p_req)
+{
+	http_server_scratch_stats_t stats = {0};
+	char line[256] = {0};
+
+	http_server_scratch_get_stats(&stats);
+	snprintf(line, sizeof(line),
+			 "# TYPE esp_http_scratch_blocks_in_use gauge\n"
+			 "esp_http_scratch_blocks_in_use %u\n"
+			 "# TYPE esp_http_scratch_blocks_in_use_max gauge\n"
+			 "esp_http_scratch_blocks_in_use_max %u\n"
+			 "# TYPE esp_http_scratch_exhausted_total counter\n"
+			 "esp_http_scratch_exhausted_total %u\n",
+			 stats.in_use, stats.in_use_max, stats.exhausted);
+
+	return httpd_resp_sendstr_chunk(p_req, line);
+}
+
+static esp_err_t
+http_server_metrics_write_conns (httpd_req_t * p_req)
+{
+	http_server_conn_stats_t stats = {0};
+	char line[512] = {0};
+
+	http_server_conn_get_stats(&stats);
+	snprintf(line, sizeof(line),
+			 "# TYPE esp_http_connections_max gauge\n"
+			 "esp_http_connections_max %u\n"
+			 "# TYPE esp_http_connections_open gauge\n"
+			 "esp_http_connections_open %u\n"
+			 "# TYPE esp_http_connections_open_max gauge\n"
+			 "esp_http_connections_open_max %u\n"
+			 "# TYPE esp_http_connections_opened_total counter\n"
+			 "esp_http_connections_opened_total %u\n"
+			 "# TYPE esp_http_connections_closed_idle_total counter\n"
+			 "esp_http_connections_closed_idle_total %u\n"
+			 "# TYPE esp_http_requests_total counter\n"
+			 "esp_http_requests_total %u\n"
+			 "# TYPE esp_http_connection_idle_max_seconds gauge\n"
+			 "esp_http_connection_idle_max_seconds %u\n",
+			 stats.max_open, stats.open, stats.open_max, stats.opened,
+			 stats.closed_idle, stats.requests, stats.idle_max_s);
+
+	return httpd_resp_sendstr_chunk(p_req, line);
+}
+
+#	if CONFIG_SENSOR_LOG
+static esp_err_t
+http_server_metrics_write_sensor_log (httpd_req_t * p_req)
+{
+	sensor_log_stats_t stats = {0};
+	char line[640] = {0};
+
+	sensor_log_get_stats(&stats);
+	snprintf(line, sizeof(line),
+			 "# TYPE esp_sensor_log_blocks_written_total counter\n"
+			 "esp_sensor_log_blocks_written_total %u\n"
+			 "# TYPE esp_sensor_log_samples_total counter\n"
+			 "esp_sensor_log_samples_total %u\n"
+			 "# TYPE esp_sensor_log_bytes_per_sample gauge\n"
+			 "esp_sensor_log_bytes_per_sample %.2f\n"
+			 "# TYPE esp_sensor_log_sector_erases_min gauge\n"
+			 "esp_sensor_log_sector_erases_min %u\n"
+			 "# TYPE esp_sensor_log_sector_erases_max gauge\n"
+			 "esp_sensor_log_sector_erases_max %u\n"
+			 "# TYPE esp_sensor_log_query_seconds gauge\n"
+			 "esp_sensor_log_query_seconds %.3f\n"
+			 "# TYPE esp_sensor_log_query_samples gauge\n"
+			 "esp_sensor_log_query_samples %u\n",
+			 stats.blocks_written, stats.samples,
+			 (stats.samples > 0) ? ((double) stats.payload_bytes / stats.samples) : 0.0,
+			 stats.erase_min, stats.erase_max,
+			 stats.query_ms / 1000.0, stats.query_samples);
+
+	return httpd_resp_sendstr_chunk(p_req, line);
+}
+#	endif
+#endif
+
+#if CONFIG_HTTP_SERVER_LOG
+static esp_err_t
+http_server_log_json_handler (httpd_req_t * p_req)
+{
+	char * p_log_json = http_server_scratch_get(p_req);
+	log_defer_stats_t stats = {0};
+	const char * p_tag = NULL;
+	uint32_t suppressed = 0;
+	int32_t len = 0;
+
+	TRACE_BEGIN("http log.json");
+
+	if (NULL == p_log_json)
+	{
+		TRACE_END("http log.json");
+
+		return http_server_scratch_busy(p_req);
+	}
+
+	log_defer_get_stats(&stats);
+	len = snprintf(p_log_json, HTTP_SERVER_SCRATCH_SIZE,
+				   "{\"captured\":%u,\"dropped\":%u,\"suppressed\":%u,"
+				   "\"pending\":%u,\"tags\":[",
+				   stats.captured, stats.dropped, stats.suppressed, stats.pending);
+
+	// Tags that ever logged, as many as fit the buffer
+	//
+	for (uint32_t idx = 0; true == log_defer_get_tag_stats(idx, &p_tag, &suppressed); ++idx)
+	{
+		int32_t written = snprintf(&p_log_json[len], HTTP_SERVER_SCRATCH_SIZE - len,
+								   "%s{\"tag\":\"%s\",\"suppressed\":%u}",
+								   (0 == idx) ? "" : ",", p_tag, suppressed);
+
+		if ((written < 0) || ((len + written) >= (HTTP_SERVER_SCRATCH_SIZE - 3)))
+		{
+			break;
+		}
+
+		len += written;
+	}
+
+	snprintf(&p_log_json[len], HTTP_SERVER_SCRATCH_SIZE - len, "]}");
+
+	httpd_resp_set_type(p_req, "application/json");
+	httpd_resp_send(p_req, p_log_json, strlen(p_log_json));
+	TRACE_END("http log.json");
+
+	return ESP_OK;
+}
+
+// POST /logLevel?tag=<tag or *>&level=<none|error|warn|info|debug|verbose>
+//
+static esp_err_t
+http_server_log_level_handler (httpd_req_t * p_req)
+{
+	char query[64] = {0};
+	char tag[32] = {0};
+	char level[16] = {0};
+
+	TRACE_BEGIN("http logLevel");
+
+	if ((ESP_OK != httpd_req_get_url_query_str(p_req, query, sizeof(query))) ||
+		(ESP_OK != httpd_query_key_value(query, "tag", tag, sizeof(tag))) ||
+		(ESP_OK != httpd_query_key_value(query, "level", level, sizeof(level))) ||
+		(ESP_OK != log_defer_set_level(tag, level)))
+	{
+		httpd_resp_send_err(p_req, HTTPD_400_BAD_REQUEST, "Expected tag and level");
+		TRACE_END("http logLevel");
+
+		return ESP_OK;
+	}
+
+	ESP_LOGI(g_tag, "/logLevel: %s set to %s", tag, level);
+	httpd_resp_sendstr(p_req, "OK");
+	TRACE_END("http logLevel");
+
+	return ESP_OK;
+}
+#endif
+
+#if CONFIG_HTTP_SERVER_TASK_PLAN
+static esp_err_t
+http_server_task_plan_json_handler (httpd_req_t * p_req)
+{
+	char * p_json = http_server_scratch_get(p_req);
+
+	TRACE_BEGIN("http taskPlan.json");
+
+	if (NULL == p_json)
+	{
+		TRACE_END("http taskPlan.json");
+
+		return http_server_scratch_busy(p_req);
+	}
+
+	// Plan and report take turns in the scratch block
+	//
+	httpd_resp_set_type(p_req, "application/json");
+	httpd_resp_sendstr_chunk(p_req, "{\"plan\":");
+	task_plan_format_json(p_json, HTTP_SERVER_SCRATCH_SIZE);
+	httpd_resp_sendstr_chunk(p_req, p_json);
+	httpd_resp_sendstr_chunk(p_req, ",\"benchmark\":");
+	task_plan_benchmark_format_json(p_json, HTTP_SERVER_SCRATCH_SIZE);
+	httpd_resp_sendstr_chunk(p_req, p_json);
+	httpd_resp_sendstr_chunk(p_req, "}");
+	httpd_resp_send_chunk(p_req, NULL, 0);
+	TRACE_END("http taskPlan.json");
+
+	return ESP_OK;
+}
+
+// POST /taskPlan?task=<name>&priority=<n>&core=<0|1|-1>, used from the
+// next boot
+//
+static esp_err_t
+http_server_task_plan_set_handler (httpd_req_t * p_req)
+{
+	char query[64] = {0};
+	char task[16] = {0};
+	char priority[8] = {0};
+	char core[8] = {0};
+
+	TRACE_BEGIN("http taskPlan");
+
+	if ((ESP_OK != httpd_req_get_url_query_str(p_req, query, sizeof(query))) ||
+		(ESP_OK != httpd_query_key_value(query, "task", task, sizeof(task))) ||
+		(ESP_OK != httpd_query_key_value(query, "priority", priority, sizeof(priority))) ||
+		(ESP_OK != httpd_query_key_value(query, "core", core, sizeof(core))) ||
+		(ESP_OK != task_plan_set(task, atoi(priority), atoi(core))))
+	{
+		httpd_resp_send_err(p_req, HTTPD_400_BAD_REQUEST,
+							"Expected task, priority and core");
+		TRACE_END("http taskPlan");
+
+		return ESP_OK;
+	}
+
+	httpd_resp_sendstr(p_req, "OK, reboot to apply");
+	TRACE_END("http taskPlan");
+
+	return ESP_OK;
+}
+#endif
+
+#if CONFIG_TRACE_ENABLE
+static esp_err_t
+http_server_trace_handler (httpd_req_t * p_req)
+{
+	esp_err_t err = ESP_OK;
+
+	httpd_resp_set_type(p_req, "application/octet-stream");
+	err = trace_dump(http_server_trace_write, p_req);
+
+	if (ESP_OK != err)
+	{
+		ESP_LOGE(g_tag, "/trace.bin: %s", esp_err_to_name(err));
+	}
+
+	httpd_resp_send_chunk(p_req, NULL, 0);
+
+	return ESP_OK;
+}
+
+static esp_err_t
+http_server_trace_write (const void * p_data, size_t len, void * p_arg)
+{
+	return httpd_resp_send_chunk((httpd_req_t *) p_arg, (const char *) p_data,
+								 len);
+}
+#endif
@@ -0,0 +1,334 @@
+/*
+ * http_server_conn.c
+ *
+ *  Created on: 19 oct 2026
+ *      Author: Filippo
+ */
+
+#include "http_server_conn.h"
+#include "freertos/FreeRTOS.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+#include "lwip/sockets.h"
+#include "sdkconfig.h"
+
+// esp_http_server keeps three sockets for itself: the listener and the
+// two ends of its control socket
+//
+#define HTTP_SERVER_CONN_INTERNAL_SOCKETS	3
+
+// One socket for each enabled client of the rest of the application:
+// the captive portal DNS, the OTA pull client and the loopback client of
+// the placement benchmark. HTTP_SERVER_RESERVED_SOCKETS covers the ones
+// this build cannot see, like MQTT.
+//
+#if CONFIG_WIFI_APP_CAPTIVE_PORTAL
+#	define HTTP_SERVER_CONN_CAPTIVE_DNS		1
+#else
+#	define HTTP_SERVER_CONN_CAPTIVE_DNS		0
+#endif
+
+#if CONFIG_OTA_APP_PULL
+#	define HTTP_SERVER_CONN_OTA_PULL		1
+#else
+#	define HTTP_SERVER_CONN_OTA_PULL		0
+#endif
+
+#if CONFIG_TASK_PLAN_BENCHMARK
+#	define HTTP_SERVER_CONN_BENCHMARK		1
+#else
+#	define HTTP_SERVER_CONN_BENCHMARK		0
+#endif
+
+// The upload and export server, with its own internal sockets
+//
+#if CONFIG_HTTP_SERVER_BULK
+#	define HTTP_SERVER_CONN_BULK			(HTTP_SERVER_CONN_INTERNAL_SOCKETS +	\
+											 CONFIG_HTTP_SERVER_BULK_MAX_OPEN)
+#else
+#	define HTTP_SERVER_CONN_BULK			0
+#endif
+
+#define HTTP_SERVER_CONN_RESERVED			(CONFIG_HTTP_SERVER_RESERVED_SOCKETS +	\
+											 HTTP_SERVER_CONN_CAPTIVE_DNS +			\
+											 HTTP_SERVER_CONN_OTA_PULL +			\
+											 HTTP_SERVER_CONN_BENCHMARK +			\
+											 HTTP_SERVER_CONN_BULK)
+#define HTTP_SERVER_CONN_MAX_OPEN			(CONFIG_LWIP_MAX_SOCKETS -				\
+											 HTTP_SERVER_CONN_INTERNAL_SOCKETS -	\
+											 HTTP_SERVER_CONN_RESERVED)
+#define HTTP_SERVER_CONN_REAP_PERIOD_US		(5 * 1000 * 1000)
+
+_Static_assert(HTTP_SERVER_CONN_MAX_OPEN >= 1,
+			   "LWIP_MAX_SOCKETS too small for the HTTP server and the reserved sockets");
+
+static const char g_tag[] = "http_conn";
+
+typedef struct http_server_conn
+{
+	int32_t fd;					// -1 for a free slot
+	int64_t opened_us;
+	int64_t last_us;
+	uint32_t requests;
+	uint32_t active;			// Handlers running on this connection
+} http_server_conn_t;
+
+static http_server_conn_t g_conns[HTTP_SERVER_CONN_MAX_OPEN] = {0};
+static http_server_conn_stats_t g_stats = {0};
+static portMUX_TYPE g_conn_mux = portMUX_INITIALIZER_UNLOCKED;
+static httpd_handle_t g_h_server = NULL;
+static esp_timer_handle_t g_h_reap_timer = NULL;
+
+static esp_err_t http_server_conn_open(httpd_handle_t h_server, int sockfd);
+static void http_server_conn_close(httpd_handle_t h_server, int sockfd);
+static http_server_conn_t * http_server_conn_find(int32_t fd);
+#if CONFIG_HTTP_SERVER_IDLE_TIMEOUT_S > 0
+static void http_server_conn_reap_timer(void * p_arg);
+static void http_server_conn_reap(void * p_arg);
+#endif
+
+void
+http_server_conn_configure (httpd_config_t * p_config)
+{
+	for (uint32_t idx = 0; idx < HTTP_SERVER_CONN_MAX_OPEN; ++idx)
+	{
+		g_conns[idx].fd = -1;
+	}
+
+	// Every dashboard tab polls on its own keep-alive connection. When
+	// the sockets are all taken the least recently used one is closed,
+	// instead of leaving the new client waiting for a timeout.
+	//
+	p_config->max_open_sockets = HTTP_SERVER_CONN_MAX_OPEN;
+	p_config->lru_purge_enable = true;
+	p_config->open_fn = http_server_conn_open;
+	p_config->close_fn = http_server_conn_close;
+
+	g_stats.max_open = HTTP_SERVER_CONN_MAX_OPEN;
+
+	ESP_LOGI(g_tag, "http_server_conn_configure: %d of %d LwIP sockets, %d reserved",
+			 HTTP_SERVER_CONN_MAX_OPEN, CONFIG_LWIP_MAX_SOCKETS,
+			 HTTP_SERVER_CONN_RESERVED);
+}
+
+void
+http_server_conn_start (httpd_handle_t h_server)
+{
+#if CONFIG_HTTP_SERVER_IDLE_TIMEOUT_S > 0
+	const esp_timer_create_args_t reap_timer_args = {
+		.callback = &http_server_conn_reap_timer,
+		.arg = NULL,
+		.dispatch_method = ESP_TIMER_TASK,
+		.name = "http_conn_reap"
+	};
+
+	g_h_server = h_server;
+
+	if (NULL == g_h_reap_timer)
+	{
+		ESP_ERROR_CHECK(esp_timer_create(&reap_timer_args, &g_h_reap_timer));
+	}
+
+	ESP_ERROR_CHECK(esp_timer_start_periodic(g_h_reap_timer, HTTP_SERVER_CONN_REAP_PERIOD_US));
+#endif
+}
+
+void
+http_server_conn_stop (void)
+{
+	if (NULL != g_h_reap_timer)
+	{
+		esp_timer_stop(g_h_reap_timer);
+	}
+
+	g_h_server = NULL;
+}
+
+void
+http_server_conn_request_begin (httpd_req_t * p_req)
+{
+	http_server_conn_t * p_conn = NULL;
+
+	portENTER_CRITICAL(&g_conn_mux);
+	p_conn = http_server_conn_find(httpd_req_to_sockfd(p_req));
+
+	if (NULL != p_conn)
+	{
+		p_conn->last_us = esp_timer_get_time();
+		p_conn->requests++;
+		p_conn->active++;
+	}
+
+	g_stats.requests++;
+	portEXIT_CRITICAL(&g_conn_mux);
+}
+
+void
+http_server_conn_request_end (httpd_req_t * p_req)
+{
+	http_server_conn_t * p_conn = NULL;
+
+	portENTER_CRITICAL(&g_conn_mux);
+	p_conn = http_server_conn_find(httpd_req_to_sockfd(p_req));
+
+	if ((NULL != p_conn) && (p_conn->active > 0))
+	{
+		p_conn->last_us = esp_timer_get_time();
+		p_conn->active--;
+	}
+
+	portEXIT_CRITICAL(&g_conn_mux);
+}
+
+void
+http_server_conn_get_stats (http_server_conn_stats_t * p_stats)
+{
+	int64_t now_us = esp_timer_get_time();
+
+	portENTER_CRITICAL(&g_conn_mux);
+	g_stats.idle_max_s = 0;
+
+	for (uint32_t idx = 0; idx < HTTP_SERVER_CONN_MAX_OPEN; ++idx)
+	{
+		if ((g_conns[idx].fd >= 0) && (0 == g_conns[idx].active) &&
+			((now_us - g_conns[idx].last_us) / 1000000 > g_stats.idle_max_s))
+		{
+			g_stats.idle_max_s = (uint32_t) ((now_us - g_conns[idx].last_us) / 1000000);
+		}
+	}
+
+	*p_stats = g_stats;
+	portEXIT_CRITICAL(&g_conn_mux);
+}
+
+static esp_err_t
+http_server_conn_open (httpd_handle_t h_server, int sockfd)
+{
+	http_server_conn_t * p_conn = NULL;
+
+	portENTER_CRITICAL(&g_conn_mux);
+	p_conn = http_server_conn_find(-1);
+
+	if (NULL != p_conn)
+	{
+		p_conn->fd = sockfd;
+		p_conn->opened_us = esp_timer_get_time();
+		p_conn->last_us = p_conn->opened_us;
+		p_conn->requests = 0;
+		p_conn->active = 0;
+
+		g_stats.open++;
+		g_stats.opened++;
+
+		if (g_stats.open > g_stats.open_max)
+		{
+			g_stats.open_max = g_stats.open;
+		}
+	}
+
+	portEXIT_CRITICAL(&g_conn_mux);
+
+	// The server never opens more than max_open_sockets, a full table
+	// would be a bookkeeping error: the connection is still served
+	//
+	if (NULL == p_conn)
+	{
+		ESP_LOGW(g_tag, "http_server_conn_open: no slot for socket %d", sockfd);
+	}
+
+	return ESP_OK;
+}
+
+static void
+http_server_conn_close (httpd_handle_t h_server, int sockfd)
+{
+	http_server_conn_t * p_conn = NULL;
+	uint32_t requests = 0;
+	int64_t opened_us = 0;
+
+	portENTER_CRITICAL(&g_conn_mux);
+	p_conn = http_server_conn_find(sockfd);
+
+	if (NULL != p_conn)
+	{
+		requests = p_conn->requests;
+		opened_us = p_conn->opened_us;
+
+		p_conn->fd = -1;
+		g_stats.open--;
+	}
+
+	portEXIT_CRITICAL(&g_conn_mux);
+
+	// Logging takes a lock, never inside the spinlock
+	//
+	if (NULL != p_conn)
+	{
+		ESP_LOGD(g_tag, "http_server_conn_close: socket %d, %u requests in %lld ms",
+				 sockfd, requests, (esp_timer_get_time() - opened_us) / 1000);
+	}
+
+	// With a close_fn the server leaves the socket to us
+	//
+	close(sockfd);
+}
+
+// Call with g_conn_mux taken
+//
+static http_server_conn_t *
+http_server_conn_find (int32_t fd)
+{
+	for (uint32_t idx = 0; idx < HTTP_SERVER_CONN_MAX_OPEN; ++idx)
+	{
+		if (fd == g_conns[idx].fd)
+		{
+			return &g_conns[idx];
+		}
+	}
+
+	return NULL;
+}
+
+#if CONFIG_HTTP_SERVER_IDLE_TIMEOUT_S > 0
+static void
+http_server_conn_reap_timer (void * p_arg)
+{
+	// The sessions belong to the server task, the check runs there
+	//
+	if (NULL != g_h_server)
+	{
+		httpd_queue_work(g_h_server, http_server_conn_reap, NULL);
+	}
+}
+
+static void
+http_server_conn_reap (void * p_arg)
+{
+	int64_t idle_limit_us = esp_timer_get_time() -
+							(int64_t) CONFIG_HTTP_SERVER_IDLE_TIMEOUT_S * 1000000;
+	int32_t idle_fds[HTTP_SERVER_CONN_MAX_OPEN] = {0};
+	uint32_t idle_count = 0;
+
+	portENTER_CRITICAL(&g_conn_mux);
+
+	for (uint32_t idx = 0; idx < HTTP_SERVER_CONN_MAX_OPEN; ++idx)
+	{
+		// A long handler (OTA upload) keeps its connection busy
+		//
+		if ((g_conns[idx].fd >= 0) && (0 == g_conns[idx].active) &&
+			(g_conns[idx].last_us < idle_limit_us))
+		{
+			idle_fds[idle_count++] = g_conns[idx].fd;
+		}
+	}
+
+	g_stats.closed_idle += idle_count;
+	portEXIT_CRITICAL(&g_conn_mux);
+
+	for (uint32_t idx = 0; idx < idle_count; ++idx)
+	{
+		ESP_LOGD(g_tag, "http_server_conn_reap: socket %d idle", idle_fds[idx]);
+		httpd_sess_trigger_close(g_h_server, idle_fds[idx]);
+	}
+}
+#endif
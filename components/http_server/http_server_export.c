@@ -0,0 +1,338 @@
+/*
+ * http_server_export.c
+ *
+ *  Created on: 19 oct 2026
+ *      Author: Filippo
+ */
+
+#include "http_server_export.h"
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sys/param.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+#include "sensor.h"
+#include "sensor_history.h"
+#include "sensor_log.h"
+#include "sensor_time.h"
+#include "http_server_scratch.h"
+#include "trace.h"
+#include "sdkconfig.h"
+
+// Samples copied out of the history at a time
+//
+#define HTTP_SERVER_EXPORT_BATCH	16
+
+// Longest binary record: 10 bytes of varint, id, tag and value
+//
+#define HTTP_SERVER_EXPORT_BIN_MAX	(10 + 1 + 1 + sizeof(float))
+
+static const char g_tag[] = "http_export";
+
+// Chunk being filled in the scratch block
+//
+typedef struct http_server_export
+{
+	httpd_req_t * p_req;
+	uint8_t * p_chunk;
+	size_t len;
+	size_t total;
+	esp_err_t err;
+	bool b_binary;
+	bool b_utc;					// offset_ms is known
+	uint16_t boot;
+	int64_t offset_ms;			// From time since boot to UTC
+	int64_t prev_ms;			// Timestamp of the previous binary record
+	uint32_t samples;
+} http_server_export_t;
+
+static esp_err_t http_server_export_run(httpd_req_t * p_req, bool b_binary);
+static void http_server_export_append(http_server_export_t * p_exp,
+									  const void * p_data, size_t len);
+static void http_server_export_flush(http_server_export_t * p_exp);
+static void http_server_export_sample(http_server_export_t * p_exp,
+									  const sensor_sample_t * p_sample);
+#if CONFIG_SENSOR_LOG
+static esp_err_t http_server_export_log_sample(const sensor_sample_t * p_sample,
+											   void * p_arg);
+#endif
+static int64_t http_server_export_query_ms(const char * p_query,
+										   const char * p_key, int64_t def);
+
+esp_err_t
+http_server_export_csv_handler (httpd_req_t * p_req)
+{
+	esp_err_t err = ESP_OK;
+
+	TRACE_BEGIN("http export.csv");
+	err = http_server_export_run(p_req, false);
+	TRACE_END("http export.csv");
+
+	return err;
+}
+
+esp_err_t
+http_server_export_bin_handler (httpd_req_t * p_req)
+{
+	esp_err_t err = ESP_OK;
+
+	TRACE_BEGIN("http export.bin");
+	err = http_server_export_run(p_req, true);
+	TRACE_END("http export.bin");
+
+	return err;
+}
+
+static esp_err_t
+http_server_export_run (httpd_req_t * p_req, bool b_binary)
+{
+	char query[96] = {0};
+	char source[8] = {0};
+	sensor_sample_t batch[HTTP_SERVER_EXPORT_BATCH];
+	http_server_export_t exp = {
+		.p_req = p_req,
+		.p_chunk = http_server_scratch_get(p_req),
+		.err = ESP_OK,
+		.b_binary = b_binary
+	};
+	int64_t from_ms = 0;
+	int64_t to_ms = INT64_MAX;
+	int64_t boot = -1;
+	int64_t start_us = esp_timer_get_time();
+	bool b_done = false;
+	bool b_flash = false;
+
+	if (NULL == exp.p_chunk)
+	{
+		return http_server_scratch_busy(p_req);
+	}
+
+	if (ESP_OK == httpd_req_get_url_query_str(p_req, query, sizeof(query)))
+	{
+		from_ms = http_server_export_query_ms(query, "from", from_ms);
+		to_ms = http_server_export_query_ms(query, "to", to_ms);
+		boot = http_server_export_query_ms(query, "boot", boot);
+		httpd_query_key_value(query, "source", source, sizeof(source));
+	}
+
+#if CONFIG_SENSOR_LOG
+	// The flash log reaches back further than the RAM history
+	//
+	b_flash = (0 == strcmp(source, "flash"));
+#endif
+
+	// Samples pushed while the export runs are left for the next one
+	//
+	uint32_t seq = sensor_history_oldest_seq();
+	uint32_t end_seq = sensor_history_next_seq();
+
+	// The RAM history only holds the current boot. The offset is read
+	// once, a sync during the export does not split it.
+	//
+	exp.boot = ((true == b_flash) && (boot >= 0)) ? (uint16_t) boot :
+												sensor_time_boot_id();
+	exp.b_utc = sensor_time_utc_offset_ms(exp.boot, &exp.offset_ms);
+
+	if (true == b_binary)
+	{
+		int64_t offset_ms = (true == exp.b_utc) ? exp.offset_ms : 0;
+
+		httpd_resp_set_type(p_req, "application/octet-stream");
+		httpd_resp_set_hdr(p_req, "Content-Disposition",
+						   "attachment; filename=\"export.bin\"");
+		http_server_export_append(&exp, HTTP_SERVER_EXPORT_MAGIC,
+								  strlen(HTTP_SERVER_EXPORT_MAGIC));
+
+		// Boot header, little endian like the values
+		//
+		http_server_export_append(&exp, &exp.boot, sizeof(exp.boot));
+		http_server_export_append(&exp, &offset_ms, sizeof(offset_ms));
+	}
+	else
+	{
+		httpd_resp_set_type(p_req, "text/csv");
+		httpd_resp_set_hdr(p_req, "Content-Disposition",
+						   "attachment; filename=\"export.csv\"");
+		http_server_export_append(&exp, "timestamp_ms,sensor_id,quantity,unit,value,tag,boot,utc_ms\n",
+								  strlen("timestamp_ms,sensor_id,quantity,unit,value,tag,boot,utc_ms\n"));
+	}
+
+#if CONFIG_SENSOR_LOG
+	if (true == b_flash)
+	{
+		esp_err_t err = sensor_log_query((boot < 0) ? SENSOR_LOG_BOOT_CURRENT : (uint16_t) boot,
+										 from_ms, to_ms, http_server_export_log_sample, &exp);
+
+		if ((ESP_OK != err) && (ESP_OK == exp.err))
+		{
+			exp.err = err;
+		}
+	}
+#endif
+
+	while ((false == b_flash) && (false == b_done) && (ESP_OK == exp.err) &&
+		   (seq < end_seq))
+	{
+		int32_t count = sensor_history_read(&seq, batch, HTTP_SERVER_EXPORT_BATCH);
+
+		// Sequence of batch[0], the read skips what was overwritten
+		//
+		uint32_t first_seq = seq - count;
+
+		if (0 == count)
+		{
+			break;
+		}
+
+		for (int32_t idx = 0; idx < count; ++idx)
+		{
+			int64_t sample_ms = batch[idx].timestamp_us / 1000;
+
+			// The history is in time order
+			//
+			if ((first_seq + idx >= end_seq) || (sample_ms > to_ms))
+			{
+				b_done = true;
+				break;
+			}
+
+			if (sample_ms >= from_ms)
+			{
+				http_server_export_sample(&exp, &batch[idx]);
+			}
+		}
+	}
+
+	http_server_export_flush(&exp);
+
+	if (ESP_OK != exp.err)
+	{
+		ESP_LOGW(g_tag, "http_server_export_run: %s after %u bytes",
+				 esp_err_to_name(exp.err), exp.total);
+
+		// Closes the connection, the client sees a truncated transfer
+		//
+		return ESP_FAIL;
+	}
+
+	httpd_resp_send_chunk(p_req, NULL, 0);
+
+	int64_t elapsed_us = esp_timer_get_time() - start_us;
+
+	ESP_LOGI(g_tag, "http_server_export_run: %s, %u samples, %u bytes in %lld ms, %lld KB/s",
+			 (true == b_binary) ? "bin" : "csv", exp.samples, exp.total,
+			 elapsed_us / 1000,
+			 (elapsed_us > 0) ? ((int64_t) exp.total * 1000000 / 1024 / elapsed_us) : 0);
+
+	return ESP_OK;
+}
+
+static void
+http_server_export_append (http_server_export_t * p_exp, const void * p_data,
+						   size_t len)
+{
+	if (p_exp->len + len > HTTP_SERVER_SCRATCH_SIZE)
+	{
+		http_server_export_flush(p_exp);
+	}
+
+	memcpy(p_exp->p_chunk + p_exp->len, p_data, len);
+	p_exp->len += len;
+}
+
+static void
+http_server_export_flush (http_server_export_t * p_exp)
+{
+	if ((0 == p_exp->len) || (ESP_OK != p_exp->err))
+	{
+		return;
+	}
+
+	p_exp->err = httpd_resp_send_chunk(p_exp->p_req, (const char *) p_exp->p_chunk,
+									   p_exp->len);
+	p_exp->total += p_exp->len;
+	p_exp->len = 0;
+}
+
+static void
+http_server_export_sample (http_server_export_t * p_exp,
+						   const sensor_sample_t * p_sample)
+{
+	int64_t sample_ms = p_sample->timestamp_us / 1000;
+
+	p_exp->samples++;
+
+	if (true == p_exp->b_binary)
+	{
+		uint8_t record[HTTP_SERVER_EXPORT_BIN_MAX] = {0};
+		uint64_t delta = (uint64_t) (sample_ms - p_exp->prev_ms);
+		size_t len = 0;
+
+		// Samples of one read share the timestamp, the delta is often
+		// a single 0 byte
+		//
+		do
+		{
+			record[len++] = (uint8_t) ((delta & 0x7F) | ((delta > 0x7F) ? 0x80 : 0));
+			delta >>= 7;
+		} while (delta > 0);
+
+		record[len++] = (uint8_t) ((p_sample->sensor_id << 4) | (p_sample->quantity & 0x0F));
+		record[len++] = p_sample->tag;
+
+		// The ESP32 is little endian
+		//
+		memcpy(&record[len], &p_sample->value, sizeof(float));
+		len += sizeof(float);
+
+		p_exp->prev_ms = sample_ms;
+		http_server_export_append(p_exp, record, len);
+	}
+	else
+	{
+		char line[128] = {0};
+		char utc[24] = {0};
+		int32_t len = 0;
+
+		if (true == p_exp->b_utc)
+		{
+			snprintf(utc, sizeof(utc), "%lld", sample_ms + p_exp->offset_ms);
+		}
+
+		len = snprintf(line, sizeof(line), "%lld,%u,%s,%s,%.2f,%u,%u,%s\n",
+					   sample_ms, p_sample->sensor_id,
+					   sensor_quantity_name((sensor_quantity_t) p_sample->quantity),
+					   sensor_unit_name((sensor_unit_t) p_sample->unit),
+					   p_sample->value, p_sample->tag, p_exp->boot, utc);
+
+		http_server_export_append(p_exp, line, MIN((size_t) len, sizeof(line) - 1));
+	}
+}
+
+#if CONFIG_SENSOR_LOG
+static esp_err_t
+http_server_export_log_sample (const sensor_sample_t * p_sample, void * p_arg)
+{
+	http_server_export_t * p_exp = (http_server_export_t *) p_arg;
+
+	http_server_export_sample(p_exp, p_sample);
+
+	return p_exp->err;
+}
+#endif
+
+static int64_t
+http_server_export_query_ms (const char * p_query, const char * p_key,
+							 int64_t def)
+{
+	char value[24] = {0};
+
+	if (ESP_OK != httpd_query_key_value(p_query, p_key, value, sizeof(value)))
+	{
+		return def;
+	}
+
+	return strtoll(value, NULL, 10);
+}
@@ -0,0 +1,101 @@
+/*
+ * http_server_multipart.c
+ *
+ *  Created on: 19 oct 2026
+ *      Author: Filippo
+ */
+
+#include "http_server_multipart.h"
+#include <string.h>
+
+#define HTTP_SERVER_MULTIPART_HEADERS_END	"\r\n\r\n"
+
+// "\r\n--" <boundary> "--\r\n"
+//
+#define HTTP_SERVER_MULTIPART_DELIMITER_LEN	8
+
+void
+http_server_multipart_init (http_server_multipart_t * p_part,
+							const char * p_content_type, int32_t content_length)
+{
+	const char * p_boundary = NULL;
+	size_t boundary_len = 0;
+
+	memset(p_part, 0, sizeof(*p_part));
+	p_part->file_end = content_length;
+
+	if (NULL != p_content_type)
+	{
+		p_boundary = strstr(p_content_type, "boundary=");
+	}
+
+	if (NULL == p_boundary)
+	{
+		return;
+	}
+
+	p_boundary += strlen("boundary=");
+
+	// The boundary may be quoted
+	//
+	if ('"' == *p_boundary)
+	{
+		p_boundary++;
+		boundary_len = strcspn(p_boundary, "\"");
+	}
+	else
+	{
+		boundary_len = strcspn(p_boundary, "; \t");
+	}
+
+	if ((int32_t) (boundary_len + HTTP_SERVER_MULTIPART_DELIMITER_LEN) <= content_length)
+	{
+		p_part->file_end = content_length -
+						   (int32_t) (boundary_len + HTTP_SERVER_MULTIPART_DELIMITER_LEN);
+	}
+}
+
+bool
+http_server_multipart_feed (http_server_multipart_t * p_part,
+							const char * p_chunk, size_t len,
+							const char ** pp_file, size_t * p_file_len)
+{
+	size_t skip = 0;
+	int32_t chunk_end = p_part->offset + (int32_t) len;
+
+	*pp_file = p_chunk;
+	*p_file_len = 0;
+
+	// The part headers end in the first chunk, the scratch block holds
+	// them whole
+	//
+	if (false == p_part->b_file)
+	{
+		const size_t marker_len = strlen(HTTP_SERVER_MULTIPART_HEADERS_END);
+
+		while ((skip + marker_len <= len) &&
+			   (0 != memcmp(p_chunk + skip, HTTP_SERVER_MULTIPART_HEADERS_END, marker_len)))
+		{
+			skip++;
+		}
+
+		if (skip + marker_len > len)
+		{
+			return false;
+		}
+
+		skip += marker_len;
+		p_part->b_file = true;
+	}
+
+	if (p_part->offset + (int32_t) skip < p_part->file_end)
+	{
+		*pp_file = p_chunk + skip;
+		*p_file_len = (size_t) (((chunk_end < p_part->file_end) ? chunk_end : p_part->file_end) -
+								(p_part->offset + (int32_t) skip));
+	}
+
+	p_part->offset = chunk_end;
+
+	return true;
+}
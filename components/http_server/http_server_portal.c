@@ -0,0 +1,134 @@
+/*
+ * http_server_portal.c
+ *
+ *  Created on: 19 oct 2026
+ *      Author: Filippo
+ */
+
+#include "http_server_portal.h"
+#include <stdbool.h>
+#include <string.h>
+#include "lwip/sockets.h"
+#include "esp_log.h"
+#include "wifi_app.h"
+#include "http_server_scratch.h"
+#include "http_server_conn.h"
+#include "sdkconfig.h"
+
+static const char g_tag[] = "http_portal";
+
+// Pages the systems fetch to find out whether they are behind a portal
+//
+static const char * const g_probe_uris[HTTP_SERVER_PORTAL_URI_HANDLERS] = {
+	"/generate_204",			// Android, ChromeOS
+	"/hotspot-detect.html",		// iOS, macOS
+	"/connecttest.txt",			// Windows 10 and later
+	"/ncsi.txt",				// Older Windows
+	"/canonical.html"			// Firefox
+};
+
+static esp_err_t http_server_portal_probe_handler(httpd_req_t * p_req);
+static esp_err_t http_server_portal_not_found_handler(httpd_req_t * p_req,
+													  httpd_err_code_t error);
+static esp_err_t http_server_portal_redirect(httpd_req_t * p_req);
+static bool http_server_portal_is_ap(httpd_req_t * p_req);
+
+void
+http_server_portal_register (httpd_handle_t h_server)
+{
+	for (uint8_t idx = 0; idx < HTTP_SERVER_PORTAL_URI_HANDLERS; ++idx)
+	{
+		httpd_uri_t probe = {
+			.uri = g_probe_uris[idx],
+			.method = HTTP_GET,
+			.handler = http_server_scratch_dispatch,
+			.user_ctx = (void *) http_server_portal_probe_handler
+		};
+
+		httpd_register_uri_handler(h_server, &probe);
+	}
+
+	// Whatever else the systems try, a name that resolved to the access
+	// point ends up here
+	//
+	httpd_register_err_handler(h_server, HTTPD_404_NOT_FOUND,
+							   http_server_portal_not_found_handler);
+}
+
+static esp_err_t
+http_server_portal_probe_handler (httpd_req_t * p_req)
+{
+	if (false == http_server_portal_is_ap(p_req))
+	{
+		return httpd_resp_send_404(p_req);
+	}
+
+	ESP_LOGD(g_tag, "probe %s", p_req->uri);
+
+	return http_server_portal_redirect(p_req);
+}
+
+static esp_err_t
+http_server_portal_not_found_handler (httpd_req_t * p_req,
+									  httpd_err_code_t error)
+{
+	esp_err_t err = ESP_OK;
+
+	if ((HTTP_GET != p_req->method) || (false == http_server_portal_is_ap(p_req)))
+	{
+		// As without the handler: a body may be left unread, the
+		// connection is closed
+		//
+		httpd_resp_send_err(p_req, error, NULL);
+
+		return ESP_FAIL;
+	}
+
+	http_server_conn_request_begin(p_req);
+	err = http_server_portal_redirect(p_req);
+	http_server_conn_request_end(p_req);
+
+	return err;
+}
+
+static esp_err_t
+http_server_portal_redirect (httpd_req_t * p_req)
+{
+	httpd_resp_set_status(p_req, "302 Found");
+	httpd_resp_set_hdr(p_req, "Location", "http://" WIFI_AP_IP "/");
+	httpd_resp_set_hdr(p_req, "Cache-Control", "no-store");
+
+	return httpd_resp_send(p_req, NULL, 0);
+}
+
+// Whether the request came in on the access point address
+//
+static bool
+http_server_portal_is_ap (httpd_req_t * p_req)
+{
+	struct sockaddr_storage local = {0};
+	socklen_t len = sizeof(local);
+	uint32_t addr = 0;
+
+	if (0 != getsockname(httpd_req_to_sockfd(p_req),
+						 (struct sockaddr *) &local, &len))
+	{
+		return false;
+	}
+
+	if (AF_INET == local.ss_family)
+	{
+		addr = ((struct sockaddr_in *) &local)->sin_addr.s_addr;
+	}
+#if CONFIG_LWIP_IPV6
+	else if (AF_INET6 == local.ss_family)
+	{
+		// The server listens on IPv6, IPv4 clients show up mapped
+		//
+		memcpy(&addr, &((struct sockaddr_in6 *) &local)->sin6_addr.s6_addr[12],
+			   sizeof(addr));
+	}
+#endif
+
+	return (inet_addr(WIFI_AP_IP) == addr);
+}
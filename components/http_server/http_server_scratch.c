@@ -0,0 +1,140 @@
+/*
+ * http_server_scratch.c
+ *
+ *  Created on: 19 oct 2026
+ *      Author: Filippo
+ */
+
+#include "http_server_scratch.h"
+#include "http_server_conn.h"
+#include "freertos/FreeRTOS.h"
+#include "esp_log.h"
+
+_Static_assert(CONFIG_HTTP_SERVER_SCRATCH_BLOCKS <= 32,
+			   "The free blocks are a 32 bit mask");
+
+static const char g_tag[] = "http_scratch";
+
+// Request state while its handler runs, reached through user_ctx
+//
+typedef struct http_server_scratch_ctx
+{
+	http_server_handler_t handler;
+	void * p_block;
+} http_server_scratch_ctx_t;
+
+static uint32_t g_blocks[CONFIG_HTTP_SERVER_SCRATCH_BLOCKS]
+						[CONFIG_HTTP_SERVER_SCRATCH_BLOCK_SIZE / sizeof(uint32_t)];
+static uint32_t g_used_mask = 0;
+static http_server_scratch_stats_t g_stats = {0};
+static portMUX_TYPE g_scratch_mux = portMUX_INITIALIZER_UNLOCKED;
+
+static void * http_server_scratch_take(void);
+static void http_server_scratch_give(void * p_block);
+
+esp_err_t
+http_server_scratch_dispatch (httpd_req_t * p_req)
+{
+	http_server_scratch_ctx_t ctx = {
+		.handler = (http_server_handler_t) p_req->user_ctx,
+		.p_block = NULL
+	};
+	esp_err_t err = ESP_OK;
+
+	// Every request passes here, on the server task
+	//
+	http_server_conn_request_begin(p_req);
+	p_req->user_ctx = &ctx;
+	err = ctx.handler(p_req);
+	http_server_conn_request_end(p_req);
+
+	if (NULL != ctx.p_block)
+	{
+		http_server_scratch_give(ctx.p_block);
+	}
+
+	return err;
+}
+
+void *
+http_server_scratch_get (httpd_req_t * p_req)
+{
+	http_server_scratch_ctx_t * p_ctx = (http_server_scratch_ctx_t *) p_req->user_ctx;
+
+	if (NULL == p_ctx->p_block)
+	{
+		p_ctx->p_block = http_server_scratch_take();
+	}
+
+	return p_ctx->p_block;
+}
+
+esp_err_t
+http_server_scratch_busy (httpd_req_t * p_req)
+{
+	httpd_resp_set_status(p_req, "503 Service Unavailable");
+	httpd_resp_set_hdr(p_req, "Retry-After", "1");
+
+	return httpd_resp_send(p_req, NULL, 0);
+}
+
+void
+http_server_scratch_get_stats (http_server_scratch_stats_t * p_stats)
+{
+	portENTER_CRITICAL(&g_scratch_mux);
+	*p_stats = g_stats;
+	portEXIT_CRITICAL(&g_scratch_mux);
+}
+
+static void *
+http_server_scratch_take (void)
+{
+	void * p_block = NULL;
+
+	portENTER_CRITICAL(&g_scratch_mux);
+
+	for (uint32_t idx = 0; idx < CONFIG_HTTP_SERVER_SCRATCH_BLOCKS; ++idx)
+	{
+		if (0 == (g_used_mask & (1U << idx)))
+		{
+			g_used_mask |= (1U << idx);
+			p_block = g_blocks[idx];
+			break;
+		}
+	}
+
+	if (NULL != p_block)
+	{
+		g_stats.in_use++;
+
+		if (g_stats.in_use > g_stats.in_use_max)
+		{
+			g_stats.in_use_max = g_stats.in_use;
+		}
+	}
+	else
+	{
+		g_stats.exhausted++;
+	}
+
+	portEXIT_CRITICAL(&g_scratch_mux);
+
+	if (NULL == p_block)
+	{
+		ESP_LOGW(g_tag, "http_server_scratch_take: all %d blocks in use",
+				 CONFIG_HTTP_SERVER_SCRATCH_BLOCKS);
+	}
+
+	return p_block;
+}
+
+static void
+http_server_scratch_give (void * p_block)
+{
+	uint32_t idx = ((uint8_t *) p_block - (uint8_t *) g_blocks) / sizeof(g_blocks[0]);
+
+	portENTER_CRITICAL(&g_scratch_mux);
+	g_used_mask &= ~(1U << idx);
+	g_stats.in_use--;
+	portEXIT_CRITICAL(&g_scratch_mux);
+}
@@ -5,8 +5,8 @@
  *      Author: Filippo
  */
 
-#ifndef MAIN_HTTP_SERVER_H_
-#	define MAIN_HTTP_SERVER_H_
+#ifndef COMPONENTS_HTTP_SERVER_H_
+#	define COMPONENTS_HTTP_SERVER_H_
 
 #	include "freertos/FreeRTOS.h"
 
@@ -14,7 +14,10 @@
 #	define OTA_UPDATE_SUCCESSFUL	1
 #	define OTA_UPDATE_FAILED		-1
 
-#	define OTA_REMOVE_WEB_FORM_DATA	"\r\n\r\n"
+// Socket timeouts in a row before an upload is given up: the handler
+// holds the server task, a stalled client must not keep it forever
+//
+#	define OTA_MAX_SOCKET_TIMEOUTS	3
 
 // Connection status for WiFi
 //
@@ -51,4 +54,4 @@ void http_server_start(void);
 void http_server_stop(void);
 void http_server_fw_update_reset_callback(void * p_arg);
 
-#endif /* MAIN_HTTP_SERVER_H_ */
+#endif /* COMPONENTS_HTTP_SERVER_H_ */
@@ -0,0 +1,43 @@
+/*
+ * http_server_conn.h
+ *
+ *  Created on: 19 oct 2026
+ *      Author: Filippo
+ */
+
+#ifndef COMPONENTS_HTTP_SERVER_CONN_H_
+#	define COMPONENTS_HTTP_SERVER_CONN_H_
+
+#	include <stdint.h>
+#	include "esp_http_server.h"
+
+typedef struct http_server_conn_stats
+{
+	uint32_t max_open;			// Socket limit given to the server
+	uint32_t open;
+	uint32_t open_max;
+	uint32_t opened;
+	uint32_t closed_idle;		// Closed by the idle timeout
+	uint32_t requests;
+	uint32_t idle_max_s;		// Longest idle time of an open connection
+} http_server_conn_stats_t;
+
+// Socket limit, LRU purge and session callbacks in the server config
+//
+void http_server_conn_configure(httpd_config_t * p_config);
+
+// Starts closing the connections idle for longer than
+// CONFIG_HTTP_SERVER_IDLE_TIMEOUT_S, until http_server_conn_stop()
+//
+void http_server_conn_start(httpd_handle_t h_server);
+void http_server_conn_stop(void);
+
+// Request accounting, called around every handler. A connection with a
+// handler running is never closed as idle.
+//
+void http_server_conn_request_begin(httpd_req_t * p_req);
+void http_server_conn_request_end(httpd_req_t * p_req);
+
+void http_server_conn_get_stats(http_server_conn_stats_t * p_stats);
+
+#endif /* COMPONENTS_HTTP_SERVER_CONN_H_ */
@@ -0,0 +1,40 @@
+/*
+ * http_server_export.h
+ *
+ *  Created on: 19 oct 2026
+ *      Author: Filippo
+ */
+
+#ifndef COMPONENTS_HTTP_SERVER_EXPORT_H_
+#	define COMPONENTS_HTTP_SERVER_EXPORT_H_
+
+#	include "esp_http_server.h"
+
+// Sensor history export, streamed from the history ring in chunks of one
+// scratch block. Both take from=<ms> and to=<ms>, times since boot, to
+// keep only the samples in [from, to]. source=flash reads the flash log
+// instead of the RAM history, boot=<n> an earlier boot than the current.
+//
+// Every sample of an export belongs to one boot. Its UTC time is the
+// time since boot plus the offset the first SNTP sync of that boot
+// recorded, samples taken before the sync included.
+//
+// /export.csv: timestamp_ms,sensor_id,quantity,unit,value,tag,boot,utc_ms
+//   utc_ms is empty when the boot never synced
+//
+// /export.bin: the magic "SHB2", then
+//   uint16	boot, little endian
+//   int64	UTC offset in ms, little endian, 0 when the boot never synced
+// and one record per sample:
+//   varint	timestamp delta from the previous record in ms (LEB128),
+//			from 0 for the first record
+//   uint8	sensor_id << 4 | quantity
+//   uint8	tag
+//   float	value, little endian
+//
+#	define HTTP_SERVER_EXPORT_MAGIC		"SHB2"
+
+esp_err_t http_server_export_csv_handler(httpd_req_t * p_req);
+esp_err_t http_server_export_bin_handler(httpd_req_t * p_req);
+
+#endif /* COMPONENTS_HTTP_SERVER_EXPORT_H_ */
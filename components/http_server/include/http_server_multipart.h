@@ -0,0 +1,45 @@
+/*
+ * http_server_multipart.h
+ *
+ *  Created on: 19 oct 2026
+ *      Author: Filippo
+ */
+
+#ifndef COMPONENTS_HTTP_SERVER_MULTIPART_H_
+#	define COMPONENTS_HTTP_SERVER_MULTIPART_H_
+
+#	include <stdbool.h>
+#	include <stddef.h>
+#	include <stdint.h>
+
+// File of a multipart/form-data upload with a single part, the way
+// FormData sends it:
+//
+//   --<boundary>\r\n<part headers>\r\n\r\n<file>\r\n--<boundary>--\r\n
+//
+// The body is fed chunk by chunk, only the file bytes come out. No
+// ESP-IDF dependency, the host check in tools/ builds it too.
+//
+typedef struct http_server_multipart
+{
+	int32_t file_end;			// Body offset of the closing delimiter
+	int32_t offset;				// Body bytes fed so far
+	bool b_file;				// Past the part headers
+} http_server_multipart_t;
+
+// content_length is the whole body. Without a boundary in p_content_type
+// the file runs up to the end of the body.
+//
+void http_server_multipart_init(http_server_multipart_t * p_part,
+								const char * p_content_type,
+								int32_t content_length);
+
+// File bytes of the next chunk of the body, in *pp_file and *p_file_len
+// (none once the closing delimiter is reached). False when the first
+// chunk does not hold the end of the part headers.
+//
+bool http_server_multipart_feed(http_server_multipart_t * p_part,
+								const char * p_chunk, size_t len,
+								const char ** pp_file, size_t * p_file_len);
+
+#endif /* COMPONENTS_HTTP_SERVER_MULTIPART_H_ */
@@ -0,0 +1,22 @@
+/*
+ * http_server_portal.h
+ *
+ *  Created on: 19 oct 2026
+ *      Author: Filippo
+ */
+
+#ifndef COMPONENTS_HTTP_SERVER_PORTAL_H_
+#	define COMPONENTS_HTTP_SERVER_PORTAL_H_
+
+#	include "esp_http_server.h"
+
+// Captive portal (CONFIG_WIFI_APP_CAPTIVE_PORTAL). The connectivity
+// checks of the operating systems, and any other unknown page asked
+// through the access point, are redirected to the dashboard. Requests
+// from the station side still get a 404.
+//
+#	define HTTP_SERVER_PORTAL_URI_HANDLERS	5
+
+void http_server_portal_register(httpd_handle_t h_server);
+
+#endif /* COMPONENTS_HTTP_SERVER_PORTAL_H_ */
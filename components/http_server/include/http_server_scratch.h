@@ -0,0 +1,42 @@
+/*
+ * http_server_scratch.h
+ *
+ *  Created on: 19 oct 2026
+ *      Author: Filippo
+ */
+
+#ifndef COMPONENTS_HTTP_SERVER_SCRATCH_H_
+#	define COMPONENTS_HTTP_SERVER_SCRATCH_H_
+
+#	include <stdint.h>
+#	include "esp_http_server.h"
+#	include "sdkconfig.h"
+
+#	define HTTP_SERVER_SCRATCH_SIZE		CONFIG_HTTP_SERVER_SCRATCH_BLOCK_SIZE
+
+typedef esp_err_t (*http_server_handler_t)(httpd_req_t * p_req);
+
+typedef struct http_server_scratch_stats
+{
+	uint32_t in_use;
+	uint32_t in_use_max;
+	uint32_t exhausted;			// Requests that found no free block
+} http_server_scratch_stats_t;
+
+// URI handler registered for every route, with the real handler as
+// user_ctx. It returns the request's scratch block when the handler ends.
+//
+esp_err_t http_server_scratch_dispatch(httpd_req_t * p_req);
+
+// HTTP_SERVER_SCRATCH_SIZE bytes for the current request, the same block
+// on every call. NULL when the pool is exhausted.
+//
+void * http_server_scratch_get(httpd_req_t * p_req);
+
+// Answers 503 to a request that got no scratch block
+//
+esp_err_t http_server_scratch_busy(httpd_req_t * p_req);
+
+void http_server_scratch_get_stats(http_server_scratch_stats_t * p_stats);
+
+#endif /* COMPONENTS_HTTP_SERVER_SCRATCH_H_ */
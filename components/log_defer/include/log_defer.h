@@ -0,0 +1,42 @@
+/*
+ * log_defer.h
+ *
+ *  Created on: 19 oct 2026
+ *      Author: Filippo
+ */
+
+#ifndef COMPONENTS_LOG_DEFER_H_
+#	define COMPONENTS_LOG_DEFER_H_
+
+#	include <stdbool.h>
+#	include <stdint.h>
+#	include "esp_err.h"
+#	include "esp_log.h"
+
+typedef struct log_defer_stats
+{
+	uint32_t captured;			// Lines stored in the ring
+	uint32_t dropped;			// Lines lost because the ring was full
+	uint32_t suppressed;		// Lines over the per tag rate limit
+	uint32_t pending;			// Lines waiting to be printed
+} log_defer_stats_t;
+
+// Redirects the ESP log output to the ring and starts the formatter task
+//
+void log_defer_start(void);
+
+// Global counters
+//
+void log_defer_get_stats(log_defer_stats_t * p_stats);
+
+// Rate limiter entry by index, false past the last one
+//
+bool log_defer_get_tag_stats(uint32_t index, const char ** pp_tag,
+							 uint32_t * p_suppressed);
+
+// Runtime level: "*" for every tag. Names: none, error, warn, info,
+// debug, verbose
+//
+esp_err_t log_defer_set_level(const char * p_tag, const char * p_level);
+
+#endif /* COMPONENTS_LOG_DEFER_H_ */
@@ -0,0 +1,787 @@
+/*
+ * log_defer.c
+ *
+ *  Created on: 19 oct 2026
+ *      Author: Filippo
+ */
+
+#include "log_defer.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "soc/soc_memory_layout.h"
+#include "app_static.h"
+#include "sdkconfig.h"
+
+static const char * const g_level_names[] = {
+	[ESP_LOG_NONE] = "none",
+	[ESP_LOG_ERROR] = "error",
+	[ESP_LOG_WARN] = "warn",
+	[ESP_LOG_INFO] = "info",
+	[ESP_LOG_DEBUG] = "debug",
+	[ESP_LOG_VERBOSE] = "verbose"
+};
+
+#if CONFIG_LOG_DEFER_ENABLE
+
+_Static_assert(0 == (CONFIG_LOG_DEFER_SLOTS & (CONFIG_LOG_DEFER_SLOTS - 1)),
+			   "CONFIG_LOG_DEFER_SLOTS must be a power of two");
+
+// Longest conversion specification, e.g. "%-08.3lld"
+//
+#define LOG_DEFER_SPEC_SIZE			16
+
+// One conversion with its '*' arguments, used by log_defer_format()
+//
+#define LOG_DEFER_SNPRINTF(value)	\
+	((2 == conv.stars) ? snprintf(&p_line[pos], size - pos, spec, stars[0], stars[1], (value)) :	\
+	 ((1 == conv.stars) ? snprintf(&p_line[pos], size - pos, spec, stars[0], (value)) :			\
+	  snprintf(&p_line[pos], size - pos, spec, (value))))
+
+// Encoded argument kinds
+//
+typedef enum log_defer_arg
+{
+	LOG_DEFER_ARG_INT = 0,
+	LOG_DEFER_ARG_LONG,
+	LOG_DEFER_ARG_LLONG,
+	LOG_DEFER_ARG_DOUBLE,
+	LOG_DEFER_ARG_PTR,
+	LOG_DEFER_ARG_STR_REF,		// String in flash, only the address is kept
+	LOG_DEFER_ARG_STR_COPY		// Length byte followed by the characters
+} log_defer_arg_t;
+
+typedef struct log_defer_slot
+{
+	uint32_t seq;				// Ring position + 1 once the slot is filled
+	const char * p_fmt;
+	uint16_t payload_len;
+	bool b_truncated;
+	uint8_t payload[CONFIG_LOG_DEFER_PAYLOAD_SIZE];
+} log_defer_slot_t;
+
+typedef struct log_defer_tag
+{
+	const char * p_tag;
+	uint32_t window_ms;
+	uint32_t count;
+	uint32_t suppressed_window;
+	uint32_t suppressed_total;
+} log_defer_tag_t;
+
+// Conversion specification found by the format parser
+//
+typedef struct log_defer_conv
+{
+	const char * p_start;		// The '%'
+	uint32_t len;
+	uint8_t stars;				// '*' width and precision arguments
+	char type;					// Conversion character
+	log_defer_arg_t kind;
+} log_defer_conv_t;
+
+static log_defer_slot_t g_slots[CONFIG_LOG_DEFER_SLOTS] = {0};
+static uint32_t g_head = 0;
+static uint32_t g_tail = 0;
+
+static log_defer_tag_t g_tags[CONFIG_LOG_DEFER_MAX_TAGS] = {0};
+
+static uint32_t g_captured = 0;
+static uint32_t g_dropped = 0;
+static uint32_t g_suppressed = 0;
+
+static TaskHandle_t gh_task_log_defer = NULL;
+
+static const char g_suppressed_fmt[] = "W (%u) %s: %u lines suppressed\n";
+static const char g_dropped_fmt[] = "W (%u) log_defer: %u lines dropped\n";
+
+static int log_defer_vprintf(const char * p_fmt, va_list args);
+static void task_log_defer(void * p_param);
+static const char * log_defer_next_conv(const char * p_fmt,
+										log_defer_conv_t * p_conv);
+static uint16_t log_defer_encode(const char * p_fmt, va_list args,
+								 uint8_t * p_payload, bool * pb_truncated,
+								 const char ** pp_tag);
+static void log_defer_enqueue(const char * p_fmt, const uint8_t * p_payload,
+							  uint16_t payload_len, bool b_truncated);
+static void log_defer_enqueue_fmt(const char * p_fmt, ...);
+static bool log_defer_rate_limit(const char * p_tag);
+static void log_defer_format(const log_defer_slot_t * p_slot, char * p_line,
+							 uint32_t size);
+
+void
+log_defer_start (void)
+{
+	if (NULL != gh_task_log_defer)
+	{
+		return;
+	}
+
+	gh_task_log_defer = APP_TASK_CREATE_PINNED(task_log_defer, "log_defer",
+											   CONFIG_LOG_DEFER_TASK_STACK_SIZE, NULL,
+											   CONFIG_LOG_DEFER_TASK_PRIORITY,
+											   CONFIG_LOG_DEFER_TASK_CORE_ID);
+
+	esp_log_set_vprintf(log_defer_vprintf);
+}
+
+void
+log_defer_get_stats (log_defer_stats_t * p_stats)
+{
+	p_stats->captured = __atomic_load_n(&g_captured, __ATOMIC_RELAXED);
+	p_stats->dropped = __atomic_load_n(&g_dropped, __ATOMIC_RELAXED);
+	p_stats->suppressed = __atomic_load_n(&g_suppressed, __ATOMIC_RELAXED);
+	p_stats->pending = __atomic_load_n(&g_head, __ATOMIC_RELAXED) -
+					   __atomic_load_n(&g_tail, __ATOMIC_RELAXED);
+}
+
+bool
+log_defer_get_tag_stats (uint32_t index, const char ** pp_tag,
+						 uint32_t * p_suppressed)
+{
+	const char * p_tag = NULL;
+
+	if (index >= CONFIG_LOG_DEFER_MAX_TAGS)
+	{
+		return false;
+	}
+
+	p_tag = __atomic_load_n(&g_tags[index].p_tag, __ATOMIC_ACQUIRE);
+
+	if (NULL == p_tag)
+	{
+		return false;
+	}
+
+	*pp_tag = p_tag;
+	*p_suppressed = g_tags[index].suppressed_total;
+
+	return true;
+}
+
+// Runs in the caller of ESP_LOGx: no formatting and no output here
+//
+static int
+log_defer_vprintf (const char * p_fmt, va_list args)
+{
+	uint8_t payload[CONFIG_LOG_DEFER_PAYLOAD_SIZE];
+	bool b_truncated = false;
+	const char * p_tag = NULL;
+	uint16_t payload_len = log_defer_encode(p_fmt, args, payload,
+											&b_truncated, &p_tag);
+
+	if ((NULL != p_tag) && (false == log_defer_rate_limit(p_tag)))
+	{
+		return 0;
+	}
+
+	log_defer_enqueue(p_fmt, payload, payload_len, b_truncated);
+
+	return 0;
+}
+
+static void
+task_log_defer (void * p_param)
+{
+	static char line[CONFIG_LOG_DEFER_LINE_SIZE];
+	uint32_t dropped_reported = 0;
+	uint32_t dropped = 0;
+
+	for (;;)
+	{
+		ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(CONFIG_LOG_DEFER_FLUSH_MS));
+
+		for (;;)
+		{
+			uint32_t tail = __atomic_load_n(&g_tail, __ATOMIC_RELAXED);
+			log_defer_slot_t * p_slot = &g_slots[tail & (CONFIG_LOG_DEFER_SLOTS - 1)];
+
+			if ((tail + 1) != __atomic_load_n(&p_slot->seq, __ATOMIC_ACQUIRE))
+			{
+				break;
+			}
+
+			log_defer_format(p_slot, line, sizeof(line));
+			__atomic_store_n(&g_tail, tail + 1, __ATOMIC_RELEASE);
+			fputs(line, stdout);
+		}
+
+		dropped = __atomic_load_n(&g_dropped, __ATOMIC_RELAXED);
+
+		if (dropped != dropped_reported)
+		{
+			snprintf(line, sizeof(line), g_dropped_fmt, esp_log_timestamp(),
+					 dropped - dropped_reported);
+			fputs(line, stdout);
+			dropped_reported = dropped;
+		}
+
+		fflush(stdout);
+	}
+}
+
+// Finds the next conversion, NULL when there is none
+//
+static const char *
+log_defer_next_conv (const char * p_fmt, log_defer_conv_t * p_conv)
+{
+	const char * p_char = p_fmt;
+	uint8_t longs = 0;
+
+	for (;;)
+	{
+		p_char = strchr(p_char, '%');
+
+		if (NULL == p_char)
+		{
+			return NULL;
+		}
+
+		if ('%' != p_char[1])
+		{
+			break;
+		}
+
+		p_char += 2;
+	}
+
+	memset(p_conv, 0, sizeof(log_defer_conv_t));
+	p_conv->p_start = p_char++;
+
+	while ((NULL != strchr("-+ #0", *p_char)) && ('\0' != *p_char))
+	{
+		p_char++;
+	}
+
+	// Width and precision
+	//
+	for (uint8_t part = 0; part < 2; ++part)
+	{
+		if ((1 == part) && ('.' == *p_char))
+		{
+			p_char++;
+		}
+		else if (1 == part)
+		{
+			break;
+		}
+
+		if ('*' == *p_char)
+		{
+			p_conv->stars++;
+			p_char++;
+		}
+
+		while ((*p_char >= '0') && (*p_char <= '9'))
+		{
+			p_char++;
+		}
+	}
+
+	while ((NULL != strchr("hlLqjzt", *p_char)) && ('\0' != *p_char))
+	{
+		longs += ('l' == *p_char) ? 1 : ((('j' == *p_char) || ('q' == *p_char)) ? 2 : 0);
+		p_char++;
+	}
+
+	p_conv->type = *p_char;
+
+	switch (p_conv->type)
+	{
+		case 'f': case 'F': case 'e': case 'E':
+		case 'g': case 'G': case 'a': case 'A':
+			p_conv->kind = LOG_DEFER_ARG_DOUBLE;
+		break;
+
+		case 's':
+			p_conv->kind = LOG_DEFER_ARG_STR_REF;
+		break;
+
+		case 'p': case 'n':
+			p_conv->kind = LOG_DEFER_ARG_PTR;
+		break;
+
+		case '\0':
+			return NULL;
+
+		default:
+			p_conv->kind = (longs >= 2) ? LOG_DEFER_ARG_LLONG :
+						   ((1 == longs) ? LOG_DEFER_ARG_LONG : LOG_DEFER_ARG_INT);
+		break;
+	}
+
+	p_char++;
+	p_conv->len = p_char - p_conv->p_start;
+
+	return p_char;
+}
+
+static uint16_t
+log_defer_encode (const char * p_fmt, va_list args, uint8_t * p_payload,
+				  bool * pb_truncated, const char ** pp_tag)
+{
+	log_defer_conv_t conv = {0};
+	uint16_t len = 0;
+	uint32_t index = 0;
+	bool b_first_is_char = false;
+	const char * p_next = p_fmt;
+
+	while (NULL != (p_next = log_defer_next_conv(p_next, &conv)))
+	{
+		// '*' arguments are stored as plain ints before the value
+		//
+		for (uint8_t star = 0; star < conv.stars; ++star)
+		{
+			int32_t value = va_arg(args, int);
+
+			if ((len + 1 + sizeof(value)) > CONFIG_LOG_DEFER_PAYLOAD_SIZE)
+			{
+				*pb_truncated = true;
+				return len;
+			}
+
+			p_payload[len++] = LOG_DEFER_ARG_INT;
+			memcpy(&p_payload[len], &value, sizeof(value));
+			len += sizeof(value);
+		}
+
+		switch (conv.kind)
+		{
+			case LOG_DEFER_ARG_LLONG:
+			case LOG_DEFER_ARG_DOUBLE:
+			{
+				uint64_t value = 0;
+
+				if (LOG_DEFER_ARG_DOUBLE == conv.kind)
+				{
+					double real = va_arg(args, double);
+
+					memcpy(&value, &real, sizeof(value));
+				}
+				else
+				{
+					value = va_arg(args, long long);
+				}
+
+				if ((len + 1 + sizeof(value)) > CONFIG_LOG_DEFER_PAYLOAD_SIZE)
+				{
+					*pb_truncated = true;
+					return len;
+				}
+
+				p_payload[len++] = conv.kind;
+				memcpy(&p_payload[len], &value, sizeof(value));
+				len += sizeof(value);
+			}
+			break;
+
+			case LOG_DEFER_ARG_STR_REF:
+			{
+				const char * p_str = va_arg(args, const char *);
+
+				// ESP_LOGx lines start with "%c (%u) %s: ", the third
+				// argument is the tag
+				//
+				if ((2 == index) && (true == b_first_is_char))
+				{
+					*pp_tag = p_str;
+				}
+
+				if ((NULL == p_str) || esp_ptr_in_drom(p_str))
+				{
+					if ((len + 1 + sizeof(p_str)) > CONFIG_LOG_DEFER_PAYLOAD_SIZE)
+					{
+						*pb_truncated = true;
+						return len;
+					}
+
+					p_payload[len++] = LOG_DEFER_ARG_STR_REF;
+					memcpy(&p_payload[len], &p_str, sizeof(p_str));
+					len += sizeof(p_str);
+				}
+				else
+				{
+					// RAM strings may be gone when the line is printed
+					//
+					size_t copy = strlen(p_str);
+
+					if ((len + 2) > CONFIG_LOG_DEFER_PAYLOAD_SIZE)
+					{
+						*pb_truncated = true;
+						return len;
+					}
+
+					if (copy > (CONFIG_LOG_DEFER_PAYLOAD_SIZE - len - 2))
+					{
+						copy = CONFIG_LOG_DEFER_PAYLOAD_SIZE - len - 2;
+						*pb_truncated = true;
+					}
+
+					if (copy > UINT8_MAX)
+					{
+						copy = UINT8_MAX;
+					}
+
+					p_payload[len++] = LOG_DEFER_ARG_STR_COPY;
+					p_payload[len++] = (uint8_t) copy;
+					memcpy(&p_payload[len], p_str, copy);
+					len += copy;
+				}
+			}
+			break;
+
+			default:
+			{
+				uint32_t value = (LOG_DEFER_ARG_PTR == conv.kind) ?
+								 (uint32_t) va_arg(args, void *) :
+								 (uint32_t) va_arg(args, int);
+
+				if ((len + 1 + sizeof(value)) > CONFIG_LOG_DEFER_PAYLOAD_SIZE)
+				{
+					*pb_truncated = true;
+					return len;
+				}
+
+				p_payload[len++] = conv.kind;
+				memcpy(&p_payload[len], &value, sizeof(value));
+				len += sizeof(value);
+			}
+			break;
+		}
+
+		if (0 == index)
+		{
+			b_first_is_char = ('c' == conv.type);
+		}
+
+		index++;
+	}
+
+	return len;
+}
+
+static void
+log_defer_enqueue (const char * p_fmt, const uint8_t * p_payload,
+				   uint16_t payload_len, bool b_truncated)
+{
+	uint32_t head = __atomic_load_n(&g_head, __ATOMIC_RELAXED);
+	log_defer_slot_t * p_slot = NULL;
+
+	// Reserves a slot, lock free for any number of writers
+	//
+	do
+	{
+		if ((head - __atomic_load_n(&g_tail, __ATOMIC_ACQUIRE)) >= CONFIG_LOG_DEFER_SLOTS)
+		{
+			__atomic_fetch_add(&g_dropped, 1, __ATOMIC_RELAXED);
+			return;
+		}
+	} while (!__atomic_compare_exchange_n(&g_head, &head, head + 1, true,
+										  __ATOMIC_ACQ_REL, __ATOMIC_RELAXED));
+
+	p_slot = &g_slots[head & (CONFIG_LOG_DEFER_SLOTS - 1)];
+	p_slot->p_fmt = p_fmt;
+	p_slot->payload_len = payload_len;
+	p_slot->b_truncated = b_truncated;
+	memcpy(p_slot->payload, p_payload, payload_len);
+	__atomic_store_n(&p_slot->seq, head + 1, __ATOMIC_RELEASE);
+	__atomic_fetch_add(&g_captured, 1, __ATOMIC_RELAXED);
+
+	// Wake the formatter early when the ring fills up
+	//
+	if (((head + 1) - __atomic_load_n(&g_tail, __ATOMIC_RELAXED)) ==
+		(CONFIG_LOG_DEFER_SLOTS / 2))
+	{
+		xTaskNotifyGive(gh_task_log_defer);
+	}
+}
+
+static void
+log_defer_enqueue_fmt (const char * p_fmt, ...)
+{
+	uint8_t payload[CONFIG_LOG_DEFER_PAYLOAD_SIZE];
+	bool b_truncated = false;
+	const char * p_tag = NULL;
+	uint16_t payload_len = 0;
+	va_list args;
+
+	va_start(args, p_fmt);
+	payload_len = log_defer_encode(p_fmt, args, payload, &b_truncated, &p_tag);
+	va_end(args);
+
+	log_defer_enqueue(p_fmt, payload, payload_len, b_truncated);
+}
+
+// Fixed one second window per tag. Counters are updated without a lock:
+// a line more or less at the window edge does not matter.
+//
+static bool
+log_defer_rate_limit (const char * p_tag)
+{
+#if CONFIG_LOG_DEFER_RATE_LIMIT > 0
+	log_defer_tag_t * p_entry = NULL;
+	uint32_t now_ms = esp_log_timestamp();
+	uint32_t suppressed = 0;
+
+	for (uint32_t idx = 0; idx < CONFIG_LOG_DEFER_MAX_TAGS; ++idx)
+	{
+		const char * p_current = __atomic_load_n(&g_tags[idx].p_tag, __ATOMIC_ACQUIRE);
+		const char * p_empty = NULL;
+
+		if (p_current == p_tag)
+		{
+			p_entry = &g_tags[idx];
+			break;
+		}
+
+		if ((NULL == p_current) &&
+			(__atomic_compare_exchange_n(&g_tags[idx].p_tag, &p_empty, p_tag, false,
+										 __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE) ||
+			 (p_empty == p_tag)))
+		{
+			p_entry = &g_tags[idx];
+			break;
+		}
+	}
+
+	// Table full: no limit for the remaining tags
+	//
+	if (NULL == p_entry)
+	{
+		return true;
+	}
+
+	if ((now_ms - p_entry->window_ms) >= 1000)
+	{
+		suppressed = p_entry->suppressed_window;
+		p_entry->window_ms = now_ms;
+		p_entry->count = 0;
+		p_entry->suppressed_window = 0;
+
+		if (suppressed > 0)
+		{
+			log_defer_enqueue_fmt(g_suppressed_fmt, now_ms, p_tag, suppressed);
+		}
+	}
+
+	if (__atomic_add_fetch(&p_entry->count, 1, __ATOMIC_RELAXED) >
+		CONFIG_LOG_DEFER_RATE_LIMIT)
+	{
+		__atomic_fetch_add(&p_entry->suppressed_window, 1, __ATOMIC_RELAXED);
+		__atomic_fetch_add(&p_entry->suppressed_total, 1, __ATOMIC_RELAXED);
+		__atomic_fetch_add(&g_suppressed, 1, __ATOMIC_RELAXED);
+
+		return false;
+	}
+#endif
+
+	return true;
+}
+
+// Replays the format one conversion at a time with the stored arguments
+//
+static void
+log_defer_format (const log_defer_slot_t * p_slot, char * p_line, uint32_t size)
+{
+	log_defer_conv_t conv = {0};
+	const char * p_text = p_slot->p_fmt;
+	const char * p_next = NULL;
+	const uint8_t * p_arg = p_slot->payload;
+	const uint8_t * p_end = p_slot->payload + p_slot->payload_len;
+	uint32_t pos = 0;
+	char spec[LOG_DEFER_SPEC_SIZE] = {0};
+
+	while ((pos < (size - 1)) && (NULL != (p_next = log_defer_next_conv(p_text, &conv))))
+	{
+		int32_t stars[2] = {0};
+		uint32_t literal = conv.p_start - p_text;
+		int32_t written = 0;
+
+		// Literal text before the conversion, "%%" included
+		//
+		for (uint32_t idx = 0; (idx < literal) && (pos < (size - 1)); ++idx)
+		{
+			p_line[pos++] = p_text[idx];
+
+			if (('%' == p_text[idx]) && ('%' == p_text[idx + 1]))
+			{
+				idx++;
+			}
+		}
+
+		for (uint8_t star = 0; star < conv.stars; ++star)
+		{
+			if ((p_arg + 1 + sizeof(int32_t)) > p_end)
+			{
+				break;
+			}
+
+			memcpy(&stars[star], p_arg + 1, sizeof(int32_t));
+			p_arg += 1 + sizeof(int32_t);
+		}
+
+		if ((p_arg >= p_end) || (conv.len >= sizeof(spec)))
+		{
+			p_text = conv.p_start;
+			break;
+		}
+
+		memcpy(spec, conv.p_start, conv.len);
+		spec[conv.len] = '\0';
+
+		switch (*p_arg)
+		{
+			case LOG_DEFER_ARG_LLONG:
+			case LOG_DEFER_ARG_DOUBLE:
+			{
+				uint64_t value = 0;
+
+				memcpy(&value, p_arg + 1, sizeof(value));
+				p_arg += 1 + sizeof(value);
+
+				if (LOG_DEFER_ARG_DOUBLE == conv.kind)
+				{
+					double real = 0;
+
+					memcpy(&real, &value, sizeof(real));
+					written = LOG_DEFER_SNPRINTF(real);
+				}
+				else
+				{
+					written = LOG_DEFER_SNPRINTF((long long) value);
+				}
+			}
+			break;
+
+			case LOG_DEFER_ARG_STR_COPY:
+			{
+				char str[UINT8_MAX + 1];
+				uint8_t len = p_arg[1];
+
+				memcpy(str, p_arg + 2, len);
+				str[len] = '\0';
+				p_arg += 2 + len;
+				written = LOG_DEFER_SNPRINTF(str);
+			}
+			break;
+
+			case LOG_DEFER_ARG_STR_REF:
+			case LOG_DEFER_ARG_PTR:
+			{
+				void * p_value = NULL;
+
+				memcpy(&p_value, p_arg + 1, sizeof(p_value));
+				p_arg += 1 + sizeof(p_value);
+				written = LOG_DEFER_SNPRINTF(p_value);
+			}
+			break;
+
+			case LOG_DEFER_ARG_LONG:
+			{
+				int32_t value = 0;
+
+				memcpy(&value, p_arg + 1, sizeof(value));
+				p_arg += 1 + sizeof(value);
+				written = LOG_DEFER_SNPRINTF((long) value);
+			}
+			break;
+
+			default:
+			{
+				int32_t value = 0;
+
+				memcpy(&value, p_arg + 1, sizeof(value));
+				p_arg += 1 + sizeof(value);
+				written = LOG_DEFER_SNPRINTF((int) value);
+			}
+			break;
+		}
+
+		if (written > 0)
+		{
+			pos += written;
+		}
+
+		if (pos >= size)
+		{
+			pos = size - 1;
+		}
+
+		p_text = p_next;
+	}
+
+	// Text after the last conversion, or after the last stored argument
+	//
+	if (NULL == p_next)
+	{
+		for (const char * p_char = p_text; ('\0' != *p_char) && (pos < (size - 1)); ++p_char)
+		{
+			p_line[pos++] = *p_char;
+
+			if (('%' == p_char[0]) && ('%' == p_char[1]))
+			{
+				p_char++;
+			}
+		}
+	}
+
+	// Marks lines cut by the payload or the line size
+	//
+	if ((true == p_slot->b_truncated) || (NULL != p_next))
+	{
+		if ((pos > 0) && ('\n' == p_line[pos - 1]))
+		{
+			pos--;
+		}
+
+		if (pos > (size - 5))
+		{
+			pos = size - 5;
+		}
+
+		memcpy(&p_line[pos], "...\n", 4);
+		pos += 4;
+	}
+
+	p_line[pos] = '\0';
+}
+
+#else
+
+void
+log_defer_start (void)
+{
+}
+
+void
+log_defer_get_stats (log_defer_stats_t * p_stats)
+{
+	memset(p_stats, 0, sizeof(log_defer_stats_t));
+}
+
+bool
+log_defer_get_tag_stats (uint32_t index, const char ** pp_tag,
+						 uint32_t * p_suppressed)
+{
+	return false;
+}
+
+#endif
+
+esp_err_t
+log_defer_set_level (const char * p_tag, const char * p_level)
+{
+	for (uint32_t level = ESP_LOG_NONE; level <= ESP_LOG_VERBOSE; ++level)
+	{
+		if (0 == strcmp(g_level_names[level], p_level))
+		{
+			esp_log_level_set(p_tag, (esp_log_level_t) level);
+
+			return ESP_OK;
+		}
+	}
+
+	return ESP_ERR_INVALID_ARG;
+}
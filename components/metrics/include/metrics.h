@@ -0,0 +1,39 @@
+/*
+ * metrics.h
+ *
+ *  Created on: 19 oct 2026
+ *      Author: Filippo
+ */
+
+#ifndef COMPONENTS_METRICS_H_
+#	define COMPONENTS_METRICS_H_
+
+#	include <stddef.h>
+#	include "esp_err.h"
+#	include "freertos/FreeRTOS.h"
+#	include "freertos/queue.h"
+
+// Receives the formatted text, piece by piece
+//
+typedef esp_err_t (*metrics_write_cb_t)(const char * p_text, void * p_arg);
+
+// Starts the periodic sampler, can be called more than once
+//
+void metrics_start(void);
+
+// Adds a queue to the depth report, the name must stay valid.
+// Registering a name again replaces its queue
+//
+esp_err_t metrics_register_queue(const char * p_name, QueueHandle_t h_queue);
+
+// Writes every metric in the Prometheus text format. Readers share one
+// static copy of the snapshot, a second one waits for the first.
+//
+esp_err_t metrics_write_prometheus(metrics_write_cb_t cb, void * p_arg);
+
+// Formats a short JSON summary (heap and lowest stack margins),
+// returns the length written
+//
+size_t metrics_format_summary(char * p_buf, size_t size);
+
+#endif /* COMPONENTS_METRICS_H_ */
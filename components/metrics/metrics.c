@@ -0,0 +1,580 @@
+/*
+ * metrics.c
+ *
+ *  Created on: 19 oct 2026
+ *      Author: Filippo
+ */
+
+#include "metrics.h"
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "sdkconfig.h"
+#include "app_static.h"
+
+// Longest Prometheus text written at once
+//
+#define METRICS_LINE_SIZE			160
+
+static const char g_tag[] = "metrics";
+
+typedef struct metrics_heap_caps
+{
+	const char * p_name;
+	uint32_t caps;
+} metrics_heap_caps_t;
+
+static const metrics_heap_caps_t g_heap_caps[] = {
+	{ "internal", MALLOC_CAP_INTERNAL },
+	{ "dma", MALLOC_CAP_DMA },
+#if CONFIG_SPIRAM
+	{ "spiram", MALLOC_CAP_SPIRAM },
+#endif
+};
+
+#define METRICS_HEAP_CAPS_COUNT		(sizeof(g_heap_caps) / sizeof(g_heap_caps[0]))
+
+typedef struct metrics_task
+{
+	char name[configMAX_TASK_NAME_LEN];
+	UBaseType_t number;
+	uint32_t runtime;
+	uint32_t cpu_permille;		// Of one core, over the last period
+	uint32_t stack_free;		// High water mark in bytes
+	uint8_t priority;
+	int8_t core_id;				// -1 when not pinned or unknown
+} metrics_task_t;
+
+typedef struct metrics_heap
+{
+	size_t total;
+	size_t free;
+	size_t min_free;
+	size_t largest_block;
+	size_t min_largest_block;	// Smallest largest block seen, fragmentation
+} metrics_heap_t;
+
+typedef struct metrics_queue
+{
+	const char * p_name;
+	QueueHandle_t h_queue;
+	UBaseType_t waiting;
+	UBaseType_t max_waiting;	// Highest depth seen at sample time
+	UBaseType_t capacity;
+} metrics_queue_t;
+
+typedef struct metrics_snapshot
+{
+	int64_t timestamp_us;
+	uint32_t sample_count;
+	uint8_t task_count;
+	uint8_t queue_count;
+	metrics_task_t tasks[CONFIG_METRICS_MAX_TASKS];
+	metrics_heap_t heap[METRICS_HEAP_CAPS_COUNT];
+	metrics_queue_t queues[CONFIG_METRICS_MAX_QUEUES];
+} metrics_snapshot_t;
+
+// Metric names of the heap and queue fields, one family each
+//
+typedef struct metrics_field
+{
+	const char * p_name;
+	size_t offset;
+} metrics_field_t;
+
+static const metrics_field_t g_heap_fields[] = {
+	{ "esp_heap_total_bytes", offsetof(metrics_heap_t, total) },
+	{ "esp_heap_free_bytes", offsetof(metrics_heap_t, free) },
+	{ "esp_heap_min_free_bytes", offsetof(metrics_heap_t, min_free) },
+	{ "esp_heap_largest_free_block_bytes", offsetof(metrics_heap_t, largest_block) },
+	{ "esp_heap_largest_free_block_min_bytes", offsetof(metrics_heap_t, min_largest_block) }
+};
+
+static const metrics_field_t g_queue_fields[] = {
+	{ "esp_queue_messages_waiting", offsetof(metrics_queue_t, waiting) },
+	{ "esp_queue_messages_waiting_max", offsetof(metrics_queue_t, max_waiting) },
+	{ "esp_queue_capacity", offsetof(metrics_queue_t, capacity) }
+};
+
+#define METRICS_HEAP_FIELD_COUNT	(sizeof(g_heap_fields) / sizeof(g_heap_fields[0]))
+#define METRICS_QUEUE_FIELD_COUNT	(sizeof(g_queue_fields) / sizeof(g_queue_fields[0]))
+
+// Published snapshot, copied out by the readers
+//
+static metrics_snapshot_t g_snapshot = {0};
+
+// Built by the sampler only
+//
+static metrics_snapshot_t g_work = {0};
+
+// Copy formatted by one reader at a time, under gh_read_mutex. Static,
+// so a scrape does not fragment the heap it reports.
+//
+static metrics_snapshot_t g_read = {0};
+static SemaphoreHandle_t gh_read_mutex = NULL;
+
+static metrics_queue_t g_queues[CONFIG_METRICS_MAX_QUEUES] = {0};
+static uint8_t g_queue_count = 0;
+
+static portMUX_TYPE g_metrics_mux = portMUX_INITIALIZER_UNLOCKED;
+
+static esp_timer_handle_t gh_metrics_timer = NULL;
+
+#if CONFIG_METRICS_TASK_STATS
+static TaskStatus_t g_task_status[CONFIG_METRICS_MAX_TASKS] = {0};
+static UBaseType_t g_prev_number[CONFIG_METRICS_MAX_TASKS] = {0};
+static uint32_t g_prev_runtime[CONFIG_METRICS_MAX_TASKS] = {0};
+static uint8_t g_prev_count = 0;
+static uint32_t g_prev_total_runtime = 0;
+static bool gb_task_overflow_logged = false;
+#endif
+
+static void metrics_timer_callback(void * p_arg);
+static void metrics_sample_tasks(metrics_snapshot_t * p_snap);
+static void metrics_sample_heap(metrics_snapshot_t * p_snap);
+static void metrics_sample_queues(metrics_snapshot_t * p_snap);
+static metrics_snapshot_t * metrics_copy_snapshot(void);
+static void metrics_release_snapshot(void);
+static esp_err_t metrics_emit(metrics_write_cb_t cb, void * p_arg,
+							  char * p_line, const char * p_fmt, ...);
+
+void
+metrics_start (void)
+{
+	if (NULL != gh_metrics_timer)
+	{
+		return;
+	}
+
+	const esp_timer_create_args_t timer_args = {
+		.callback = metrics_timer_callback,
+		.arg = NULL,
+		.dispatch_method = ESP_TIMER_TASK,
+		.name = "metrics"
+	};
+
+	gh_read_mutex = APP_MUTEX_CREATE();
+	ESP_ERROR_CHECK(esp_timer_create(&timer_args, &gh_metrics_timer));
+
+	// First sample now, so the CPU window of the next one is complete
+	//
+	metrics_timer_callback(NULL);
+	ESP_ERROR_CHECK(esp_timer_start_periodic(gh_metrics_timer,
+					(uint64_t) CONFIG_METRICS_SAMPLE_PERIOD_MS * 1000));
+
+	ESP_LOGI(g_tag, "metrics_start: sampling every %d ms",
+			 CONFIG_METRICS_SAMPLE_PERIOD_MS);
+}
+
+esp_err_t
+metrics_register_queue (const char * p_name, QueueHandle_t h_queue)
+{
+	esp_err_t err = ESP_OK;
+	uint8_t idx = 0;
+
+	if ((NULL == p_name) || (NULL == h_queue))
+	{
+		return ESP_ERR_INVALID_ARG;
+	}
+
+	portENTER_CRITICAL(&g_metrics_mux);
+
+	// A module that recreates its queue registers it again under the same name
+	//
+	while ((idx < g_queue_count) && (0 != strcmp(g_queues[idx].p_name, p_name)))
+	{
+		idx++;
+	}
+
+	if (idx < CONFIG_METRICS_MAX_QUEUES)
+	{
+		g_queues[idx].p_name = p_name;
+		g_queues[idx].h_queue = h_queue;
+		g_queues[idx].max_waiting = 0;
+
+		if (idx == g_queue_count)
+		{
+			g_queue_count++;
+		}
+	}
+	else
+	{
+		err = ESP_ERR_NO_MEM;
+	}
+
+	portEXIT_CRITICAL(&g_metrics_mux);
+
+	return err;
+}
+
+esp_err_t
+metrics_write_prometheus (metrics_write_cb_t cb, void * p_arg)
+{
+	esp_err_t err = ESP_OK;
+	char line[METRICS_LINE_SIZE] = {0};
+	metrics_snapshot_t * p_snap = metrics_copy_snapshot();
+
+	if (NULL == p_snap)
+	{
+		return ESP_ERR_INVALID_STATE;
+	}
+
+	err = metrics_emit(cb, p_arg, line,
+					   "# TYPE esp_uptime_seconds gauge\n"
+					   "esp_uptime_seconds %lld\n"
+					   "# TYPE esp_metrics_samples_total counter\n"
+					   "esp_metrics_samples_total %u\n",
+					   esp_timer_get_time() / 1000000, p_snap->sample_count);
+
+#if CONFIG_METRICS_TASK_STATS
+	if (ESP_OK == err)
+	{
+		err = metrics_emit(cb, p_arg, line,
+						   "# HELP esp_task_cpu_ratio Share of one core "
+						   "over the last sample period\n"
+						   "# TYPE esp_task_cpu_ratio gauge\n");
+	}
+
+	for (uint8_t idx = 0; (idx < p_snap->task_count) && (ESP_OK == err); ++idx)
+	{
+		metrics_task_t * p_task = &p_snap->tasks[idx];
+
+		err = metrics_emit(cb, p_arg, line,
+						   "esp_task_cpu_ratio{task=\"%s\",core=\"%d\"} %u.%03u\n",
+						   p_task->name, p_task->core_id,
+						   p_task->cpu_permille / 1000,
+						   p_task->cpu_permille % 1000);
+	}
+
+	// Task names are not unique (both idle tasks are "IDLE"), the core
+	// label keeps every series apart
+	//
+	if (ESP_OK == err)
+	{
+		err = metrics_emit(cb, p_arg, line,
+						   "# HELP esp_task_stack_free_min_bytes Stack "
+						   "high water mark\n"
+						   "# TYPE esp_task_stack_free_min_bytes gauge\n");
+	}
+
+	for (uint8_t idx = 0; (idx < p_snap->task_count) && (ESP_OK == err); ++idx)
+	{
+		err = metrics_emit(cb, p_arg, line,
+						   "esp_task_stack_free_min_bytes{task=\"%s\",core=\"%d\"} %u\n",
+						   p_snap->tasks[idx].name,
+						   p_snap->tasks[idx].core_id,
+						   p_snap->tasks[idx].stack_free);
+	}
+
+	if (ESP_OK == err)
+	{
+		err = metrics_emit(cb, p_arg, line,
+						   "# TYPE esp_task_priority gauge\n");
+	}
+
+	for (uint8_t idx = 0; (idx < p_snap->task_count) && (ESP_OK == err); ++idx)
+	{
+		err = metrics_emit(cb, p_arg, line,
+						   "esp_task_priority{task=\"%s\",core=\"%d\"} %u\n",
+						   p_snap->tasks[idx].name,
+						   p_snap->tasks[idx].core_id,
+						   p_snap->tasks[idx].priority);
+	}
+#endif
+
+	for (uint8_t field = 0; (field < METRICS_HEAP_FIELD_COUNT) && (ESP_OK == err); ++field)
+	{
+		const char * p_metric = g_heap_fields[field].p_name;
+
+		err = metrics_emit(cb, p_arg, line, "# TYPE %s gauge\n", p_metric);
+
+		for (uint8_t idx = 0; (idx < METRICS_HEAP_CAPS_COUNT) && (ESP_OK == err); ++idx)
+		{
+			const uint8_t * p_heap = (const uint8_t *) &p_snap->heap[idx];
+
+			err = metrics_emit(cb, p_arg, line, "%s{caps=\"%s\"} %u\n",
+							   p_metric, g_heap_caps[idx].p_name,
+							   *(const size_t *) (p_heap + g_heap_fields[field].offset));
+		}
+	}
+
+	for (uint8_t field = 0; (field < METRICS_QUEUE_FIELD_COUNT) && (ESP_OK == err)
+		 && (p_snap->queue_count > 0); ++field)
+	{
+		const char * p_metric = g_queue_fields[field].p_name;
+
+		err = metrics_emit(cb, p_arg, line, "# TYPE %s gauge\n", p_metric);
+
+		for (uint8_t idx = 0; (idx < p_snap->queue_count) && (ESP_OK == err); ++idx)
+		{
+			const uint8_t * p_queue = (const uint8_t *) &p_snap->queues[idx];
+
+			err = metrics_emit(cb, p_arg, line, "%s{queue=\"%s\"} %u\n",
+							   p_metric, p_snap->queues[idx].p_name,
+							   *(const UBaseType_t *) (p_queue + g_queue_fields[field].offset));
+		}
+	}
+
+	metrics_release_snapshot();
+
+	return err;
+}
+
+size_t
+metrics_format_summary (char * p_buf, size_t size)
+{
+	int32_t len = 0;
+	metrics_snapshot_t * p_snap = NULL;
+
+	if ((NULL == p_buf) || (0 == size))
+	{
+		return 0;
+	}
+
+	p_buf[0] = '\0';
+	p_snap = metrics_copy_snapshot();
+
+	if (NULL == p_snap)
+	{
+		return 0;
+	}
+
+	len = snprintf(p_buf, size,
+				   "{\"uptime_s\":%lld,\"heap_free\":%u,\"heap_min_free\":%u,"
+				   "\"heap_largest\":%u,\"heap_largest_min\":%u,\"stack_free\":{",
+				   esp_timer_get_time() / 1000000,
+				   p_snap->heap[0].free, p_snap->heap[0].min_free,
+				   p_snap->heap[0].largest_block, p_snap->heap[0].min_largest_block);
+
+	// Stack margins while they fit, the JSON is closed in any case
+	//
+	for (uint8_t idx = 0; idx < p_snap->task_count; ++idx)
+	{
+		int32_t needed = 0;
+
+		if ((len < 0) || ((size_t) len >= size))
+		{
+			break;
+		}
+
+		needed = snprintf(p_buf + len, size - len, "%s\"%s\":%u",
+						  (0 == idx) ? "" : ",", p_snap->tasks[idx].name,
+						  p_snap->tasks[idx].stack_free);
+
+		if ((needed < 0) || ((size_t) (len + needed + 3) > size))
+		{
+			p_buf[len] = '\0';
+			break;
+		}
+
+		len += needed;
+	}
+
+	if ((len >= 0) && ((size_t) (len + 3) <= size))
+	{
+		len += snprintf(p_buf + len, size - len, "}}");
+	}
+	else
+	{
+		len = 0;
+		p_buf[0] = '\0';
+	}
+
+	metrics_release_snapshot();
+
+	return (size_t) len;
+}
+
+static void
+metrics_timer_callback (void * p_arg)
+{
+	metrics_sample_tasks(&g_work);
+	metrics_sample_heap(&g_work);
+	metrics_sample_queues(&g_work);
+	g_work.timestamp_us = esp_timer_get_time();
+	g_work.sample_count++;
+
+	portENTER_CRITICAL(&g_metrics_mux);
+	memcpy(&g_snapshot, &g_work, sizeof(g_snapshot));
+	portEXIT_CRITICAL(&g_metrics_mux);
+}
+
+static void
+metrics_sample_tasks (metrics_snapshot_t * p_snap)
+{
+#if CONFIG_METRICS_TASK_STATS
+	uint32_t total_runtime = 0;
+	uint32_t total_delta = 0;
+	UBaseType_t count = uxTaskGetSystemState(g_task_status,
+											 CONFIG_METRICS_MAX_TASKS,
+											 &total_runtime);
+
+	if (0 == count)
+	{
+		// The array must hold every task, or nothing is returned
+		//
+		if (false == gb_task_overflow_logged)
+		{
+			ESP_LOGW(g_tag, "metrics_sample_tasks: more than %d tasks",
+					 CONFIG_METRICS_MAX_TASKS);
+			gb_task_overflow_logged = true;
+		}
+
+		p_snap->task_count = 0;
+
+		return;
+	}
+
+	total_delta = total_runtime - g_prev_total_runtime;
+	g_prev_total_runtime = total_runtime;
+
+	for (UBaseType_t idx = 0; idx < count; ++idx)
+	{
+		TaskStatus_t * p_status = &g_task_status[idx];
+		metrics_task_t * p_task = &p_snap->tasks[idx];
+		uint32_t prev_runtime = p_status->ulRunTimeCounter;
+
+		// Counter of the same task in the previous sample; a new task
+		// starts with an empty window
+		//
+		for (uint8_t prev = 0; prev < g_prev_count; ++prev)
+		{
+			if (g_prev_number[prev] == p_status->xTaskNumber)
+			{
+				prev_runtime = g_prev_runtime[prev];
+				break;
+			}
+		}
+
+		strlcpy(p_task->name, p_status->pcTaskName, sizeof(p_task->name));
+		p_task->number = p_status->xTaskNumber;
+		p_task->runtime = p_status->ulRunTimeCounter;
+		p_task->stack_free = p_status->usStackHighWaterMark;
+		p_task->priority = (uint8_t) p_status->uxCurrentPriority;
+#if configTASKLIST_INCLUDE_COREID
+		p_task->core_id = (tskNO_AFFINITY == p_status->xCoreID) ?
+						  -1 : (int8_t) p_status->xCoreID;
+#else
+		p_task->core_id = -1;
+#endif
+		p_task->cpu_permille = 0;
+
+		if (total_delta > 0)
+		{
+			p_task->cpu_permille = (uint32_t)
+				(((uint64_t) (p_task->runtime - prev_runtime) * 1000) / total_delta);
+		}
+	}
+
+	for (UBaseType_t idx = 0; idx < count; ++idx)
+	{
+		g_prev_number[idx] = p_snap->tasks[idx].number;
+		g_prev_runtime[idx] = p_snap->tasks[idx].runtime;
+	}
+
+	g_prev_count = (uint8_t) count;
+	p_snap->task_count = (uint8_t) count;
+#else
+	p_snap->task_count = 0;
+#endif
+}
+
+static void
+metrics_sample_heap (metrics_snapshot_t * p_snap)
+{
+	for (uint8_t idx = 0; idx < METRICS_HEAP_CAPS_COUNT; ++idx)
+	{
+		multi_heap_info_t info = {0};
+
+		heap_caps_get_info(&info, g_heap_caps[idx].caps);
+		p_snap->heap[idx].total = heap_caps_get_total_size(g_heap_caps[idx].caps);
+		p_snap->heap[idx].free = info.total_free_bytes;
+		p_snap->heap[idx].min_free = info.minimum_free_bytes;
+		p_snap->heap[idx].largest_block = info.largest_free_block;
+
+		// g_work keeps its values between samples
+		//
+		if ((0 == p_snap->heap[idx].min_largest_block) ||
+			(info.largest_free_block < p_snap->heap[idx].min_largest_block))
+		{
+			p_snap->heap[idx].min_largest_block = info.largest_free_block;
+		}
+	}
+}
+
+static void
+metrics_sample_queues (metrics_snapshot_t * p_snap)
+{
+	portENTER_CRITICAL(&g_metrics_mux);
+
+	for (uint8_t idx = 0; idx < g_queue_count; ++idx)
+	{
+		metrics_queue_t * p_queue = &g_queues[idx];
+
+		p_queue->waiting = uxQueueMessagesWaitingFromISR(p_queue->h_queue);
+		p_queue->capacity = p_queue->waiting +
+							uxQueueSpacesAvailable(p_queue->h_queue);
+
+		if (p_queue->waiting > p_queue->max_waiting)
+		{
+			p_queue->max_waiting = p_queue->waiting;
+		}
+	}
+
+	memcpy(p_snap->queues, g_queues, g_queue_count * sizeof(metrics_queue_t));
+	p_snap->queue_count = g_queue_count;
+
+	portEXIT_CRITICAL(&g_metrics_mux);
+}
+
+// Takes gh_read_mutex until metrics_release_snapshot(), NULL before
+// metrics_start()
+//
+static metrics_snapshot_t *
+metrics_copy_snapshot (void)
+{
+	if (NULL == gh_read_mutex)
+	{
+		return NULL;
+	}
+
+	xSemaphoreTake(gh_read_mutex, portMAX_DELAY);
+
+	portENTER_CRITICAL(&g_metrics_mux);
+	memcpy(&g_read, &g_snapshot, sizeof(metrics_snapshot_t));
+	portEXIT_CRITICAL(&g_metrics_mux);
+
+	return &g_read;
+}
+
+static void
+metrics_release_snapshot (void)
+{
+	xSemaphoreGive(gh_read_mutex);
+}
+
+static esp_err_t
+metrics_emit (metrics_write_cb_t cb, void * p_arg, char * p_line,
+			  const char * p_fmt, ...)
+{
+	va_list args;
+	int32_t len = 0;
+
+	va_start(args, p_fmt);
+	len = vsnprintf(p_line, METRICS_LINE_SIZE, p_fmt, args);
+	va_end(args);
+
+	if (len < 0)
+	{
+		return ESP_FAIL;
+	}
+
+	return cb(p_line, p_arg);
+}
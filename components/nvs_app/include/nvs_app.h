@@ -5,8 +5,8 @@
  *      Author: Filippo
  */
 
-#ifndef MAIN_NVS_APP_H_
-#	define MAIN_NVS_APP_H_
+#ifndef COMPONENTS_NVS_APP_H_
+#	define COMPONENTS_NVS_APP_H_
 
 #	include "esp_err.h"
 #	include <stdbool.h>
@@ -15,4 +15,4 @@ esp_err_t app_nvs_save_sta_creds(void);
 bool app_nvs_load_sta_creds(void);
 esp_err_t app_nvs_clear_sta_creds(void);
 
-#endif /* MAIN_NVS_APP_H_ */
+#endif /* COMPONENTS_NVS_APP_H_ */
@@ -96,53 +96,44 @@ app_nvs_load_sta_creds (void)
 	else
 	{
 		wifi_config_t * p_wifi_sta_config = wifi_app_get_wifi_config();
+		size_t wifi_config_size = 0;
 
 		if (NULL == p_wifi_sta_config)
 		{
-			p_wifi_sta_config = (wifi_config_t *) malloc(sizeof(wifi_config_t));
+			nvs_close(h_nvs);
+			return false;
 		}
 
 		memset(p_wifi_sta_config, 0, sizeof(wifi_config_t));
 
-		uint32_t wifi_config_size = sizeof(wifi_config_t);
-		uint8_t * p_wifi_config_buff = (uint8_t *) malloc(sizeof(uint8_t) * wifi_config_size);
-		memset(p_wifi_config_buff, 0, sizeof(wifi_config_t));
-
-		// SSID
+		// SSID, read in place
 		//
 		wifi_config_size = sizeof(p_wifi_sta_config->sta.ssid);
-		err = nvs_get_blob(h_nvs, "ssid", p_wifi_config_buff, &wifi_config_size);
+		err = nvs_get_blob(h_nvs, "ssid", p_wifi_sta_config->sta.ssid,
+						   &wifi_config_size);
 
 		if (ESP_OK != err)
 		{
-			free(p_wifi_config_buff);
-			p_wifi_config_buff = NULL;
+			nvs_close(h_nvs);
 			printf("app_nvs_load_sta_creds: (%s) no stations SSID found in NVS\n",
 				   esp_err_to_name(err));
 			return false;
 		}
 
-		memcpy(p_wifi_sta_config->sta.ssid, p_wifi_config_buff, wifi_config_size);
-
 		// Password
 		//
 		wifi_config_size = sizeof(p_wifi_sta_config->sta.password);
-		err = nvs_get_blob(h_nvs, "password", p_wifi_config_buff, &wifi_config_size);
+		err = nvs_get_blob(h_nvs, "password", p_wifi_sta_config->sta.password,
+						   &wifi_config_size);
 
 		if (ESP_OK != err)
 		{
-			free(p_wifi_config_buff);
-			p_wifi_config_buff = NULL;
+			nvs_close(h_nvs);
 			printf("app_nvs_load_sta_creds: (%s) retrieving password\n",
 				   esp_err_to_name(err));
 			return false;
 		}
 
-		memcpy(p_wifi_sta_config->sta.password, p_wifi_config_buff, wifi_config_size);
-
-		free(p_wifi_config_buff);
-		p_wifi_config_buff = NULL;
-
 		nvs_close(h_nvs);
 
 		ESP_LOGI(g_tag, "app_nvs_load_sta_creds: SSID: %s, password: %s",
@@ -0,0 +1,129 @@
+/*
+ * ota_app.h
+ *
+ *  Created on: 19 oct 2026
+ *      Author: Filippo
+ */
+
+#ifndef COMPONENTS_OTA_APP_H_
+#	define COMPONENTS_OTA_APP_H_
+
+#	include <stdbool.h>
+#	include <stddef.h>
+#	include <stdint.h>
+#	include "esp_err.h"
+
+// Header of the images made by tools/ota_pack.py, little endian. The
+// zlib stream after it inflates to the image itself (compressed) or to
+// delta records (delta). Each delta record is
+//
+//   uint32 diff_len, uint32 extra_len, int32 seek
+//   diff_len bytes added to the running image from the current position
+//   extra_len bytes copied as they are
+//
+// and then moves the position in the running image by seek.
+//
+// A header_len past the structure means a signature follows it: uint16
+// length, then the DER signature of the SHA-256 of the structure. The
+// structure holds target_sha256, which the written image must match, so
+// the signature covers the whole image. A plain image can be signed too,
+// stored after the header as it is (OTA_APP_FORMAT_IMAGE).
+//
+#	define OTA_APP_PATCH_MAGIC			"OTAP"
+#	define OTA_APP_PATCH_VERSION		1
+#	define OTA_APP_SIGNATURE_MAX		512
+
+typedef enum ota_app_format
+{
+	OTA_APP_FORMAT_UNKNOWN = 0,
+	OTA_APP_FORMAT_IMAGE,			// Plain application image
+	OTA_APP_FORMAT_COMPRESSED,
+	OTA_APP_FORMAT_DELTA
+} ota_app_format_t;
+
+typedef struct __attribute__((packed)) ota_app_patch_header
+{
+	char magic[4];
+	uint8_t version;
+	uint8_t format;					// ota_app_format_t
+	uint16_t header_len;
+	uint32_t target_size;			// Image bytes written to the partition
+	uint32_t base_size;				// Delta: running image size
+	uint8_t base_sha256[32];		// Delta: running image hash
+	uint8_t target_sha256[32];		// Same as esp_partition_get_sha256()
+} ota_app_patch_header_t;
+
+// Outcome of the last update
+//
+typedef struct ota_app_result
+{
+	ota_app_format_t format;
+	uint32_t received;				// Bytes given to ota_app_write()
+	uint32_t written;				// Image bytes written to flash
+	uint32_t elapsed_ms;			// From ota_app_begin() to ota_app_end()
+	uint32_t verify_us;				// Hashing and signature, part of elapsed_ms
+	uint32_t stack_free;			// Writer task stack high water mark, bytes
+	bool b_signed;
+	esp_err_t err;
+} ota_app_result_t;
+
+typedef enum ota_app_phase
+{
+	OTA_APP_PHASE_IDLE = 0,
+	OTA_APP_PHASE_ERASING,			// esp_ota_begin() erasing the partition
+	OTA_APP_PHASE_RECEIVING,
+	OTA_APP_PHASE_VERIFYING,
+	OTA_APP_PHASE_DONE,
+	OTA_APP_PHASE_FAILED
+} ota_app_phase_t;
+
+// Live state of the update, readable from any task while it runs
+//
+typedef struct ota_app_progress
+{
+	ota_app_phase_t phase;
+	ota_app_format_t format;
+	uint32_t total;					// Bytes to receive, 0 when unknown
+	uint32_t received;
+	uint32_t written;				// Image bytes given to esp_ota_write()
+	uint32_t rate;					// Received bytes/s over the last second
+	uint32_t erase_ms;
+	uint32_t flash_ms;				// Spent in esp_ota_write()
+	uint32_t elapsed_ms;
+	int32_t eta_s;					// -1 when unknown
+} ota_app_progress_t;
+
+// Starts an update into the next OTA partition, one at a time
+//
+esp_err_t ota_app_begin(void);
+
+// Feeds the received bytes, the format is found from the first ones
+//
+esp_err_t ota_app_write(const void * p_data, size_t len);
+
+// Bytes the caller expects to write, for the progress ETA
+//
+void ota_app_set_total(uint32_t total);
+
+// Hash the image must have, e.g. from the pull manifest, checked at the
+// end with the hash computed while writing
+//
+esp_err_t ota_app_set_expected_sha256(const uint8_t * p_sha256);
+
+// Completes the image, checks its hash and makes it the boot partition
+//
+esp_err_t ota_app_end(void);
+
+// Drops the update in progress
+//
+void ota_app_abort(void);
+
+void ota_app_get_result(ota_app_result_t * p_result);
+
+void ota_app_get_progress(ota_app_progress_t * p_progress);
+
+// JSON object with the progress, returns the length
+//
+size_t ota_app_format_progress_json(char * p_buf, size_t size);
+
+#endif /* COMPONENTS_OTA_APP_H_ */
@@ -0,0 +1,30 @@
+/*
+ * ota_app_firmware.h
+ *
+ *  Created on: 19 oct 2026
+ *      Author: Filippo
+ */
+
+#ifndef COMPONENTS_OTA_APP_FIRMWARE_H_
+#	define COMPONENTS_OTA_APP_FIRMWARE_H_
+
+#	include <stddef.h>
+
+// Builds the firmware inventory once: app partitions, their descriptors
+// and OTA states, the running image SHA-256 (what a delta base is matched
+// against) and the rollback status. Reads flash, called at startup.
+//
+void ota_app_firmware_init(void);
+
+// Reads the descriptors and states again, after an update or a
+// validation. The running image hash is kept. Any task may call it, a
+// refresh and the readers take turns on one mutex.
+//
+void ota_app_firmware_refresh(void);
+
+// Copies the cached JSON, no flash access. Returns the length, 0 when it
+// does not fit.
+//
+size_t ota_app_firmware_format_json(char * p_buf, size_t size);
+
+#endif /* COMPONENTS_OTA_APP_FIRMWARE_H_ */
@@ -0,0 +1,36 @@
+/*
+ * ota_app_health.h
+ *
+ *  Created on: 19 oct 2026
+ *      Author: Filippo
+ */
+
+#ifndef COMPONENTS_OTA_APP_HEALTH_H_
+#	define COMPONENTS_OTA_APP_HEALTH_H_
+
+#	include <stdbool.h>
+#	include <stdint.h>
+
+// Checks a freshly updated image passes before it is marked valid
+//
+#	define OTA_APP_HEALTH_WIFI			(1u << 0)	// Station got an IP
+#	define OTA_APP_HEALTH_MQTT			(1u << 1)	// Broker session established
+#	define OTA_APP_HEALTH_SENSOR			(1u << 2)	// A sample was read
+#	define OTA_APP_HEALTH_HTTP			(1u << 3)	// Web server up, reported by http_server
+
+// Called early at boot. When the running image waits for its first
+// validation (app rollback enabled), it is marked valid once every check
+// of required_mask is reported, and rolled back if that does not happen
+// within CONFIG_OTA_APP_HEALTH_TIMEOUT_S. Otherwise nothing happens.
+//
+void ota_app_health_start(uint32_t required_mask);
+
+// Reports a passed check, from any task
+//
+void ota_app_health_report(uint32_t check);
+
+// True while the running image is still on probation
+//
+bool ota_app_health_pending(void);
+
+#endif /* COMPONENTS_OTA_APP_HEALTH_H_ */
@@ -0,0 +1,43 @@
+/*
+ * ota_app_pull.h
+ *
+ *  Created on: 19 oct 2026
+ *      Author: Filippo
+ */
+
+#ifndef COMPONENTS_OTA_APP_PULL_H_
+#	define COMPONENTS_OTA_APP_PULL_H_
+
+#	include <stdint.h>
+#	include "esp_err.h"
+
+// The manifest at CONFIG_OTA_APP_PULL_MANIFEST_URL is a JSON object:
+//
+//   {
+//     "version": "1.4.0",
+//     "url": "http://server/app.bin",
+//     "sha256": "<image SHA-256, hex>",
+//     "delta": { "base": "<running image SHA-256, hex>", "url": "..." }
+//   }
+//
+// "sha256" and "delta" are optional. The image (or the delta, when the
+// device runs its base) is downloaded in Range requests and given to
+// ota_app_write(), so plain, compressed and delta images are all accepted.
+// The written image must then match "sha256", as esp_partition_get_sha256()
+// gives it.
+//
+
+// Starts the client task once, it checks the manifest at boot and then
+// every CONFIG_OTA_APP_PULL_INTERVAL_S (CONFIG_OTA_APP_PULL)
+//
+void ota_app_pull_start(void);
+
+// Checks the manifest now instead of at the next interval
+//
+void ota_app_pull_check(void);
+
+// Compares dotted version strings: < 0, 0 or > 0 like strcmp()
+//
+int ota_app_pull_version_cmp(const char * p_left, const char * p_right);
+
+#endif /* COMPONENTS_OTA_APP_PULL_H_ */
@@ -0,0 +1,980 @@
+/*
+ * ota_app.c
+ *
+ *  Created on: 19 oct 2026
+ *      Author: Filippo
+ */
+
+#include "ota_app.h"
+#include "ota_app_firmware.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_ota_ops.h"
+#include "esp_partition.h"
+#include "esp_image_format.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+#include "mbedtls/md.h"
+#include "rgb_led.h"
+#include "sys/param.h"
+#include "sdkconfig.h"
+
+#if CONFIG_OTA_APP_PATCH
+#	include "esp32/rom/miniz.h"
+#endif
+#if CONFIG_OTA_APP_SIGNED
+#	include "mbedtls/pk.h"
+#endif
+
+// Image bytes go to esp_ota_write() a flash sector at a time
+//
+#define OTA_APP_PAGE_SIZE			4096
+
+// Running image bytes read at a time by the delta
+//
+#define OTA_APP_BASE_CHUNK			256
+
+#define OTA_APP_RECORD_SIZE			12
+
+#define OTA_APP_SHA256_SIZE			32
+
+// hash_appended of esp_image_header_t
+//
+#define OTA_APP_HASH_APPENDED_OFS	23
+
+// Window of the receive rate
+//
+#define OTA_APP_RATE_WINDOW_US		1000000
+
+typedef enum ota_app_state
+{
+	OTA_APP_STATE_DETECT = 0,
+	OTA_APP_STATE_IMAGE,
+	OTA_APP_STATE_HEADER,
+	OTA_APP_STATE_INFLATE,
+	OTA_APP_STATE_DONE				// Stream complete, the rest is ignored
+} ota_app_state_t;
+
+typedef struct ota_app_session
+{
+	bool b_active;
+	ota_app_state_t state;
+	esp_ota_handle_t h_ota;
+	const esp_partition_t * p_update;
+	const esp_partition_t * p_running;
+	int64_t start_us;
+	ota_app_patch_header_t header;
+	uint32_t header_len;			// Bytes of header received, 0 for a plain image
+	uint8_t * p_extension;			// Header bytes after the structure
+	mbedtls_md_context_t sha;
+	uint8_t tail[OTA_APP_SHA256_SIZE];
+	uint32_t tail_len;
+	uint32_t image_ofs;
+	bool b_hash_appended;
+	bool b_expected;
+	uint8_t expected_sha256[OTA_APP_SHA256_SIZE];
+	int64_t verify_us;
+	int64_t flash_us;
+	int64_t rate_start_us;
+	uint32_t rate_start_bytes;
+	uint8_t * p_page;
+	uint32_t page_len;
+#if CONFIG_OTA_APP_PATCH
+	tinfl_decompressor * p_inflator;
+	uint8_t * p_dict;				// TINFL_LZ_DICT_SIZE, wraps around
+	uint32_t dict_ofs;
+	uint8_t record[OTA_APP_RECORD_SIZE];
+	uint32_t record_len;
+	bool b_in_record;
+	uint32_t diff_left;
+	uint32_t extra_left;
+	int32_t seek;
+	uint32_t base_pos;
+#endif
+	ota_app_result_t result;
+} ota_app_session_t;
+
+static const char g_tag[] = "ota_app";
+
+static ota_app_session_t g_session = {0};
+
+// Copied out under the lock, the session itself belongs to the writer
+//
+static portMUX_TYPE g_progress_mux = portMUX_INITIALIZER_UNLOCKED;
+static ota_app_progress_t g_progress = {0};
+
+static esp_err_t ota_app_image(const uint8_t * p_data, size_t len);
+static esp_err_t ota_app_emit(const uint8_t * p_data, size_t len);
+static esp_err_t ota_app_flush(void);
+static void ota_app_hash(const uint8_t * p_data, size_t len);
+static esp_err_t ota_app_verify(void);
+static void ota_app_release(void);
+static void ota_app_progress(ota_app_phase_t phase);
+#if CONFIG_OTA_APP_PATCH
+static esp_err_t ota_app_header(const uint8_t * p_data, size_t len, size_t * p_used);
+static esp_err_t ota_app_header_done(void);
+static esp_err_t ota_app_inflate(const uint8_t * p_data, size_t len);
+static esp_err_t ota_app_delta(const uint8_t * p_data, size_t len);
+#endif
+#if CONFIG_OTA_APP_SIGNED
+static esp_err_t ota_app_signature(void);
+#endif
+
+esp_err_t
+ota_app_begin (void)
+{
+	esp_err_t err = ESP_OK;
+
+	if (true == g_session.b_active)
+	{
+		return ESP_ERR_INVALID_STATE;
+	}
+
+	memset(&g_session, 0, sizeof(g_session));
+	g_session.p_update = esp_ota_get_next_update_partition(NULL);
+	g_session.p_running = esp_ota_get_running_partition();
+	g_session.p_page = malloc(OTA_APP_PAGE_SIZE);
+
+	if ((NULL == g_session.p_update) || (NULL == g_session.p_page))
+	{
+		free(g_session.p_page);
+		g_session.p_page = NULL;
+
+		return ESP_ERR_NO_MEM;
+	}
+
+	// Image bytes are hashed on their way to flash, no second pass
+	//
+	mbedtls_md_init(&g_session.sha);
+
+	if ((0 != mbedtls_md_setup(&g_session.sha,
+							   mbedtls_md_info_from_type(MBEDTLS_MD_SHA256), 0)) ||
+		(0 != mbedtls_md_starts(&g_session.sha)))
+	{
+		mbedtls_md_free(&g_session.sha);
+		free(g_session.p_page);
+		g_session.p_page = NULL;
+
+		return ESP_ERR_NO_MEM;
+	}
+
+	g_session.start_us = esp_timer_get_time();
+	rgb_led_status(RGB_LED_STATUS_OTA_STARTED);
+	taskENTER_CRITICAL(&g_progress_mux);
+	memset(&g_progress, 0, sizeof(g_progress));
+	g_progress.phase = OTA_APP_PHASE_ERASING;
+	g_progress.eta_s = -1;
+	taskEXIT_CRITICAL(&g_progress_mux);
+
+	// The whole partition is erased here
+	//
+	err = esp_ota_begin(g_session.p_update, OTA_SIZE_UNKNOWN, &g_session.h_ota);
+
+	taskENTER_CRITICAL(&g_progress_mux);
+	g_progress.erase_ms = (uint32_t) ((esp_timer_get_time() - g_session.start_us) / 1000);
+	taskEXIT_CRITICAL(&g_progress_mux);
+
+	if (ESP_OK != err)
+	{
+		ESP_LOGE(g_tag, "ota_app_begin: %s", esp_err_to_name(err));
+		ota_app_progress(OTA_APP_PHASE_FAILED);
+		mbedtls_md_free(&g_session.sha);
+		free(g_session.p_page);
+		g_session.p_page = NULL;
+
+		return err;
+	}
+
+	ESP_LOGI(g_tag, "ota_app_begin: writing to partition subtype %d at offset 0x%X",
+			 g_session.p_update->subtype, g_session.p_update->address);
+
+	g_session.rate_start_us = esp_timer_get_time();
+	g_session.b_active = true;
+	ota_app_progress(OTA_APP_PHASE_RECEIVING);
+
+	return ESP_OK;
+}
+
+esp_err_t
+ota_app_write (const void * p_data, size_t len)
+{
+	const uint8_t * p_bytes = (const uint8_t *) p_data;
+	esp_err_t err = ESP_OK;
+
+	if (false == g_session.b_active)
+	{
+		return ESP_ERR_INVALID_STATE;
+	}
+
+	if (ESP_OK != g_session.result.err)
+	{
+		return g_session.result.err;
+	}
+
+	g_session.result.received += len;
+
+	if ((OTA_APP_STATE_DETECT == g_session.state) && (len > 0))
+	{
+		if (ESP_IMAGE_HEADER_MAGIC == p_bytes[0])
+		{
+#if CONFIG_OTA_APP_SIGNED
+			ESP_LOGE(g_tag, "ota_app_write: unsigned image refused");
+			err = ESP_ERR_NOT_SUPPORTED;
+#else
+			g_session.state = OTA_APP_STATE_IMAGE;
+			g_session.result.format = OTA_APP_FORMAT_IMAGE;
+#endif
+		}
+#if CONFIG_OTA_APP_PATCH
+		else if (OTA_APP_PATCH_MAGIC[0] == p_bytes[0])
+		{
+			g_session.state = OTA_APP_STATE_HEADER;
+		}
+#endif
+		else
+		{
+			ESP_LOGE(g_tag, "ota_app_write: unknown image format 0x%02X", p_bytes[0]);
+			err = ESP_ERR_NOT_SUPPORTED;
+		}
+	}
+
+	switch (g_session.state)
+	{
+		case OTA_APP_STATE_IMAGE:
+			err = ota_app_image(p_bytes, len);
+		break;
+
+#if CONFIG_OTA_APP_PATCH
+		case OTA_APP_STATE_HEADER:
+		{
+			size_t used = 0;
+
+			err = ota_app_header(p_bytes, len, &used);
+
+			if ((ESP_OK == err) && (OTA_APP_STATE_INFLATE == g_session.state))
+			{
+				err = ota_app_inflate(p_bytes + used, len - used);
+			}
+			else if ((ESP_OK == err) && (OTA_APP_STATE_IMAGE == g_session.state))
+			{
+				err = ota_app_image(p_bytes + used, len - used);
+			}
+		}
+		break;
+
+		case OTA_APP_STATE_INFLATE:
+			err = ota_app_inflate(p_bytes, len);
+		break;
+#endif
+
+		default:
+		break;
+	}
+
+	if (ESP_OK != err)
+	{
+		g_session.result.err = err;
+	}
+
+	ota_app_progress(OTA_APP_PHASE_RECEIVING);
+
+	return err;
+}
+
+esp_err_t
+ota_app_end (void)
+{
+	esp_err_t err = g_session.result.err;
+
+	if (false == g_session.b_active)
+	{
+		return ESP_ERR_INVALID_STATE;
+	}
+
+	if ((ESP_OK == err) && (OTA_APP_STATE_IMAGE != g_session.state) &&
+		(OTA_APP_STATE_DONE != g_session.state))
+	{
+		ESP_LOGE(g_tag, "ota_app_end: image truncated");
+		err = ESP_ERR_INVALID_SIZE;
+	}
+
+	if (ESP_OK == err)
+	{
+		err = ota_app_flush();
+	}
+
+	if ((ESP_OK == err) && (g_session.header_len > 0) &&
+		(g_session.result.written != g_session.header.target_size))
+	{
+		ESP_LOGE(g_tag, "ota_app_end: %u bytes written, %u expected",
+				 g_session.result.written, g_session.header.target_size);
+		err = ESP_ERR_INVALID_SIZE;
+	}
+
+	if (ESP_OK == err)
+	{
+		ota_app_progress(OTA_APP_PHASE_VERIFYING);
+		err = ota_app_verify();
+	}
+
+	if (ESP_OK == err)
+	{
+		err = esp_ota_end(g_session.h_ota);
+	}
+	else
+	{
+		esp_ota_abort(g_session.h_ota);
+	}
+
+	if (ESP_OK == err)
+	{
+		err = esp_ota_set_boot_partition(g_session.p_update);
+	}
+
+	g_session.result.err = err;
+	g_session.result.elapsed_ms = (uint32_t) ((esp_timer_get_time() - g_session.start_us) / 1000);
+	g_session.result.verify_us = (uint32_t) g_session.verify_us;
+
+	// Inflating, patching and the signature check all ran on the caller's
+	// stack: the margin left sizes the httpd and pull task stacks
+	//
+	g_session.result.stack_free = uxTaskGetStackHighWaterMark(NULL);
+
+	ESP_LOGI(g_tag, "ota_app_end: %s, format %d%s, %u bytes received for %u image bytes in %u ms, "
+			 "%u us of it verifying, %u bytes of stack left",
+			 esp_err_to_name(err), g_session.result.format,
+			 (true == g_session.result.b_signed) ? " signed" : "",
+			 g_session.result.received, g_session.result.written,
+			 g_session.result.elapsed_ms, g_session.result.verify_us,
+			 g_session.result.stack_free);
+
+	ota_app_release();
+	ota_app_progress((ESP_OK == err) ? OTA_APP_PHASE_DONE : OTA_APP_PHASE_FAILED);
+
+	// The next partition now holds a new image
+	//
+	if (ESP_OK == err)
+	{
+		ota_app_firmware_refresh();
+	}
+
+	return err;
+}
+
+void
+ota_app_abort (void)
+{
+	if (true == g_session.b_active)
+	{
+		esp_ota_abort(g_session.h_ota);
+		g_session.result.err = ESP_ERR_INVALID_STATE;
+		ota_app_release();
+		ota_app_progress(OTA_APP_PHASE_FAILED);
+	}
+}
+
+void
+ota_app_set_total (uint32_t total)
+{
+	taskENTER_CRITICAL(&g_progress_mux);
+	g_progress.total = total;
+	taskEXIT_CRITICAL(&g_progress_mux);
+}
+
+esp_err_t
+ota_app_set_expected_sha256 (const uint8_t * p_sha256)
+{
+	if (false == g_session.b_active)
+	{
+		return ESP_ERR_INVALID_STATE;
+	}
+
+	memcpy(g_session.expected_sha256, p_sha256, OTA_APP_SHA256_SIZE);
+	g_session.b_expected = true;
+
+	return ESP_OK;
+}
+
+void
+ota_app_get_result (ota_app_result_t * p_result)
+{
+	*p_result = g_session.result;
+}
+
+void
+ota_app_get_progress (ota_app_progress_t * p_progress)
+{
+	taskENTER_CRITICAL(&g_progress_mux);
+	*p_progress = g_progress;
+	taskEXIT_CRITICAL(&g_progress_mux);
+}
+
+size_t
+ota_app_format_progress_json (char * p_buf, size_t size)
+{
+	static const char * const phase_names[] = {
+		"idle", "erasing", "receiving", "verifying", "done", "failed"
+	};
+	ota_app_progress_t progress = {0};
+	int32_t len = 0;
+
+	ota_app_get_progress(&progress);
+
+	len = snprintf(p_buf, size,
+				   "{\"phase\":\"%s\",\"format\":%d,\"total\":%u,\"received\":%u,"
+				   "\"written\":%u,\"kb_s\":%u.%u,\"erase_ms\":%u,\"flash_ms\":%u,"
+				   "\"elapsed_ms\":%u,\"eta_s\":%d}",
+				   phase_names[progress.phase], progress.format, progress.total,
+				   progress.received, progress.written, progress.rate / 1024,
+				   ((progress.rate % 1024) * 10) / 1024, progress.erase_ms,
+				   progress.flash_ms, progress.elapsed_ms, progress.eta_s);
+
+	if ((len < 0) || ((size_t) len >= size))
+	{
+		len = 0;
+		p_buf[0] = '\0';
+	}
+
+	return (size_t) len;
+}
+
+// Plain image bytes. Stored after a header, the image ends at target_size
+// like a compressed stream ends. Without one, every byte given is image:
+// the caller strips the upload framing.
+//
+static esp_err_t
+ota_app_image (const uint8_t * p_data, size_t len)
+{
+	if (g_session.header_len > 0)
+	{
+		uint32_t left = g_session.header.target_size -
+						(g_session.result.written + g_session.page_len);
+
+		if (len >= left)
+		{
+			len = left;
+			g_session.state = OTA_APP_STATE_DONE;
+		}
+	}
+
+	return ota_app_emit(p_data, len);
+}
+
+// Image bytes, in order, to the update partition
+//
+static esp_err_t
+ota_app_emit (const uint8_t * p_data, size_t len)
+{
+	esp_err_t err = ESP_OK;
+
+	if ((g_session.header_len > 0) &&
+		(g_session.result.written + g_session.page_len + len > g_session.header.target_size))
+	{
+		return ESP_ERR_INVALID_SIZE;
+	}
+
+	ota_app_hash(p_data, len);
+
+	while ((len > 0) && (ESP_OK == err))
+	{
+		size_t chunk = MIN(len, OTA_APP_PAGE_SIZE - g_session.page_len);
+
+		memcpy(g_session.p_page + g_session.page_len, p_data, chunk);
+		g_session.page_len += chunk;
+		p_data += chunk;
+		len -= chunk;
+
+		if (OTA_APP_PAGE_SIZE == g_session.page_len)
+		{
+			err = ota_app_flush();
+		}
+	}
+
+	return err;
+}
+
+static esp_err_t
+ota_app_flush (void)
+{
+	esp_err_t err = ESP_OK;
+
+	if (g_session.page_len > 0)
+	{
+		int64_t start_us = esp_timer_get_time();
+
+		err = esp_ota_write(g_session.h_ota, g_session.p_page, g_session.page_len);
+		g_session.flash_us += esp_timer_get_time() - start_us;
+		g_session.result.written += g_session.page_len;
+		g_session.page_len = 0;
+	}
+
+	return err;
+}
+
+// The last 32 bytes are held back: with an appended digest they are the
+// hash of everything before them
+//
+static void
+ota_app_hash (const uint8_t * p_data, size_t len)
+{
+	int64_t start_us = esp_timer_get_time();
+
+	if ((g_session.image_ofs <= OTA_APP_HASH_APPENDED_OFS) &&
+		(g_session.image_ofs + len > OTA_APP_HASH_APPENDED_OFS))
+	{
+		g_session.b_hash_appended =
+			(1 == p_data[OTA_APP_HASH_APPENDED_OFS - g_session.image_ofs]);
+	}
+
+	g_session.image_ofs += len;
+
+	if (g_session.tail_len + len > sizeof(g_session.tail))
+	{
+		size_t out = g_session.tail_len + len - sizeof(g_session.tail);
+		size_t from_tail = MIN(out, g_session.tail_len);
+
+		mbedtls_md_update(&g_session.sha, g_session.tail, from_tail);
+		memmove(g_session.tail, g_session.tail + from_tail, g_session.tail_len - from_tail);
+		g_session.tail_len -= from_tail;
+		out -= from_tail;
+
+		mbedtls_md_update(&g_session.sha, p_data, out);
+		p_data += out;
+		len -= out;
+	}
+
+	memcpy(g_session.tail + g_session.tail_len, p_data, len);
+	g_session.tail_len += len;
+	g_session.verify_us += esp_timer_get_time() - start_us;
+}
+
+// Checks the hash computed while writing, before esp_ota_end() validates
+// the image layout
+//
+static esp_err_t
+ota_app_verify (void)
+{
+	int64_t start_us = esp_timer_get_time();
+	mbedtls_md_context_t full;
+	uint8_t prefix_sha256[OTA_APP_SHA256_SIZE] = {0};
+	uint8_t full_sha256[OTA_APP_SHA256_SIZE] = {0};
+	const uint8_t * p_image_sha256 = full_sha256;
+	esp_err_t err = ESP_OK;
+
+	mbedtls_md_init(&full);
+
+	if ((0 != mbedtls_md_setup(&full, mbedtls_md_info_from_type(MBEDTLS_MD_SHA256), 0)) ||
+		(0 != mbedtls_md_clone(&full, &g_session.sha)))
+	{
+		mbedtls_md_free(&full);
+
+		return ESP_ERR_NO_MEM;
+	}
+
+	mbedtls_md_update(&full, g_session.tail, g_session.tail_len);
+	mbedtls_md_finish(&full, full_sha256);
+	mbedtls_md_free(&full);
+	mbedtls_md_finish(&g_session.sha, prefix_sha256);
+
+	// Same as esp_partition_get_sha256() will give once it runs
+	//
+	if (true == g_session.b_hash_appended)
+	{
+		p_image_sha256 = prefix_sha256;
+
+		if ((sizeof(g_session.tail) != g_session.tail_len) ||
+			(0 != memcmp(g_session.tail, prefix_sha256, sizeof(prefix_sha256))))
+		{
+			ESP_LOGE(g_tag, "ota_app_verify: appended SHA-256 does not match the image");
+			err = ESP_ERR_INVALID_CRC;
+		}
+	}
+
+	if ((ESP_OK == err) && (g_session.header_len > 0) &&
+		(0 != memcmp(g_session.header.target_sha256, p_image_sha256, OTA_APP_SHA256_SIZE)))
+	{
+		ESP_LOGE(g_tag, "ota_app_verify: image SHA-256 differs from the header");
+		err = ESP_ERR_INVALID_CRC;
+	}
+
+	if ((ESP_OK == err) && (true == g_session.b_expected) &&
+		(0 != memcmp(g_session.expected_sha256, p_image_sha256, OTA_APP_SHA256_SIZE)))
+	{
+		ESP_LOGE(g_tag, "ota_app_verify: image SHA-256 differs from the expected one");
+		err = ESP_ERR_INVALID_CRC;
+	}
+
+	g_session.verify_us += esp_timer_get_time() - start_us;
+
+	return err;
+}
+
+// Publishes the writer state, the rate is refreshed once per window
+//
+static void
+ota_app_progress (ota_app_phase_t phase)
+{
+	int64_t now_us = esp_timer_get_time();
+	int64_t window_us = now_us - g_session.rate_start_us;
+	ota_app_phase_t previous = OTA_APP_PHASE_IDLE;
+
+	taskENTER_CRITICAL(&g_progress_mux);
+	previous = g_progress.phase;
+	g_progress.phase = phase;
+	g_progress.format = g_session.result.format;
+	g_progress.received = g_session.result.received;
+	g_progress.written = g_session.result.written;
+	g_progress.flash_ms = (uint32_t) (g_session.flash_us / 1000);
+	g_progress.elapsed_ms = (uint32_t) ((now_us - g_session.start_us) / 1000);
+
+	if (window_us >= OTA_APP_RATE_WINDOW_US)
+	{
+		g_progress.rate = (uint32_t) (((int64_t) (g_session.result.received -
+												  g_session.rate_start_bytes) * 1000000) /
+									  window_us);
+		g_session.rate_start_us = now_us;
+		g_session.rate_start_bytes = g_session.result.received;
+	}
+
+	g_progress.eta_s = ((OTA_APP_PHASE_RECEIVING == phase) && (g_progress.rate > 0) &&
+						(g_progress.total > g_progress.received)) ?
+					   (int32_t) ((g_progress.total - g_progress.received) / g_progress.rate) :
+					   ((OTA_APP_PHASE_DONE == phase) ? 0 : -1);
+	taskEXIT_CRITICAL(&g_progress_mux);
+
+	// Shown over the WiFi state until the restart or the next update
+	//
+	if ((previous != phase) && (OTA_APP_PHASE_DONE == phase))
+	{
+		rgb_led_status(RGB_LED_STATUS_OTA_DONE);
+	}
+	else if ((previous != phase) && (OTA_APP_PHASE_FAILED == phase))
+	{
+		rgb_led_status(RGB_LED_STATUS_OTA_FAILED);
+	}
+}
+
+static void
+ota_app_release (void)
+{
+	free(g_session.p_page);
+	g_session.p_page = NULL;
+	free(g_session.p_extension);
+	g_session.p_extension = NULL;
+	mbedtls_md_free(&g_session.sha);
+#if CONFIG_OTA_APP_PATCH
+	free(g_session.p_inflator);
+	g_session.p_inflator = NULL;
+	free(g_session.p_dict);
+	g_session.p_dict = NULL;
+#endif
+	g_session.b_active = false;
+}
+
+#if CONFIG_OTA_APP_PATCH
+static esp_err_t
+ota_app_header (const uint8_t * p_data, size_t len, size_t * p_used)
+{
+	ota_app_patch_header_t * p_header = &g_session.header;
+	size_t chunk = 0;
+
+	*p_used = 0;
+
+	if (g_session.header_len < sizeof(*p_header))
+	{
+		chunk = MIN(len, sizeof(*p_header) - g_session.header_len);
+		memcpy((uint8_t *) p_header + g_session.header_len, p_data, chunk);
+		g_session.header_len += chunk;
+		*p_used = chunk;
+
+		if (g_session.header_len < sizeof(*p_header))
+		{
+			return ESP_OK;
+		}
+
+		if ((0 != memcmp(p_header->magic, OTA_APP_PATCH_MAGIC, sizeof(p_header->magic))) ||
+			(OTA_APP_PATCH_VERSION != p_header->version) ||
+			(p_header->header_len < sizeof(*p_header)) ||
+			(p_header->header_len > sizeof(*p_header) + sizeof(uint16_t) + OTA_APP_SIGNATURE_MAX) ||
+			((OTA_APP_FORMAT_IMAGE != p_header->format) &&
+			 (OTA_APP_FORMAT_COMPRESSED != p_header->format) &&
+			 (OTA_APP_FORMAT_DELTA != p_header->format)) ||
+			(p_header->target_size > g_session.p_update->size))
+		{
+			ESP_LOGE(g_tag, "ota_app_header: bad header");
+
+			return ESP_ERR_NOT_SUPPORTED;
+		}
+
+		if (p_header->header_len > sizeof(*p_header))
+		{
+			g_session.p_extension = malloc(p_header->header_len - sizeof(*p_header));
+
+			if (NULL == g_session.p_extension)
+			{
+				return ESP_ERR_NO_MEM;
+			}
+		}
+	}
+
+	if (g_session.header_len < p_header->header_len)
+	{
+		chunk = MIN(len - *p_used, p_header->header_len - g_session.header_len);
+		memcpy(g_session.p_extension + (g_session.header_len - sizeof(*p_header)),
+			   p_data + *p_used, chunk);
+		g_session.header_len += chunk;
+		*p_used += chunk;
+
+		if (g_session.header_len < p_header->header_len)
+		{
+			return ESP_OK;
+		}
+	}
+
+	return ota_app_header_done();
+}
+
+static esp_err_t
+ota_app_header_done (void)
+{
+	ota_app_patch_header_t * p_header = &g_session.header;
+	esp_err_t err = ESP_OK;
+
+#if CONFIG_OTA_APP_SIGNED
+	// Nothing is written before the signature is checked
+	//
+	err = ota_app_signature();
+
+	if (ESP_OK != err)
+	{
+		return err;
+	}
+#endif
+
+	if (OTA_APP_FORMAT_DELTA == p_header->format)
+	{
+		uint8_t running_sha256[OTA_APP_SHA256_SIZE] = {0};
+
+		// The delta only applies to the image it was made against
+		//
+		if ((p_header->base_size > g_session.p_running->size) ||
+			(ESP_OK != esp_partition_get_sha256(g_session.p_running, running_sha256)) ||
+			(0 != memcmp(running_sha256, p_header->base_sha256, sizeof(running_sha256))))
+		{
+			ESP_LOGE(g_tag, "ota_app_header: delta made for another running image");
+
+			return ESP_ERR_INVALID_VERSION;
+		}
+
+		g_session.b_in_record = true;
+	}
+
+	g_session.result.format = (ota_app_format_t) p_header->format;
+
+	ESP_LOGI(g_tag, "ota_app_header: %s image, %u bytes",
+			 (OTA_APP_FORMAT_DELTA == p_header->format) ? "delta" :
+			 (OTA_APP_FORMAT_COMPRESSED == p_header->format) ? "compressed" : "stored",
+			 p_header->target_size);
+
+	if (OTA_APP_FORMAT_IMAGE == p_header->format)
+	{
+		g_session.state = OTA_APP_STATE_IMAGE;
+
+		return err;
+	}
+
+	g_session.p_inflator = malloc(sizeof(tinfl_decompressor));
+	g_session.p_dict = malloc(TINFL_LZ_DICT_SIZE);
+
+	if ((NULL == g_session.p_inflator) || (NULL == g_session.p_dict))
+	{
+		return ESP_ERR_NO_MEM;
+	}
+
+	tinfl_init(g_session.p_inflator);
+	g_session.state = OTA_APP_STATE_INFLATE;
+
+	return err;
+}
+#endif
+
+#if CONFIG_OTA_APP_SIGNED
+// DER signature of the SHA-256 of the header structure, ECDSA or RSA
+// depending on the key
+//
+static esp_err_t
+ota_app_signature (void)
+{
+	extern const uint8_t ota_signing_key_pem_start[] asm("_binary_ota_signing_key_pem_start");
+	extern const uint8_t ota_signing_key_pem_end[] asm("_binary_ota_signing_key_pem_end");
+	int64_t start_us = esp_timer_get_time();
+	uint8_t header_sha256[OTA_APP_SHA256_SIZE] = {0};
+	uint16_t sig_len = 0;
+	size_t extension_len = g_session.header.header_len - sizeof(g_session.header);
+	mbedtls_pk_context key;
+	esp_err_t err = ESP_OK;
+
+	if (extension_len > sizeof(sig_len))
+	{
+		memcpy(&sig_len, g_session.p_extension, sizeof(sig_len));
+	}
+
+	if ((0 == sig_len) || (sizeof(sig_len) + sig_len > extension_len))
+	{
+		ESP_LOGE(g_tag, "ota_app_signature: unsigned image refused");
+
+		return ESP_ERR_NOT_SUPPORTED;
+	}
+
+	mbedtls_pk_init(&key);
+
+	if ((0 != mbedtls_md(mbedtls_md_info_from_type(MBEDTLS_MD_SHA256),
+						 (const uint8_t *) &g_session.header, sizeof(g_session.header),
+						 header_sha256)) ||
+		(0 != mbedtls_pk_parse_public_key(&key, ota_signing_key_pem_start,
+										  ota_signing_key_pem_end - ota_signing_key_pem_start)))
+	{
+		err = ESP_FAIL;
+	}
+	else if (0 != mbedtls_pk_verify(&key, MBEDTLS_MD_SHA256, header_sha256,
+									sizeof(header_sha256),
+									g_session.p_extension + sizeof(sig_len), sig_len))
+	{
+		ESP_LOGE(g_tag, "ota_app_signature: bad signature");
+		err = ESP_ERR_INVALID_CRC;
+	}
+
+	mbedtls_pk_free(&key);
+	g_session.result.b_signed = (ESP_OK == err);
+	g_session.verify_us += esp_timer_get_time() - start_us;
+
+	return err;
+}
+#endif
+
+#if CONFIG_OTA_APP_PATCH
+static esp_err_t
+ota_app_inflate (const uint8_t * p_data, size_t len)
+{
+	tinfl_status status = TINFL_STATUS_NEEDS_MORE_INPUT;
+	esp_err_t err = ESP_OK;
+
+	do
+	{
+		size_t in_bytes = len;
+		size_t out_bytes = TINFL_LZ_DICT_SIZE - g_session.dict_ofs;
+
+		status = tinfl_decompress(g_session.p_inflator, p_data, &in_bytes,
+								  g_session.p_dict, g_session.p_dict + g_session.dict_ofs,
+								  &out_bytes,
+								  TINFL_FLAG_PARSE_ZLIB_HEADER | TINFL_FLAG_HAS_MORE_INPUT);
+		p_data += in_bytes;
+		len -= in_bytes;
+
+		if (out_bytes > 0)
+		{
+			err = (OTA_APP_FORMAT_DELTA == g_session.result.format) ?
+				  ota_app_delta(g_session.p_dict + g_session.dict_ofs, out_bytes) :
+				  ota_app_emit(g_session.p_dict + g_session.dict_ofs, out_bytes);
+			g_session.dict_ofs = (g_session.dict_ofs + out_bytes) & (TINFL_LZ_DICT_SIZE - 1);
+		}
+
+		if (status < TINFL_STATUS_DONE)
+		{
+			ESP_LOGE(g_tag, "ota_app_inflate: corrupt stream (%d)", status);
+			err = ESP_ERR_INVALID_RESPONSE;
+		}
+
+		if (TINFL_STATUS_DONE == status)
+		{
+			// What follows (the form boundary) is not part of the image
+			//
+			g_session.state = OTA_APP_STATE_DONE;
+		}
+
+		if ((0 == in_bytes) && (0 == out_bytes) && (TINFL_STATUS_HAS_MORE_OUTPUT != status))
+		{
+			break;
+		}
+	} while ((ESP_OK == err) && (TINFL_STATUS_DONE != status) &&
+			 ((len > 0) || (TINFL_STATUS_HAS_MORE_OUTPUT == status)));
+
+	return err;
+}
+
+static esp_err_t
+ota_app_delta (const uint8_t * p_data, size_t len)
+{
+	uint8_t base[OTA_APP_BASE_CHUNK];
+	esp_err_t err = ESP_OK;
+
+	while ((len > 0) && (ESP_OK == err))
+	{
+		if (true == g_session.b_in_record)
+		{
+			size_t chunk = MIN(len, OTA_APP_RECORD_SIZE - g_session.record_len);
+
+			memcpy(g_session.record + g_session.record_len, p_data, chunk);
+			g_session.record_len += chunk;
+			p_data += chunk;
+			len -= chunk;
+
+			if (OTA_APP_RECORD_SIZE == g_session.record_len)
+			{
+				memcpy(&g_session.diff_left, &g_session.record[0], sizeof(uint32_t));
+				memcpy(&g_session.extra_left, &g_session.record[4], sizeof(uint32_t));
+				memcpy(&g_session.seek, &g_session.record[8], sizeof(int32_t));
+				g_session.record_len = 0;
+				g_session.b_in_record = false;
+			}
+		}
+		else if (g_session.diff_left > 0)
+		{
+			size_t chunk = MIN(MIN(len, g_session.diff_left), sizeof(base));
+
+			if (g_session.base_pos + chunk > g_session.header.base_size)
+			{
+				return ESP_ERR_INVALID_SIZE;
+			}
+
+			err = esp_partition_read(g_session.p_running, g_session.base_pos, base, chunk);
+
+			for (size_t idx = 0; idx < chunk; ++idx)
+			{
+				base[idx] += p_data[idx];
+			}
+
+			if (ESP_OK == err)
+			{
+				err = ota_app_emit(base, chunk);
+			}
+
+			g_session.base_pos += chunk;
+			g_session.diff_left -= chunk;
+			p_data += chunk;
+			len -= chunk;
+		}
+		else if (g_session.extra_left > 0)
+		{
+			size_t chunk = MIN(len, g_session.extra_left);
+
+			err = ota_app_emit(p_data, chunk);
+			g_session.extra_left -= chunk;
+			p_data += chunk;
+			len -= chunk;
+		}
+
+		if ((false == g_session.b_in_record) && (0 == g_session.diff_left) &&
+			(0 == g_session.extra_left))
+		{
+			g_session.base_pos += g_session.seek;
+			g_session.b_in_record = true;
+		}
+	}
+
+	return err;
+}
+#endif
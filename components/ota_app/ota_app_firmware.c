@@ -0,0 +1,214 @@
+/*
+ * ota_app_firmware.c
+ *
+ *  Created on: 19 oct 2026
+ *      Author: Filippo
+ */
+
+#include "ota_app_firmware.h"
+#include "ota_app_health.h"
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "esp_ota_ops.h"
+#include "esp_partition.h"
+#include "esp_log.h"
+#include "sdkconfig.h"
+#include "app_static.h"
+
+#define OTA_APP_FIRMWARE_JSON_SIZE	1536
+#define OTA_APP_FIRMWARE_SHA_SIZE	32
+
+static const char g_tag[] = "ota_app_firmware";
+
+// The inventory is refreshed from the httpd, pull, sensor, MQTT and WiFi
+// tasks. Building it reads flash, so a mutex and not a spinlock.
+//
+static SemaphoreHandle_t gh_firmware_mutex = NULL;
+static char g_firmware_json[OTA_APP_FIRMWARE_JSON_SIZE];
+static size_t g_firmware_json_len = 0;
+static char g_image_sha256[2 * OTA_APP_FIRMWARE_SHA_SIZE + 1];
+
+static const char * ota_app_firmware_state_name(const esp_partition_t * p_partition);
+static int32_t ota_app_firmware_app_json(char * p_buf, size_t size,
+										 const esp_app_desc_t * p_desc);
+static void ota_app_firmware_hex(char * p_hex, const uint8_t * p_data, size_t len);
+
+void
+ota_app_firmware_init (void)
+{
+	uint8_t sha256[OTA_APP_FIRMWARE_SHA_SIZE] = {0};
+
+	if (NULL != gh_firmware_mutex)
+	{
+		return;
+	}
+
+	// The one full read of the running image
+	//
+	if (ESP_OK == esp_partition_get_sha256(esp_ota_get_running_partition(), sha256))
+	{
+		ota_app_firmware_hex(g_image_sha256, sha256, sizeof(sha256));
+	}
+
+	gh_firmware_mutex = APP_MUTEX_CREATE();
+	ota_app_firmware_refresh();
+}
+
+void
+ota_app_firmware_refresh (void)
+{
+	const esp_partition_t * p_running = esp_ota_get_running_partition();
+	const esp_partition_t * p_boot = esp_ota_get_boot_partition();
+	const esp_partition_t * p_next = esp_ota_get_next_update_partition(NULL);
+	esp_partition_iterator_t h_iter = NULL;
+	esp_app_desc_t desc = {0};
+	size_t size = sizeof(g_firmware_json);
+	int32_t len = 0;
+
+	if (NULL == gh_firmware_mutex)
+	{
+		return;
+	}
+
+	xSemaphoreTake(gh_firmware_mutex, portMAX_DELAY);
+
+	len = snprintf(g_firmware_json, size,
+				   "{\"running\":\"%s\",\"boot\":\"%s\",\"next\":\"%s\","
+				   "\"image_sha256\":\"%s\",\"rollback\":{\"pending_verify\":%s,"
+				   "\"possible\":%s},\"app\":",
+				   p_running->label, (NULL != p_boot) ? p_boot->label : "",
+				   (NULL != p_next) ? p_next->label : "", g_image_sha256,
+				   (true == ota_app_health_pending()) ? "true" : "false",
+				   (true == esp_ota_check_rollback_is_possible()) ? "true" : "false");
+
+	if ((len > 0) && ((size_t) len < size) &&
+		(ESP_OK == esp_ota_get_partition_description(p_running, &desc)))
+	{
+		len += ota_app_firmware_app_json(g_firmware_json + len, size - len, &desc);
+	}
+
+	if ((len > 0) && ((size_t) len < size))
+	{
+		len += snprintf(g_firmware_json + len, size - len, ",\"partitions\":[");
+	}
+
+	h_iter = esp_partition_find(ESP_PARTITION_TYPE_APP, ESP_PARTITION_SUBTYPE_ANY, NULL);
+
+	for (bool b_first = true; (NULL != h_iter) && (len > 0) && ((size_t) len < size);
+		 b_first = false)
+	{
+		const esp_partition_t * p_partition = esp_partition_get(h_iter);
+
+		len += snprintf(g_firmware_json + len, size - len,
+						"%s{\"label\":\"%s\",\"address\":%u,\"size\":%u,\"state\":\"%s\",\"app\":",
+						(true == b_first) ? "" : ",", p_partition->label,
+						p_partition->address, p_partition->size,
+						ota_app_firmware_state_name(p_partition));
+
+		if ((len > 0) && ((size_t) len < size))
+		{
+			len += (ESP_OK == esp_ota_get_partition_description(p_partition, &desc)) ?
+				   ota_app_firmware_app_json(g_firmware_json + len, size - len, &desc) :
+				   snprintf(g_firmware_json + len, size - len, "null");
+		}
+
+		if ((len > 0) && ((size_t) len < size))
+		{
+			len += snprintf(g_firmware_json + len, size - len, "}");
+		}
+
+		h_iter = esp_partition_next(h_iter);
+	}
+
+	esp_partition_iterator_release(h_iter);
+
+	if ((len > 0) && ((size_t) (len + 3) <= size))
+	{
+		len += snprintf(g_firmware_json + len, size - len, "]}");
+	}
+	else
+	{
+		ESP_LOGE(g_tag, "ota_app_firmware_refresh: inventory larger than %u bytes", size);
+		len = 0;
+	}
+
+	g_firmware_json_len = len;
+	xSemaphoreGive(gh_firmware_mutex);
+}
+
+size_t
+ota_app_firmware_format_json (char * p_buf, size_t size)
+{
+	size_t len = 0;
+
+	if (NULL == gh_firmware_mutex)
+	{
+		p_buf[0] = '\0';
+
+		return 0;
+	}
+
+	xSemaphoreTake(gh_firmware_mutex, portMAX_DELAY);
+
+	if (g_firmware_json_len < size)
+	{
+		len = g_firmware_json_len;
+		memcpy(p_buf, g_firmware_json, len);
+	}
+
+	xSemaphoreGive(gh_firmware_mutex);
+
+	p_buf[len] = '\0';
+
+	return len;
+}
+
+static const char *
+ota_app_firmware_state_name (const esp_partition_t * p_partition)
+{
+	esp_ota_img_states_t state = ESP_OTA_IMG_UNDEFINED;
+
+	// Factory app, or a slot never selected for boot
+	//
+	if (ESP_OK != esp_ota_get_state_partition(p_partition, &state))
+	{
+		return "none";
+	}
+
+	switch (state)
+	{
+		case ESP_OTA_IMG_NEW:				return "new";
+		case ESP_OTA_IMG_PENDING_VERIFY:	return "pending_verify";
+		case ESP_OTA_IMG_VALID:				return "valid";
+		case ESP_OTA_IMG_INVALID:			return "invalid";
+		case ESP_OTA_IMG_ABORTED:			return "aborted";
+		default:							return "undefined";
+	}
+}
+
+static int32_t
+ota_app_firmware_app_json (char * p_buf, size_t size, const esp_app_desc_t * p_desc)
+{
+	char elf_sha256[2 * sizeof(p_desc->app_elf_sha256) + 1] = {0};
+
+	ota_app_firmware_hex(elf_sha256, p_desc->app_elf_sha256, sizeof(p_desc->app_elf_sha256));
+
+	return snprintf(p_buf, size,
+					"{\"project\":\"%.32s\",\"version\":\"%.32s\",\"idf\":\"%.32s\","
+					"\"date\":\"%.16s\",\"time\":\"%.16s\",\"secure_version\":%u,"
+					"\"elf_sha256\":\"%s\"}",
+					p_desc->project_name, p_desc->version, p_desc->idf_ver,
+					p_desc->date, p_desc->time, p_desc->secure_version, elf_sha256);
+}
+
+static void
+ota_app_firmware_hex (char * p_hex, const uint8_t * p_data, size_t len)
+{
+	for (size_t idx = 0; idx < len; ++idx)
+	{
+		sprintf(p_hex + 2 * idx, "%02x", p_data[idx]);
+	}
+}
@@ -0,0 +1,114 @@
+/*
+ * ota_app_health.c
+ *
+ *  Created on: 19 oct 2026
+ *      Author: Filippo
+ */
+
+#include "ota_app_health.h"
+#include "ota_app_firmware.h"
+#include "freertos/FreeRTOS.h"
+#include "esp_ota_ops.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+#include "sdkconfig.h"
+
+static const char g_tag[] = "ota_app_health";
+
+static portMUX_TYPE g_health_mux = portMUX_INITIALIZER_UNLOCKED;
+static esp_timer_handle_t gh_health_timer = NULL;
+static uint32_t g_required = 0;
+static uint32_t g_reported = 0;
+static bool gb_pending = false;
+
+static void ota_app_health_timeout(void * p_arg);
+
+void
+ota_app_health_start (uint32_t required_mask)
+{
+	const esp_partition_t * p_running = esp_ota_get_running_partition();
+	esp_ota_img_states_t state = ESP_OTA_IMG_UNDEFINED;
+	const esp_timer_create_args_t timer_args = {
+		.callback = ota_app_health_timeout,
+		.name = "ota_health"
+	};
+
+	if ((ESP_OK != esp_ota_get_state_partition(p_running, &state)) ||
+		(ESP_OTA_IMG_PENDING_VERIFY != state))
+	{
+		return;
+	}
+
+	if (0 == required_mask)
+	{
+		esp_ota_mark_app_valid_cancel_rollback();
+
+		return;
+	}
+
+	ESP_LOGW(g_tag, "ota_app_health_start: new image on probation, checks 0x%X within %d s",
+			 required_mask, CONFIG_OTA_APP_HEALTH_TIMEOUT_S);
+
+	g_required = required_mask;
+	gb_pending = true;
+
+	if ((ESP_OK != esp_timer_create(&timer_args, &gh_health_timer)) ||
+		(ESP_OK != esp_timer_start_once(gh_health_timer,
+										CONFIG_OTA_APP_HEALTH_TIMEOUT_S * 1000000LL)))
+	{
+		ESP_LOGE(g_tag, "ota_app_health_start: no timer, rolling back");
+		esp_ota_mark_app_invalid_rollback_and_reboot();
+	}
+}
+
+void
+ota_app_health_report (uint32_t check)
+{
+	bool b_passed = false;
+
+	taskENTER_CRITICAL(&g_health_mux);
+
+	if (true == gb_pending)
+	{
+		g_reported |= check;
+
+		if ((g_reported & g_required) == g_required)
+		{
+			gb_pending = false;
+			b_passed = true;
+		}
+	}
+
+	taskEXIT_CRITICAL(&g_health_mux);
+
+	if (true == b_passed)
+	{
+		esp_timer_stop(gh_health_timer);
+		esp_ota_mark_app_valid_cancel_rollback();
+		ota_app_firmware_refresh();
+		ESP_LOGI(g_tag, "ota_app_health_report: checks passed, image marked valid");
+	}
+}
+
+bool
+ota_app_health_pending (void)
+{
+	return gb_pending;
+}
+
+static void
+ota_app_health_timeout (void * p_arg)
+{
+	uint32_t missing = 0;
+
+	taskENTER_CRITICAL(&g_health_mux);
+	missing = gb_pending ? (g_required & ~g_reported) : 0;
+	gb_pending = false;
+	taskEXIT_CRITICAL(&g_health_mux);
+
+	if (0 != missing)
+	{
+		ESP_LOGE(g_tag, "ota_app_health_timeout: checks 0x%X failed, rolling back", missing);
+		esp_ota_mark_app_invalid_rollback_and_reboot();
+	}
+}
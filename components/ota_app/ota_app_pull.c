@@ -0,0 +1,513 @@
+/*
+ * ota_app_pull.c
+ *
+ *  Created on: 19 oct 2026
+ *      Author: Filippo
+ */
+
+#include "ota_app_pull.h"
+#include "ota_app.h"
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include "sdkconfig.h"
+
+#if CONFIG_OTA_APP_PULL
+#	include "freertos/FreeRTOS.h"
+#	include "freertos/task.h"
+#	include "esp_http_client.h"
+#	include "esp_ota_ops.h"
+#	include "esp_partition.h"
+#	include "esp_system.h"
+#	include "esp_wifi.h"
+#	include "esp_log.h"
+#	include "esp_idf_version.h"
+#	include "cJSON.h"
+#	include "sys/param.h"
+#	include "tasks_common.h"
+#	include "task_plan.h"
+#	include "app_static.h"
+#	if CONFIG_MBEDTLS_CERTIFICATE_BUNDLE
+#		include "esp_crt_bundle.h"
+#	endif
+#	if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
+#		include "esp_app_desc.h"
+#	endif
+
+#	define OTA_APP_PULL_MANIFEST_SIZE	1024
+#	define OTA_APP_PULL_URL_SIZE		256
+#	define OTA_APP_PULL_VERSION_SIZE	32
+#	define OTA_APP_PULL_BUFF_SIZE		1024
+#	define OTA_APP_PULL_TIMEOUT_MS		10000
+
+// Longest wait between two attempts of the same download
+//
+#	define OTA_APP_PULL_BACKOFF_MAX_S	30
+
+static const char g_tag[] = "ota_app_pull";
+
+static TaskHandle_t gh_pull_task = NULL;
+static char g_manifest[OTA_APP_PULL_MANIFEST_SIZE];
+static char g_buff[OTA_APP_PULL_BUFF_SIZE];
+
+// Image size from the Content-Range of the last answer, 0 until known
+//
+static int64_t g_range_total = 0;
+
+static void ota_app_pull_task(void * p_param);
+static void ota_app_pull_run(void);
+static esp_err_t ota_app_pull_event(esp_http_client_event_t * p_event);
+static esp_http_client_handle_t ota_app_pull_client(const char * p_url);
+static esp_err_t ota_app_pull_manifest(char * p_url, char * p_version,
+										uint8_t * p_sha256);
+static esp_err_t ota_app_pull_download(const char * p_url, const uint8_t * p_sha256);
+static esp_err_t ota_app_pull_chunk(esp_http_client_handle_t h_client,
+									uint32_t * p_offset);
+#endif
+
+void
+ota_app_pull_start (void)
+{
+#if CONFIG_OTA_APP_PULL
+	// Called again on every reconnection
+	//
+	if (NULL != gh_pull_task)
+	{
+		return;
+	}
+
+	gh_pull_task = APP_TASK_CREATE_PINNED(ota_app_pull_task, "ota_app_pull",
+										  OTA_APP_PULL_TASK_STACK_SIZE, NULL,
+										  task_plan_get(TASK_PLAN_OTA_PULL)->priority,
+										  task_plan_get(TASK_PLAN_OTA_PULL)->core_id);
+#endif
+}
+
+void
+ota_app_pull_check (void)
+{
+#if CONFIG_OTA_APP_PULL
+	if (NULL != gh_pull_task)
+	{
+		xTaskNotifyGive(gh_pull_task);
+	}
+#endif
+}
+
+int
+ota_app_pull_version_cmp (const char * p_left, const char * p_right)
+{
+	// "v1.2.3" is the same as "1.2.3"
+	//
+	p_left += ('v' == *p_left) ? 1 : 0;
+	p_right += ('v' == *p_right) ? 1 : 0;
+
+	while (('\0' != *p_left) || ('\0' != *p_right))
+	{
+		char * p_left_end = (char *) p_left;
+		char * p_right_end = (char *) p_right;
+		unsigned long left = ('\0' == *p_left) ? 0 : strtoul(p_left, &p_left_end, 10);
+		unsigned long right = ('\0' == *p_right) ? 0 : strtoul(p_right, &p_right_end, 10);
+
+		// Not a number (a suffix like "-rc1"), the rest is compared as text
+		//
+		if ((('\0' != *p_left) && (p_left_end == p_left)) ||
+			(('\0' != *p_right) && (p_right_end == p_right)))
+		{
+			return strcmp(p_left, p_right);
+		}
+
+		if (left != right)
+		{
+			return (left < right) ? -1 : 1;
+		}
+
+		p_left = p_left_end + (('.' == *p_left_end) ? 1 : 0);
+		p_right = p_right_end + (('.' == *p_right_end) ? 1 : 0);
+	}
+
+	return 0;
+}
+
+#if CONFIG_OTA_APP_PULL
+static void
+ota_app_pull_task (void * p_param)
+{
+	for (;;)
+	{
+		ota_app_pull_run();
+
+		// Next check, or earlier on ota_app_pull_check()
+		//
+		ulTaskNotifyTake(pdTRUE,
+						 (CONFIG_OTA_APP_PULL_INTERVAL_S * 1000) / portTICK_PERIOD_MS);
+	}
+
+	vTaskDelete(NULL);
+}
+
+static void
+ota_app_pull_run (void)
+{
+	char url[OTA_APP_PULL_URL_SIZE] = {0};
+	char version[OTA_APP_PULL_VERSION_SIZE] = {0};
+	uint8_t sha256[32] = {0};
+	wifi_ap_record_t ap_info = {0};
+	esp_err_t err = ESP_OK;
+#	if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
+	const esp_app_desc_t * p_app = esp_app_get_description();
+#	else
+	const esp_app_desc_t * p_app = esp_ota_get_app_description();
+#	endif
+
+	if (ESP_OK != esp_wifi_sta_get_ap_info(&ap_info))
+	{
+		ESP_LOGI(g_tag, "ota_app_pull_run: station not connected, check skipped");
+
+		return;
+	}
+
+	err = ota_app_pull_manifest(url, version, sha256);
+
+	if (ESP_OK != err)
+	{
+		ESP_LOGW(g_tag, "ota_app_pull_run: manifest %s, %s",
+				 CONFIG_OTA_APP_PULL_MANIFEST_URL, esp_err_to_name(err));
+
+		return;
+	}
+
+	if (ota_app_pull_version_cmp(version, p_app->version) <= 0)
+	{
+		ESP_LOGI(g_tag, "ota_app_pull_run: running %s, offered %s, up to date",
+				 p_app->version, version);
+
+		return;
+	}
+
+	ESP_LOGI(g_tag, "ota_app_pull_run: updating %s to %s from %s",
+			 p_app->version, version, url);
+
+	err = ota_app_pull_download(url, sha256);
+
+	if (ESP_OK == err)
+	{
+		ESP_LOGI(g_tag, "ota_app_pull_run: %s installed, restarting", version);
+		esp_restart();
+	}
+
+	ESP_LOGE(g_tag, "ota_app_pull_run: update to %s failed, %s",
+			 version, esp_err_to_name(err));
+}
+
+static esp_err_t
+ota_app_pull_event (esp_http_client_event_t * p_event)
+{
+	// "Content-Range: bytes 0-16383/1234567", the total is the image size
+	//
+	if ((HTTP_EVENT_ON_HEADER == p_event->event_id) &&
+		(0 == strcasecmp(p_event->header_key, "Content-Range")))
+	{
+		const char * p_total = strchr(p_event->header_value, '/');
+
+		if ((NULL != p_total) && ('*' != p_total[1]))
+		{
+			g_range_total = strtoll(p_total + 1, NULL, 10);
+		}
+	}
+
+	return ESP_OK;
+}
+
+static esp_http_client_handle_t
+ota_app_pull_client (const char * p_url)
+{
+	esp_http_client_config_t config = {
+		.url = p_url,
+		.event_handler = ota_app_pull_event,
+		.timeout_ms = OTA_APP_PULL_TIMEOUT_MS,
+#	if CONFIG_MBEDTLS_CERTIFICATE_BUNDLE
+		.crt_bundle_attach = esp_crt_bundle_attach,
+#	endif
+	};
+
+	return esp_http_client_init(&config);
+}
+
+// p_sha256 gets the "sha256" of the full image, zeros when not given
+//
+static esp_err_t
+ota_app_pull_manifest (char * p_url, char * p_version, uint8_t * p_sha256)
+{
+	esp_http_client_handle_t h_client = ota_app_pull_client(CONFIG_OTA_APP_PULL_MANIFEST_URL);
+	const esp_partition_t * p_running = esp_ota_get_running_partition();
+	uint8_t sha256[32] = {0};
+	char running_sha[2 * sizeof(sha256) + 1] = {0};
+	cJSON * p_root = NULL;
+	const cJSON * p_delta = NULL;
+	const cJSON * p_sha = NULL;
+	const char * p_image_url = NULL;
+	int total = 0;
+	int len = 0;
+	esp_err_t err = ESP_OK;
+
+	if (NULL == h_client)
+	{
+		return ESP_ERR_NO_MEM;
+	}
+
+	err = esp_http_client_open(h_client, 0);
+
+	if ((ESP_OK == err) && (esp_http_client_fetch_headers(h_client) < 0))
+	{
+		err = ESP_FAIL;
+	}
+
+	if ((ESP_OK == err) && (200 != esp_http_client_get_status_code(h_client)))
+	{
+		err = ESP_ERR_NOT_FOUND;
+	}
+
+	while ((ESP_OK == err) && (total < (int) sizeof(g_manifest) - 1) &&
+		   ((len = esp_http_client_read(h_client, g_manifest + total,
+										sizeof(g_manifest) - 1 - total)) > 0))
+	{
+		total += len;
+	}
+
+	esp_http_client_cleanup(h_client);
+
+	if (ESP_OK != err)
+	{
+		return err;
+	}
+
+	g_manifest[total] = '\0';
+	p_root = cJSON_Parse(g_manifest);
+
+	if ((NULL == p_root) ||
+		(false == cJSON_IsString(cJSON_GetObjectItem(p_root, "version"))) ||
+		(false == cJSON_IsString(cJSON_GetObjectItem(p_root, "url"))))
+	{
+		cJSON_Delete(p_root);
+
+		return ESP_ERR_INVALID_RESPONSE;
+	}
+
+	p_image_url = cJSON_GetObjectItem(p_root, "url")->valuestring;
+	p_sha = cJSON_GetObjectItem(p_root, "sha256");
+
+	if ((true == cJSON_IsString(p_sha)) &&
+		(2 * sizeof(sha256) == strlen(p_sha->valuestring)))
+	{
+		for (size_t idx = 0; idx < sizeof(sha256); ++idx)
+		{
+			char byte_hex[3] = {p_sha->valuestring[2 * idx],
+								p_sha->valuestring[2 * idx + 1], '\0'};
+
+			p_sha256[idx] = (uint8_t) strtoul(byte_hex, NULL, 16);
+		}
+	}
+
+	// The delta is only good for the image it was made from
+	//
+	p_delta = cJSON_GetObjectItem(p_root, "delta");
+
+	if ((NULL != p_delta) &&
+		(true == cJSON_IsString(cJSON_GetObjectItem(p_delta, "base"))) &&
+		(true == cJSON_IsString(cJSON_GetObjectItem(p_delta, "url"))) &&
+		(ESP_OK == esp_partition_get_sha256(p_running, sha256)))
+	{
+		for (size_t idx = 0; idx < sizeof(sha256); ++idx)
+		{
+			sprintf(running_sha + 2 * idx, "%02x", sha256[idx]);
+		}
+
+		if (0 == strcasecmp(running_sha,
+							cJSON_GetObjectItem(p_delta, "base")->valuestring))
+		{
+			p_image_url = cJSON_GetObjectItem(p_delta, "url")->valuestring;
+		}
+	}
+
+	strlcpy(p_url, p_image_url, OTA_APP_PULL_URL_SIZE);
+	strlcpy(p_version, cJSON_GetObjectItem(p_root, "version")->valuestring,
+			OTA_APP_PULL_VERSION_SIZE);
+	cJSON_Delete(p_root);
+
+	return ESP_OK;
+}
+
+static esp_err_t
+ota_app_pull_download (const char * p_url, const uint8_t * p_sha256)
+{
+	static const uint8_t zero_sha256[32] = {0};
+	esp_http_client_handle_t h_client = ota_app_pull_client(p_url);
+	ota_app_result_t result = {0};
+	uint32_t offset = 0;
+	uint32_t failures = 0;
+	esp_err_t err = ESP_OK;
+
+	if (NULL == h_client)
+	{
+		return ESP_ERR_NO_MEM;
+	}
+
+	// Busy with an upload from the browser
+	//
+	err = ota_app_begin();
+
+	if (ESP_OK != err)
+	{
+		esp_http_client_cleanup(h_client);
+
+		return err;
+	}
+
+	// Checked against the hash computed while writing
+	//
+	if (0 != memcmp(p_sha256, zero_sha256, sizeof(zero_sha256)))
+	{
+		ota_app_set_expected_sha256(p_sha256);
+	}
+
+	g_range_total = 0;
+
+	while ((0 == g_range_total) || (offset < g_range_total))
+	{
+		uint32_t offset_before = offset;
+
+		err = ota_app_pull_chunk(h_client, &offset);
+		ota_app_get_result(&result);
+
+		// The image itself is wrong, asking again does not help
+		//
+		if (ESP_OK != result.err)
+		{
+			err = result.err;
+			break;
+		}
+
+		if (ESP_OK == err)
+		{
+			failures = 0;
+			continue;
+		}
+
+		failures = (offset > offset_before) ? 1 : failures + 1;
+
+		if (failures > CONFIG_OTA_APP_PULL_RETRIES)
+		{
+			break;
+		}
+
+		// Interrupted, the next request resumes from offset
+		//
+		ESP_LOGW(g_tag, "ota_app_pull_download: %s at %u of %lld, retry %u",
+				 esp_err_to_name(err), offset, g_range_total, failures);
+		vTaskDelay((MIN(1u << failures, OTA_APP_PULL_BACKOFF_MAX_S) * 1000) /
+				   portTICK_PERIOD_MS);
+		err = ESP_OK;
+	}
+
+	esp_http_client_cleanup(h_client);
+
+	if (ESP_OK != err)
+	{
+		ota_app_abort();
+
+		return err;
+	}
+
+	return ota_app_end();
+}
+
+static esp_err_t
+ota_app_pull_chunk (esp_http_client_handle_t h_client, uint32_t * p_offset)
+{
+	char range[48] = {0};
+	uint32_t skip = 0;
+	int status = 0;
+	int len = 0;
+	esp_err_t err = ESP_OK;
+
+	snprintf(range, sizeof(range), "bytes=%u-%u", *p_offset,
+			 *p_offset + CONFIG_OTA_APP_PULL_CHUNK_SIZE - 1);
+	esp_http_client_set_header(h_client, "Range", range);
+
+	err = esp_http_client_open(h_client, 0);
+
+	if (ESP_OK != err)
+	{
+		return err;
+	}
+
+	if (esp_http_client_fetch_headers(h_client) < 0)
+	{
+		esp_http_client_close(h_client);
+
+		return ESP_FAIL;
+	}
+
+	status = esp_http_client_get_status_code(h_client);
+
+	if (200 == status)
+	{
+		// Range not supported: the whole image again, the part already
+		// written is read and dropped
+		//
+		g_range_total = esp_http_client_get_content_length(h_client);
+		skip = *p_offset;
+
+		if (g_range_total <= 0)
+		{
+			ESP_LOGE(g_tag, "ota_app_pull_chunk: no Range support and no length");
+			esp_http_client_close(h_client);
+
+			return ESP_ERR_NOT_SUPPORTED;
+		}
+	}
+	else if ((206 != status) || (0 == g_range_total))
+	{
+		ESP_LOGE(g_tag, "ota_app_pull_chunk: HTTP %d for %s", status, range);
+		esp_http_client_close(h_client);
+
+		return ESP_ERR_INVALID_RESPONSE;
+	}
+
+	ota_app_set_total((uint32_t) g_range_total);
+
+	while ((len = esp_http_client_read(h_client, g_buff, sizeof(g_buff))) > 0)
+	{
+		uint32_t used = MIN(skip, (uint32_t) len);
+
+		skip -= used;
+
+		if ((uint32_t) len > used)
+		{
+			err = ota_app_write(g_buff + used, len - used);
+
+			if (ESP_OK != err)
+			{
+				break;
+			}
+
+			*p_offset += len - used;
+		}
+	}
+
+	// A short answer is an interrupted transfer
+	//
+	if ((ESP_OK == err) &&
+		((len < 0) || (false == esp_http_client_is_complete_data_received(h_client))))
+	{
+		err = ESP_ERR_INVALID_SIZE;
+	}
+
+	esp_http_client_close(h_client);
+
+	return err;
+}
+#endif
@@ -0,0 +1,92 @@
+/*
+ * rgb_led.h
+ *
+ *  Created on: 4 apr 2023
+ *      Author: Filippo
+ */
+
+#ifndef COMPONENTS_RGB_LED_H
+#	define COMPONENTS_RGB_LED_H
+
+#	include <stdint.h>
+
+// LED gpios
+//
+#	define RGB_LED_RED_GPIO			25
+#	define RGB_LED_GREEN_GPIO		26
+#	define RGB_LED_BLUE_GPIO		27
+
+// Color mix channels
+//
+#	define RGB_LED_CHANNEL_NUM		3
+
+typedef struct
+{
+	int32_t channel;
+	int32_t gpio;
+	int32_t mode;
+	int32_t timer_index;
+} ledc_info_t;
+
+typedef enum rgb_led_mode
+{
+	RGB_LED_MODE_OFF = 0,
+	RGB_LED_MODE_SOLID,
+	RGB_LED_MODE_BLINK,
+	RGB_LED_MODE_BREATHE,
+	RGB_LED_MODE_CODE			// count flashes, then a pause
+} rgb_led_mode_t;
+
+typedef struct rgb_led_pattern
+{
+	uint8_t mode;				// rgb_led_mode_t
+	uint8_t red;
+	uint8_t green;
+	uint8_t blue;
+	uint16_t on_ms;				// Lit time, fade in time when breathing
+	uint16_t off_ms;			// Dark time, fade out time when breathing
+	uint16_t pause_ms;			// Code: dark time after the flashes
+	uint8_t count;				// Code: flashes per group
+} rgb_led_pattern_t;
+
+// Stacked patterns, the highest layer that has one is shown
+//
+typedef enum rgb_led_layer
+{
+	RGB_LED_LAYER_NETWORK = 0,
+	RGB_LED_LAYER_OTA,
+	RGB_LED_LAYER_ERROR,
+	RGB_LED_LAYER_MAX
+} rgb_led_layer_t;
+
+// System events, each one sets the pattern of a layer
+//
+typedef enum rgb_led_status
+{
+	RGB_LED_STATUS_WIFI_APP_STARTED = 0,
+	RGB_LED_STATUS_HTTP_SERVER_STARTED,
+	RGB_LED_STATUS_WIFI_CONNECTED,
+	RGB_LED_STATUS_WIFI_DISCONNECTED,
+	RGB_LED_STATUS_OTA_STARTED,
+	RGB_LED_STATUS_OTA_DONE,
+	RGB_LED_STATUS_OTA_FAILED,
+	RGB_LED_STATUS_MAX
+} rgb_led_status_t;
+
+// Configures the LEDC channels and their hardware fades, and starts the
+// LED task. Until then the other calls do nothing.
+//
+void rgb_led_init(void);
+
+// Shows the pattern of a system event
+//
+void rgb_led_status(rgb_led_status_t status);
+
+// Sets or clears the pattern of a layer and returns at once, the LED
+// task changes the pattern. The LEDC fades render every pattern, the LED
+// task only runs once per blink or fade segment.
+//
+void rgb_led_show(rgb_led_layer_t layer, const rgb_led_pattern_t * p_pattern);
+void rgb_led_clear(rgb_led_layer_t layer);
+
+#endif /* COMPONENTS_RGB_LED_H */
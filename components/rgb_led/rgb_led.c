@@ -0,0 +1,397 @@
+/*
+ * rgb_led.c
+ *
+ *  Created on: 4 apr 2023
+ *      Author: Filippo
+ */
+
+#include "rgb_led.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include "sys/param.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "driver/ledc.h"
+#include "esp_idf_version.h"
+#include "tasks_common.h"
+#include "task_plan.h"
+#include "app_static.h"
+
+// 13 bit at 5 kHz: no visible flicker and smooth low levels
+//
+#define RGB_LED_FREQ_HZ				5000
+#define RGB_LED_DUTY_RESOLUTION		LEDC_TIMER_13_BIT
+#define RGB_LED_DUTY_MAX			((1 << 13) - 1)
+
+// Fade between two solid patterns
+//
+#define RGB_LED_TRANSITION_MS		150
+
+#define RGB_LED_LAYER_BIT(layer)	(1 << (layer))
+
+typedef struct rgb_led_layer_state
+{
+	bool b_active;
+	rgb_led_pattern_t pattern;
+} rgb_led_layer_state_t;
+
+typedef struct rgb_led_status_map
+{
+	uint8_t layer;				// rgb_led_layer_t
+	uint8_t clear_mask;			// Layers cleared by the event
+	rgb_led_pattern_t pattern;
+} rgb_led_status_map_t;
+
+static const rgb_led_status_map_t g_status_map[RGB_LED_STATUS_MAX] = {
+	[RGB_LED_STATUS_WIFI_APP_STARTED] = {
+		RGB_LED_LAYER_NETWORK, 0,
+		{ RGB_LED_MODE_SOLID, 255, 102, 255 }
+	},
+	[RGB_LED_STATUS_HTTP_SERVER_STARTED] = {
+		RGB_LED_LAYER_NETWORK, 0,
+		{ RGB_LED_MODE_SOLID, 204, 255, 51 }
+	},
+	[RGB_LED_STATUS_WIFI_CONNECTED] = {
+		RGB_LED_LAYER_NETWORK, 0,
+		{ RGB_LED_MODE_SOLID, 0, 255, 153 }
+	},
+	// Access point only, the server keeps running
+	//
+	[RGB_LED_STATUS_WIFI_DISCONNECTED] = {
+		RGB_LED_LAYER_NETWORK, 0,
+		{ RGB_LED_MODE_BREATHE, 204, 255, 51, 1500, 1500 }
+	},
+	[RGB_LED_STATUS_OTA_STARTED] = {
+		RGB_LED_LAYER_OTA, RGB_LED_LAYER_BIT(RGB_LED_LAYER_ERROR),
+		{ RGB_LED_MODE_BREATHE, 0, 0, 255, 400, 400 }
+	},
+	[RGB_LED_STATUS_OTA_DONE] = {
+		RGB_LED_LAYER_OTA, 0,
+		{ RGB_LED_MODE_SOLID, 0, 255, 0 }
+	},
+	// Three red flashes until the next update starts
+	//
+	[RGB_LED_STATUS_OTA_FAILED] = {
+		RGB_LED_LAYER_ERROR, RGB_LED_LAYER_BIT(RGB_LED_LAYER_OTA),
+		{ RGB_LED_MODE_CODE, 255, 0, 0, 200, 200, 1500, 3 }
+	}
+};
+
+static ledc_info_t g_ledc_ch[RGB_LED_CHANNEL_NUM] = {0};
+
+// Layers under g_led_lock. Only the LED task touches the LEDC, the
+// running pattern and its segment.
+//
+static portMUX_TYPE g_led_lock = portMUX_INITIALIZER_UNLOCKED;
+static rgb_led_layer_state_t g_layers[RGB_LED_LAYER_MAX] = {0};
+static TaskHandle_t gh_led_task = NULL;
+static rgb_led_pattern_t g_shown = {0};
+static uint8_t g_step = 0;
+
+static void rgb_led_pwm_init(void);
+static void task_rgb_led(void * p_param);
+static rgb_led_pattern_t rgb_led_top(void);
+static uint32_t rgb_led_run_step(void);
+static void rgb_led_set_color(uint8_t red, uint8_t green, uint8_t blue,
+							  uint32_t fade_ms);
+
+void
+rgb_led_init (void)
+{
+	if (NULL != gh_led_task)
+	{
+		return;
+	}
+
+	rgb_led_pwm_init();
+
+	gh_led_task = APP_TASK_CREATE_PINNED(task_rgb_led,
+										 "rgb_led",
+										 RGB_LED_TASK_STACK_SIZE,
+										 NULL,
+										 task_plan_get(TASK_PLAN_RGB_LED)->priority,
+										 task_plan_get(TASK_PLAN_RGB_LED)->core_id);
+}
+
+void
+rgb_led_status (rgb_led_status_t status)
+{
+	const rgb_led_status_map_t * p_map = NULL;
+
+	if ((status >= RGB_LED_STATUS_MAX) || (NULL == gh_led_task))
+	{
+		return;
+	}
+
+	p_map = &g_status_map[status];
+
+	taskENTER_CRITICAL(&g_led_lock);
+
+	for (uint8_t layer = 0; layer < RGB_LED_LAYER_MAX; ++layer)
+	{
+		if (0 != (p_map->clear_mask & RGB_LED_LAYER_BIT(layer)))
+		{
+			g_layers[layer].b_active = false;
+		}
+	}
+
+	g_layers[p_map->layer].b_active = true;
+	g_layers[p_map->layer].pattern = p_map->pattern;
+
+	taskEXIT_CRITICAL(&g_led_lock);
+	xTaskNotifyGive(gh_led_task);
+}
+
+void
+rgb_led_show (rgb_led_layer_t layer, const rgb_led_pattern_t * p_pattern)
+{
+	if ((layer >= RGB_LED_LAYER_MAX) || (NULL == p_pattern) ||
+		(NULL == gh_led_task))
+	{
+		return;
+	}
+
+	taskENTER_CRITICAL(&g_led_lock);
+	g_layers[layer].b_active = true;
+	g_layers[layer].pattern = *p_pattern;
+	taskEXIT_CRITICAL(&g_led_lock);
+
+	xTaskNotifyGive(gh_led_task);
+}
+
+void
+rgb_led_clear (rgb_led_layer_t layer)
+{
+	if ((layer >= RGB_LED_LAYER_MAX) || (NULL == gh_led_task))
+	{
+		return;
+	}
+
+	taskENTER_CRITICAL(&g_led_lock);
+	g_layers[layer].b_active = false;
+	taskEXIT_CRITICAL(&g_led_lock);
+
+	xTaskNotifyGive(gh_led_task);
+}
+
+static void
+rgb_led_pwm_init (void)
+{
+	int32_t rgb_ch = 0;
+
+	g_ledc_ch[0].channel = 		LEDC_CHANNEL_0;
+	g_ledc_ch[0].gpio = 		RGB_LED_RED_GPIO;
+	g_ledc_ch[0].mode = 		LEDC_HIGH_SPEED_MODE;
+	g_ledc_ch[0].timer_index = 	LEDC_TIMER_0;
+
+	g_ledc_ch[1].channel = 		LEDC_CHANNEL_1;
+	g_ledc_ch[1].gpio = 		RGB_LED_GREEN_GPIO;
+	g_ledc_ch[1].mode = 		LEDC_HIGH_SPEED_MODE;
+	g_ledc_ch[1].timer_index = 	LEDC_TIMER_0;
+
+	g_ledc_ch[2].channel = 		LEDC_CHANNEL_2;
+	g_ledc_ch[2].gpio = 		RGB_LED_BLUE_GPIO;
+	g_ledc_ch[2].mode = 		LEDC_HIGH_SPEED_MODE;
+	g_ledc_ch[2].timer_index = 	LEDC_TIMER_0;
+
+	// Configure timer zero
+	//
+	ledc_timer_config_t ledc_timer =
+	{
+		.duty_resolution =	RGB_LED_DUTY_RESOLUTION,
+		.freq_hz = 			RGB_LED_FREQ_HZ,
+		.speed_mode =		LEDC_HIGH_SPEED_MODE,
+		.timer_num = 		LEDC_TIMER_0
+	};
+
+	ledc_timer_config(&ledc_timer);
+
+	// Configure channels
+	//
+	for (rgb_ch = 0; rgb_ch < RGB_LED_CHANNEL_NUM; ++rgb_ch)
+	{
+		ledc_channel_config_t ledc_channel =
+		{
+			.channel =		g_ledc_ch[rgb_ch].channel,
+			.duty = 		0,
+			.hpoint =		0,
+			.gpio_num = 	g_ledc_ch[rgb_ch].gpio,
+			.intr_type =	LEDC_INTR_DISABLE,
+			.speed_mode =	g_ledc_ch[rgb_ch].mode,
+			.timer_sel = 	g_ledc_ch[rgb_ch].timer_index
+		};
+
+		ledc_channel_config(&ledc_channel);
+	}
+
+	// The fade engine only interrupts at the end of a fade
+	//
+	ledc_fade_func_install(0);
+}
+
+// Runs the shown pattern. A layer change only notifies this task, so
+// the callers never wait on the LEDC: on IDF 4.4 a new fade waits for
+// the one running on the channel, up to a whole breathe segment.
+//
+static void
+task_rgb_led (void * p_param)
+{
+	TickType_t deadline = 0;
+	bool b_timed = false;
+	uint32_t hold_ms = 0;
+
+	for (;;)
+	{
+		TickType_t wait = portMAX_DELAY;
+
+		if (true == b_timed)
+		{
+			TickType_t left = deadline - xTaskGetTickCount();
+
+			wait = ((int32_t) left > 0) ? left : 0;
+		}
+
+		if (0 != ulTaskNotifyTake(pdTRUE, wait))
+		{
+			rgb_led_pattern_t top = rgb_led_top();
+
+			// The running pattern goes on undisturbed when it is still
+			// the one on top
+			//
+			if (0 == memcmp(&top, &g_shown, sizeof(top)))
+			{
+				continue;
+			}
+
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
+			// The new pattern starts now, not when the running fade ends
+			//
+			for (int32_t rgb_ch = 0; rgb_ch < RGB_LED_CHANNEL_NUM; ++rgb_ch)
+			{
+				ledc_fade_stop(g_ledc_ch[rgb_ch].mode, g_ledc_ch[rgb_ch].channel);
+			}
+#endif
+
+			g_shown = top;
+			g_step = 0;
+		}
+		else
+		{
+			// A code pattern has 2 * count segments, the others 2
+			//
+			g_step++;
+
+			if (g_step >= ((RGB_LED_MODE_CODE == g_shown.mode) ?
+						   (2 * MAX(g_shown.count, 1)) : 2))
+			{
+				g_step = 0;
+			}
+		}
+
+		hold_ms = rgb_led_run_step();
+		b_timed = (hold_ms > 0);
+		deadline = xTaskGetTickCount() + pdMS_TO_TICKS(hold_ms);
+	}
+}
+
+// Pattern of the highest active layer, off when there is none
+//
+static rgb_led_pattern_t
+rgb_led_top (void)
+{
+	rgb_led_pattern_t top = {0};
+
+	taskENTER_CRITICAL(&g_led_lock);
+
+	for (int8_t layer = RGB_LED_LAYER_MAX - 1; layer >= 0; --layer)
+	{
+		if (true == g_layers[layer].b_active)
+		{
+			top = g_layers[layer].pattern;
+			break;
+		}
+	}
+
+	taskEXIT_CRITICAL(&g_led_lock);
+
+	return top;
+}
+
+// Starts the current segment of the shown pattern, returns how long it
+// lasts (0 for a pattern that does not change)
+//
+static uint32_t
+rgb_led_run_step (void)
+{
+	const rgb_led_pattern_t * p_pat = &g_shown;
+	bool b_lit = (0 == (g_step & 1));
+	uint32_t fade_ms = 0;
+	uint32_t hold_ms = 0;
+
+	switch (p_pat->mode)
+	{
+		case RGB_LED_MODE_SOLID:
+			rgb_led_set_color(p_pat->red, p_pat->green, p_pat->blue,
+							  RGB_LED_TRANSITION_MS);
+		return 0;
+
+		case RGB_LED_MODE_BLINK:
+			hold_ms = (true == b_lit) ? p_pat->on_ms : p_pat->off_ms;
+		break;
+
+		case RGB_LED_MODE_BREATHE:
+			fade_ms = (true == b_lit) ? p_pat->on_ms : p_pat->off_ms;
+			hold_ms = fade_ms;
+		break;
+
+		case RGB_LED_MODE_CODE:
+			hold_ms = (true == b_lit) ? p_pat->on_ms :
+					  ((g_step + 1 >= 2 * p_pat->count) ? p_pat->pause_ms : p_pat->off_ms);
+		break;
+
+		default:
+			rgb_led_set_color(0, 0, 0, RGB_LED_TRANSITION_MS);
+		return 0;
+	}
+
+	if (true == b_lit)
+	{
+		rgb_led_set_color(p_pat->red, p_pat->green, p_pat->blue, fade_ms);
+	}
+	else
+	{
+		rgb_led_set_color(0, 0, 0, fade_ms);
+	}
+
+	return hold_ms;
+}
+
+static void
+rgb_led_set_color (uint8_t red, uint8_t green, uint8_t blue, uint32_t fade_ms)
+{
+	const uint8_t color[RGB_LED_CHANNEL_NUM] = {red, green, blue};
+
+	for (int32_t rgb_ch = 0; rgb_ch < RGB_LED_CHANNEL_NUM; ++rgb_ch)
+	{
+		// Squared levels look evenly spaced to the eye
+		//
+		uint32_t duty = ((uint32_t) color[rgb_ch] * color[rgb_ch] *
+						 RGB_LED_DUTY_MAX) / (255 * 255);
+
+		// The thread safe fade calls wait for a fade still running on
+		// the channel, only the LED task makes them
+		//
+		if (0 == fade_ms)
+		{
+			ledc_set_duty_and_update(g_ledc_ch[rgb_ch].mode,
+									 g_ledc_ch[rgb_ch].channel, duty, 0);
+		}
+		else
+		{
+			ledc_set_fade_time_and_start(g_ledc_ch[rgb_ch].mode,
+										 g_ledc_ch[rgb_ch].channel, duty,
+										 fade_ms, LEDC_FADE_NO_WAIT);
+		}
+	}
+}
@@ -0,0 +1,115 @@
+/*
+ * sensor.h
+ *
+ *  Created on: 19 oct 2026
+ *      Author: Filippo
+ */
+
+#ifndef COMPONENTS_SENSOR_H_
+#	define COMPONENTS_SENSOR_H_
+
+#	include <stdbool.h>
+#	include <stdint.h>
+#	include "esp_err.h"
+
+// Any sensor that provides the requested quantity
+//
+#	define SENSOR_ID_ANY				0xFF
+
+// Measured physical quantities
+//
+typedef enum sensor_quantity
+{
+	SENSOR_QUANTITY_TEMPERATURE = 0,
+	SENSOR_QUANTITY_HUMIDITY,
+	SENSOR_QUANTITY_PRESSURE,
+	SENSOR_QUANTITY_GAS_RESISTANCE,
+	SENSOR_QUANTITY_MAX
+} sensor_quantity_t;
+
+// Units of sample values
+//
+typedef enum sensor_unit
+{
+	SENSOR_UNIT_CELSIUS = 0,
+	SENSOR_UNIT_PERCENT_RH,
+	SENSOR_UNIT_PASCAL,
+	SENSOR_UNIT_OHM
+} sensor_unit_t;
+
+// Common sample produced by every driver
+//
+typedef struct sensor_sample
+{
+	int64_t timestamp_us;		// esp_timer time of the read back
+	float value;
+	uint16_t boot;				// Boot of timestamp_us, see sensor_time.h
+	uint8_t sensor_id;
+	uint8_t quantity;			// sensor_quantity_t
+	uint8_t unit;				// sensor_unit_t
+	uint8_t tag;				// Driver specific, e.g. BME680 heater profile
+} sensor_sample_t;
+
+// Driver interface. Every call runs in the sensor task, so a driver never
+// needs its own task or lock. trigger() tells the scheduler how long the
+// conversion takes, read() is called once that time has elapsed.
+//
+typedef struct sensor_driver
+{
+	const char * p_name;
+
+	// Configures the device
+	//
+	esp_err_t (*init)(void * p_ctx);
+
+	// Starts a conversion, *p_ready_us is the time until read() can be called
+	//
+	esp_err_t (*trigger)(void * p_ctx, uint32_t * p_ready_us);
+
+	// Fetches the raw result, ESP_ERR_NOT_FINISHED to be polled again later
+	//
+	esp_err_t (*read)(void * p_ctx);
+
+	// Converts the raw result into samples, returns the number of samples
+	//
+	int32_t (*decode)(void * p_ctx, sensor_sample_t * p_samples,
+					  int32_t max_samples);
+} sensor_driver_t;
+
+// Called in the sensor task for every new sample
+//
+typedef void (*sensor_sample_cb_t)(const sensor_sample_t * p_sample,
+								   void * p_arg);
+
+// Adds a sensor to the scheduler, must be called before sensor_task_start()
+//
+esp_err_t sensor_register(const sensor_driver_t * p_driver, void * p_ctx,
+						  uint32_t period_ms, uint8_t * p_id);
+
+// Initializes the registered drivers and starts the scheduler
+//
+void sensor_task_start(void);
+
+// Registers a callback for new samples
+//
+esp_err_t sensor_subscribe(sensor_sample_cb_t cb, void * p_arg);
+
+// Gets the newest filtered sample of a quantity, false if none yet
+//
+bool sensor_get_latest(uint8_t sensor_id, sensor_quantity_t quantity,
+					   sensor_sample_t * p_sample);
+
+// Gets the newest filtered value of a quantity, 0 if none yet
+//
+float sensor_get_latest_value(sensor_quantity_t quantity);
+
+// Unit of a quantity
+//
+sensor_unit_t sensor_quantity_unit(sensor_quantity_t quantity);
+
+// Printable names
+//
+const char * sensor_quantity_name(sensor_quantity_t quantity);
+const char * sensor_unit_name(sensor_unit_t unit);
+
+#endif /* COMPONENTS_SENSOR_H_ */
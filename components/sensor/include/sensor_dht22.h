@@ -0,0 +1,23 @@
+/*
+ * sensor_dht22.h
+ *
+ *  Created on: 19 oct 2026
+ *      Author: Filippo
+ */
+
+#ifndef COMPONENTS_SENSOR_DHT22_H_
+#	define COMPONENTS_SENSOR_DHT22_H_
+
+#	include <stdint.h>
+#	include "esp_err.h"
+
+// The interval of whole process must be beyond 2 seconds
+//
+#	define SENSOR_DHT22_MIN_PERIOD_MS	2000
+
+// Adds a DHT22 on the given GPIO to the sensor scheduler
+//
+esp_err_t sensor_dht22_register(int32_t gpio, uint32_t period_ms,
+								uint8_t * p_id);
+
+#endif /* COMPONENTS_SENSOR_DHT22_H_ */
@@ -0,0 +1,36 @@
+/*
+ * sensor_history.h
+ *
+ *  Created on: 19 oct 2026
+ *      Author: Filippo
+ */
+
+#ifndef COMPONENTS_SENSOR_HISTORY_H_
+#	define COMPONENTS_SENSOR_HISTORY_H_
+
+#	include <stdint.h>
+#	include "sensor.h"
+
+// Every pushed sample gets a sequence number. Readers keep their own
+// sequence, so several readers can walk the history at their own pace.
+//
+
+// Adds a sample, overwriting the oldest one when full
+//
+void sensor_history_push(const sensor_sample_t * p_sample);
+
+// Copies up to max_samples starting from *p_seq and advances *p_seq.
+// A sequence already overwritten restarts from the oldest sample kept.
+//
+int32_t sensor_history_read(uint32_t * p_seq, sensor_sample_t * p_samples,
+							int32_t max_samples);
+
+// Sequence of the oldest sample kept
+//
+uint32_t sensor_history_oldest_seq(void);
+
+// Sequence the next pushed sample will get
+//
+uint32_t sensor_history_next_seq(void);
+
+#endif /* COMPONENTS_SENSOR_HISTORY_H_ */
@@ -0,0 +1,59 @@
+/*
+ * sensor_log.h
+ *
+ *  Created on: 19 oct 2026
+ *      Author: Filippo
+ */
+
+#ifndef COMPONENTS_SENSOR_LOG_H_
+#	define COMPONENTS_SENSOR_LOG_H_
+
+#	include <stdint.h>
+#	include "esp_err.h"
+#	include "sensor.h"
+
+// Samples of the current boot, for sensor_log_query()
+//
+#	define SENSOR_LOG_BOOT_CURRENT		0xFFFF
+
+typedef struct sensor_log_stats
+{
+	uint32_t sectors;
+	uint32_t blocks_written;
+	uint32_t samples;			// Written to flash since boot
+	uint32_t payload_bytes;		// Their encoded size
+	uint32_t erase_min;			// Erase counts over the partition
+	uint32_t erase_max;
+	uint32_t query_ms;			// Duration of the last query
+	uint32_t query_samples;
+	uint16_t boot;
+} sensor_log_stats_t;
+
+// Called for every sample a query finds, in time order. Returning an
+// error stops the query.
+//
+typedef esp_err_t (*sensor_log_query_cb_t)(const sensor_sample_t * p_sample,
+										   void * p_arg);
+
+// Mounts the log partition and rebuilds the block index. Without the
+// partition the log stays disabled.
+//
+esp_err_t sensor_log_init(void);
+
+// Encodes a sample in the RAM block, written to flash when full
+//
+void sensor_log_append(const sensor_sample_t * p_sample);
+
+// Writes the RAM block now, e.g. before a restart
+//
+esp_err_t sensor_log_flush(void);
+
+// Samples of a boot with from_ms <= timestamp <= to_ms (time since boot),
+// the unwritten RAM block included for the current boot
+//
+esp_err_t sensor_log_query(uint16_t boot, int64_t from_ms, int64_t to_ms,
+						   sensor_log_query_cb_t cb, void * p_arg);
+
+void sensor_log_get_stats(sensor_log_stats_t * p_stats);
+
+#endif /* COMPONENTS_SENSOR_LOG_H_ */
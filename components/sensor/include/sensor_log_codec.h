@@ -0,0 +1,83 @@
+/*
+ * sensor_log_codec.h
+ *
+ *  Created on: 19 oct 2026
+ *      Author: Filippo
+ */
+
+#ifndef COMPONENTS_SENSOR_LOG_CODEC_H_
+#	define COMPONENTS_SENSOR_LOG_CODEC_H_
+
+#	include <stdbool.h>
+#	include <stddef.h>
+#	include <stdint.h>
+
+// Bit stream of one flash block, Gorilla style. Every series (sensor and
+// quantity) keeps its own state from the start of the block:
+//
+//   6 bits		series, sensor_id * 4 + quantity
+//   time		delta of delta of the ms timestamp, from the block base:
+//				'0' same delta, '10' + 7 bits, '110' + 9 bits,
+//				'1110' + 12 bits, '1111' + 32 bits (signed)
+//   tag		'0' same as the previous sample, '1' + 8 bits
+//   value		first of the series: 32 bits of the float. Then the XOR
+//				with the previous one: '0' same, '10' + the meaningful
+//				bits in the previous window, '11' + 5 bits of leading
+//				zeros + 5 bits of length - 1 + the meaningful bits
+//
+// No ESP-IDF dependency, the host benchmark in tools/ builds it too.
+//
+#	define SENSOR_LOG_CODEC_SENSORS		16
+#	define SENSOR_LOG_CODEC_QUANTITIES	4
+#	define SENSOR_LOG_CODEC_SERIES		(SENSOR_LOG_CODEC_SENSORS * SENSOR_LOG_CODEC_QUANTITIES)
+
+typedef struct sensor_log_record
+{
+	int64_t timestamp_ms;
+	float value;
+	uint8_t sensor_id;
+	uint8_t quantity;
+	uint8_t tag;
+} sensor_log_record_t;
+
+typedef struct sensor_log_series
+{
+	int64_t prev_ms;
+	int64_t prev_delta;
+	uint32_t prev_bits;
+	uint8_t leading;
+	uint8_t trailing;
+	uint8_t prev_tag;
+	bool b_started;
+} sensor_log_series_t;
+
+typedef struct sensor_log_codec
+{
+	uint8_t * p_buf;
+	uint32_t size_bits;
+	uint32_t pos_bits;
+	int64_t base_ms;
+	sensor_log_series_t series[SENSOR_LOG_CODEC_SERIES];
+} sensor_log_codec_t;
+
+// Starts encoding into, or decoding from, a buffer. Encoding needs the
+// buffer zeroed.
+//
+void sensor_log_codec_init(sensor_log_codec_t * p_codec, uint8_t * p_buf,
+						   size_t size, int64_t base_ms);
+
+// Appends a record, false when it does not fit: the codec is unchanged
+//
+bool sensor_log_codec_put(sensor_log_codec_t * p_codec,
+						  const sensor_log_record_t * p_record);
+
+// Reads the next record, false at the end of the buffer or on bad data
+//
+bool sensor_log_codec_get(sensor_log_codec_t * p_codec,
+						  sensor_log_record_t * p_record);
+
+// Bytes used so far
+//
+size_t sensor_log_codec_bytes(const sensor_log_codec_t * p_codec);
+
+#endif /* COMPONENTS_SENSOR_LOG_CODEC_H_ */
@@ -0,0 +1,51 @@
+/*
+ * sensor_time.h
+ *
+ *  Created on: 19 oct 2026
+ *      Author: Filippo
+ */
+
+#ifndef COMPONENTS_SENSOR_TIME_H_
+#	define COMPONENTS_SENSOR_TIME_H_
+
+#	include <stdbool.h>
+#	include <stddef.h>
+#	include <stdint.h>
+
+// Samples keep the esp_timer time of their boot and the boot ID, they
+// are never rewritten. The first SNTP sync of a boot records the offset
+// from that boot's clock to UTC, so samples taken before the sync are
+// placed in time when they are published or exported:
+//
+//   utc_ms = timestamp_us / 1000 + offset_ms
+//
+
+// Reads the boot ID (the flash log boot, or an NVS counter without the
+// log) and subscribes to the SNTP syncs. Called by sensor_task_start(),
+// with NVS initialised: both keep the last ID given there, so a boot
+// that never wrote a log block does not pass its ID on.
+//
+void sensor_time_init(void);
+
+uint16_t sensor_time_boot_id(void);
+
+// Offset from the clock of a boot to UTC, false if that boot never
+// synced or is too old
+//
+bool sensor_time_utc_offset_ms(uint16_t boot, int64_t * p_offset_ms);
+
+// JSON object with the newest temperature and humidity, their boot,
+// time since boot and UTC time (null before the first sync). Returns
+// the length, 0 if the buffer is too small.
+//
+size_t sensor_time_format_latest_json(char * p_buf, size_t size);
+
+// The SNTP callback runs on the LwIP task, a flash write there would
+// stall the network: it only records the offset and asks the sensor
+// task, which calls sensor_time_save(), to write it to NVS. The post
+// is in sensor.c and never blocks.
+//
+bool sensor_post_time_save(void);
+void sensor_time_save(void);
+
+#endif /* COMPONENTS_SENSOR_TIME_H_ */
@@ -0,0 +1,481 @@
+/*
+ * sensor.c
+ *
+ *  Created on: 19 oct 2026
+ *      Author: Filippo
+ */
+
+#include "sensor.h"
+#include <math.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+#include "sdkconfig.h"
+#include "sensor_history.h"
+#include "sensor_log.h"
+#include "sensor_time.h"
+#include "metrics.h"
+#include "task_plan.h"
+#include "app_static.h"
+
+// Poll interval when a conversion is not over at the expected time
+//
+#define SENSOR_BUSY_RETRY_US		5000
+
+// Samples a single read can produce
+//
+#define SENSOR_MAX_SAMPLES_PER_READ	SENSOR_QUANTITY_MAX
+
+// Tags with their own filter history, as many as the longest BME680
+// heater sequence. Samples with a higher tag are not filtered.
+//
+#define SENSOR_FILTER_TAGS			5
+
+static const char g_tag[] = "sensor";
+
+// Events posted by the timers to the sensor task
+//
+typedef enum sensor_event
+{
+	SENSOR_EVENT_TRIGGER = 0,
+	SENSOR_EVENT_READY,
+	SENSOR_EVENT_TIME_SAVE				// Not a sensor, sensor_time NVS write
+} sensor_event_t;
+
+typedef struct sensor_queue_message
+{
+	uint8_t sensor_id;
+	uint8_t event;
+} sensor_queue_message_t;
+
+typedef struct sensor_slot
+{
+	const sensor_driver_t * p_driver;
+	void * p_ctx;
+	uint32_t period_ms;
+	esp_timer_handle_t h_period;
+	esp_timer_handle_t h_ready;
+	bool b_ready;
+	bool b_converting;
+	uint32_t missed;
+	uint32_t errors;
+
+	// Last raw values, for the median of three spike filter. A value only
+	// compares with the ones of the same tag: gas resistances at another
+	// heater temperature are another measurement.
+	//
+	float raw[SENSOR_QUANTITY_MAX][SENSOR_FILTER_TAGS][2];
+	uint8_t raw_count[SENSOR_QUANTITY_MAX][SENSOR_FILTER_TAGS];
+
+	sensor_sample_t latest[SENSOR_QUANTITY_MAX];
+	bool b_latest_valid[SENSOR_QUANTITY_MAX];
+} sensor_slot_t;
+
+typedef struct sensor_subscriber
+{
+	sensor_sample_cb_t cb;
+	void * p_arg;
+} sensor_subscriber_t;
+
+static sensor_slot_t g_slots[CONFIG_SENSOR_MAX_SENSORS] = {0};
+static uint8_t g_slot_count = 0;
+static sensor_subscriber_t g_subscribers[CONFIG_SENSOR_MAX_SUBSCRIBERS] = {0};
+static uint8_t g_subscriber_count = 0;
+static QueueHandle_t gh_sensor_queue = NULL;
+static TaskHandle_t gh_task_sensor = NULL;
+
+// Protects the latest values read by other tasks
+//
+static portMUX_TYPE g_sensor_mux = portMUX_INITIALIZER_UNLOCKED;
+
+static const sensor_unit_t g_quantity_units[SENSOR_QUANTITY_MAX] = {
+	[SENSOR_QUANTITY_TEMPERATURE] = SENSOR_UNIT_CELSIUS,
+	[SENSOR_QUANTITY_HUMIDITY] = SENSOR_UNIT_PERCENT_RH,
+	[SENSOR_QUANTITY_PRESSURE] = SENSOR_UNIT_PASCAL,
+	[SENSOR_QUANTITY_GAS_RESISTANCE] = SENSOR_UNIT_OHM
+};
+
+static const char * const g_quantity_names[SENSOR_QUANTITY_MAX] = {
+	[SENSOR_QUANTITY_TEMPERATURE] = "temperature",
+	[SENSOR_QUANTITY_HUMIDITY] = "humidity",
+	[SENSOR_QUANTITY_PRESSURE] = "pressure",
+	[SENSOR_QUANTITY_GAS_RESISTANCE] = "gas_resistance"
+};
+
+static const char * const g_unit_names[] = {
+	[SENSOR_UNIT_CELSIUS] = "C",
+	[SENSOR_UNIT_PERCENT_RH] = "%RH",
+	[SENSOR_UNIT_PASCAL] = "Pa",
+	[SENSOR_UNIT_OHM] = "Ohm"
+};
+
+static void task_sensor(void * p_param);
+static void sensor_timer_callback(void * p_arg);
+static void sensor_trigger(uint8_t sensor_id);
+static void sensor_read(uint8_t sensor_id);
+static void sensor_process_sample(sensor_slot_t * p_slot,
+								  sensor_sample_t * p_sample);
+
+esp_err_t
+sensor_register (const sensor_driver_t * p_driver, void * p_ctx,
+				 uint32_t period_ms, uint8_t * p_id)
+{
+	if ((NULL == p_driver) || (0 == period_ms))
+	{
+		return ESP_ERR_INVALID_ARG;
+	}
+
+	if ((g_slot_count >= CONFIG_SENSOR_MAX_SENSORS) || (NULL != gh_task_sensor))
+	{
+		return ESP_ERR_NO_MEM;
+	}
+
+	sensor_slot_t * p_slot = &g_slots[g_slot_count];
+
+	memset(p_slot, 0, sizeof(sensor_slot_t));
+	p_slot->p_driver = p_driver;
+	p_slot->p_ctx = p_ctx;
+	p_slot->period_ms = period_ms;
+
+	if (NULL != p_id)
+	{
+		*p_id = g_slot_count;
+	}
+
+	++g_slot_count;
+
+	return ESP_OK;
+}
+
+void
+sensor_task_start (void)
+{
+	if (NULL != gh_task_sensor)
+	{
+		return;
+	}
+
+	// Each sensor has at most one trigger and one ready event in flight,
+	// plus one sensor_time save
+	//
+	gh_sensor_queue = APP_QUEUE_CREATE(2 * CONFIG_SENSOR_MAX_SENSORS + 1,
+									   sizeof(sensor_queue_message_t));
+	metrics_register_queue("sensor", gh_sensor_queue);
+
+	// Mounts the flash log too, its boot number is the boot ID. After the
+	// queue: a sync that already happened asks for a save at once.
+	//
+	sensor_time_init();
+
+	gh_task_sensor = APP_TASK_CREATE_PINNED(task_sensor, "sensor_task",
+											CONFIG_SENSOR_TASK_STACK_SIZE, NULL,
+											task_plan_get(TASK_PLAN_SENSOR)->priority,
+											task_plan_get(TASK_PLAN_SENSOR)->core_id);
+}
+
+esp_err_t
+sensor_subscribe (sensor_sample_cb_t cb, void * p_arg)
+{
+	if (NULL == cb)
+	{
+		return ESP_ERR_INVALID_ARG;
+	}
+
+	if (g_subscriber_count >= CONFIG_SENSOR_MAX_SUBSCRIBERS)
+	{
+		return ESP_ERR_NO_MEM;
+	}
+
+	g_subscribers[g_subscriber_count].cb = cb;
+	g_subscribers[g_subscriber_count].p_arg = p_arg;
+	++g_subscriber_count;
+
+	return ESP_OK;
+}
+
+bool
+sensor_get_latest (uint8_t sensor_id, sensor_quantity_t quantity,
+				   sensor_sample_t * p_sample)
+{
+	bool b_found = false;
+
+	if (quantity >= SENSOR_QUANTITY_MAX)
+	{
+		return false;
+	}
+
+	portENTER_CRITICAL(&g_sensor_mux);
+
+	for (uint8_t id = 0; (id < g_slot_count) && (false == b_found); ++id)
+	{
+		if (((SENSOR_ID_ANY == sensor_id) || (id == sensor_id)) &&
+			(true == g_slots[id].b_latest_valid[quantity]))
+		{
+			*p_sample = g_slots[id].latest[quantity];
+			b_found = true;
+		}
+	}
+
+	portEXIT_CRITICAL(&g_sensor_mux);
+
+	return b_found;
+}
+
+float
+sensor_get_latest_value (sensor_quantity_t quantity)
+{
+	sensor_sample_t sample = {0};
+
+	sensor_get_latest(SENSOR_ID_ANY, quantity, &sample);
+
+	return sample.value;
+}
+
+sensor_unit_t
+sensor_quantity_unit (sensor_quantity_t quantity)
+{
+	return g_quantity_units[quantity];
+}
+
+const char *
+sensor_quantity_name (sensor_quantity_t quantity)
+{
+	return (quantity < SENSOR_QUANTITY_MAX) ? g_quantity_names[quantity] : "unknown";
+}
+
+const char *
+sensor_unit_name (sensor_unit_t unit)
+{
+	return (unit <= SENSOR_UNIT_OHM) ? g_unit_names[unit] : "";
+}
+
+/**
+ * Runs in the esp_timer task, only posts the event.
+ */
+static void
+sensor_timer_callback (void * p_arg)
+{
+	sensor_queue_message_t msg = {0};
+	uint32_t packed = (uint32_t) p_arg;
+
+	msg.sensor_id = packed & 0xFF;
+	msg.event = packed >> 8;
+
+	// Never block the esp_timer task. A dropped trigger is a missed period,
+	// a dropped ready event would leave the conversion running for good:
+	// ask again.
+	//
+	if ((pdTRUE != xQueueSend(gh_sensor_queue, &msg, 0)) &&
+		(SENSOR_EVENT_READY == msg.event))
+	{
+		esp_timer_start_once(g_slots[msg.sensor_id].h_ready, SENSOR_BUSY_RETRY_US);
+	}
+}
+
+bool
+sensor_post_time_save (void)
+{
+	sensor_queue_message_t msg = {
+		.sensor_id = 0,
+		.event = SENSOR_EVENT_TIME_SAVE
+	};
+
+	return (NULL != gh_sensor_queue) &&
+		   (pdTRUE == xQueueSend(gh_sensor_queue, &msg, 0));
+}
+
+static void
+sensor_trigger (uint8_t sensor_id)
+{
+	sensor_slot_t * p_slot = &g_slots[sensor_id];
+	uint32_t ready_us = 0;
+
+	if (false == p_slot->b_ready)
+	{
+		return;
+	}
+
+	// Previous conversion still running: skip this period
+	//
+	if (true == p_slot->b_converting)
+	{
+		++p_slot->missed;
+		return;
+	}
+
+	if (ESP_OK != p_slot->p_driver->trigger(p_slot->p_ctx, &ready_us))
+	{
+		++p_slot->errors;
+		return;
+	}
+
+	p_slot->b_converting = true;
+
+	if (0 == ready_us)
+	{
+		sensor_read(sensor_id);
+	}
+	else
+	{
+		esp_timer_start_once(p_slot->h_ready, ready_us);
+	}
+}
+
+static void
+sensor_read (uint8_t sensor_id)
+{
+	sensor_slot_t * p_slot = &g_slots[sensor_id];
+	sensor_sample_t samples[SENSOR_MAX_SAMPLES_PER_READ];
+	esp_err_t err = p_slot->p_driver->read(p_slot->p_ctx);
+
+	if (ESP_ERR_NOT_FINISHED == err)
+	{
+		esp_timer_start_once(p_slot->h_ready, SENSOR_BUSY_RETRY_US);
+		return;
+	}
+
+	p_slot->b_converting = false;
+
+	if (ESP_OK != err)
+	{
+		++p_slot->errors;
+		return;
+	}
+
+	int64_t now = esp_timer_get_time();
+	int32_t count = p_slot->p_driver->decode(p_slot->p_ctx, samples,
+											 SENSOR_MAX_SAMPLES_PER_READ);
+
+	for (int32_t i = 0; i < count; ++i)
+	{
+		samples[i].timestamp_us = now;
+		samples[i].boot = sensor_time_boot_id();
+		samples[i].sensor_id = sensor_id;
+		samples[i].unit = g_quantity_units[samples[i].quantity];
+
+		sensor_process_sample(p_slot, &samples[i]);
+	}
+}
+
+/**
+ * Filters the sample and hands it to the history and the subscribers.
+ */
+static void
+sensor_process_sample (sensor_slot_t * p_slot, sensor_sample_t * p_sample)
+{
+	uint8_t quantity = p_sample->quantity;
+
+	if (quantity >= SENSOR_QUANTITY_MAX)
+	{
+		return;
+	}
+
+#if CONFIG_SENSOR_FILTER_MEDIAN
+	// Median of the last three raw values rejects single read spikes
+	//
+	if (p_sample->tag < SENSOR_FILTER_TAGS)
+	{
+		float * p_raw = p_slot->raw[quantity][p_sample->tag];
+		uint8_t * p_count = &p_slot->raw_count[quantity][p_sample->tag];
+		float raw = p_sample->value;
+
+		if (*p_count >= 2)
+		{
+			float a = p_raw[0];
+			float b = p_raw[1];
+			float c = raw;
+
+			p_sample->value = fmaxf(fminf(a, b), fminf(fmaxf(a, b), c));
+		}
+		else
+		{
+			++(*p_count);
+		}
+
+		p_raw[0] = p_raw[1];
+		p_raw[1] = raw;
+	}
+#endif
+
+	portENTER_CRITICAL(&g_sensor_mux);
+	p_slot->latest[quantity] = *p_sample;
+	p_slot->b_latest_valid[quantity] = true;
+	portEXIT_CRITICAL(&g_sensor_mux);
+
+	sensor_history_push(p_sample);
+#if CONFIG_SENSOR_LOG
+	sensor_log_append(p_sample);
+#endif
+
+	for (uint8_t i = 0; i < g_subscriber_count; ++i)
+	{
+		g_subscribers[i].cb(p_sample, g_subscribers[i].p_arg);
+	}
+}
+
+/**
+ * Sensor scheduler task: every bus transaction of every sensor runs here,
+ * timers only tell it when.
+ */
+static void
+task_sensor (void * p_param)
+{
+	sensor_queue_message_t msg = {0};
+
+	for (uint8_t id = 0; id < g_slot_count; ++id)
+	{
+		sensor_slot_t * p_slot = &g_slots[id];
+		esp_timer_create_args_t timer_args = {
+			.callback = sensor_timer_callback,
+			.dispatch_method = ESP_TIMER_TASK,
+			.name = "sensor"
+		};
+
+		if (ESP_OK != p_slot->p_driver->init(p_slot->p_ctx))
+		{
+			ESP_LOGE(g_tag, "%s (id %d) init failed", p_slot->p_driver->p_name, id);
+			continue;
+		}
+
+		timer_args.arg = (void *) (uint32_t) (id | (SENSOR_EVENT_TRIGGER << 8));
+		ESP_ERROR_CHECK(esp_timer_create(&timer_args, &p_slot->h_period));
+
+		timer_args.arg = (void *) (uint32_t) (id | (SENSOR_EVENT_READY << 8));
+		ESP_ERROR_CHECK(esp_timer_create(&timer_args, &p_slot->h_ready));
+
+		p_slot->b_ready = true;
+
+		ESP_ERROR_CHECK(esp_timer_start_periodic(p_slot->h_period,
+												 p_slot->period_ms * 1000ULL));
+
+		ESP_LOGI(g_tag, "%s (id %d) every %d ms", p_slot->p_driver->p_name,
+				 id, p_slot->period_ms);
+	}
+
+	for (;;)
+	{
+		if (pdTRUE == xQueueReceive(gh_sensor_queue, &msg, portMAX_DELAY))
+		{
+			switch (msg.event)
+			{
+				case SENSOR_EVENT_TRIGGER:
+					sensor_trigger(msg.sensor_id);
+				break;
+
+				case SENSOR_EVENT_READY:
+					sensor_read(msg.sensor_id);
+				break;
+
+				case SENSOR_EVENT_TIME_SAVE:
+					sensor_time_save();
+				break;
+
+				default:
+				break;
+			}
+		}
+	}
+}
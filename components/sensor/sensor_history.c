@@ -0,0 +1,82 @@
+/*
+ * sensor_history.c
+ *
+ *  Created on: 19 oct 2026
+ *      Author: Filippo
+ */
+
+#include "sensor_history.h"
+#include "freertos/FreeRTOS.h"
+#include "sdkconfig.h"
+
+static sensor_sample_t g_history[CONFIG_SENSOR_HISTORY_LENGTH] = {0};
+
+// Sequence the next sample gets, the slot is seq % length
+//
+static uint32_t g_next_seq = 0;
+
+static portMUX_TYPE g_history_mux = portMUX_INITIALIZER_UNLOCKED;
+
+static uint32_t
+sensor_history_oldest_locked (void)
+{
+	return (g_next_seq > CONFIG_SENSOR_HISTORY_LENGTH) ?
+		   (g_next_seq - CONFIG_SENSOR_HISTORY_LENGTH) : 0;
+}
+
+void
+sensor_history_push (const sensor_sample_t * p_sample)
+{
+	portENTER_CRITICAL(&g_history_mux);
+	g_history[g_next_seq % CONFIG_SENSOR_HISTORY_LENGTH] = *p_sample;
+	++g_next_seq;
+	portEXIT_CRITICAL(&g_history_mux);
+}
+
+int32_t
+sensor_history_read (uint32_t * p_seq, sensor_sample_t * p_samples,
+					 int32_t max_samples)
+{
+	int32_t count = 0;
+
+	portENTER_CRITICAL(&g_history_mux);
+
+	uint32_t seq = *p_seq;
+	uint32_t oldest = sensor_history_oldest_locked();
+
+	if (seq < oldest)
+	{
+		seq = oldest;
+	}
+
+	while ((count < max_samples) && (seq < g_next_seq))
+	{
+		p_samples[count] = g_history[seq % CONFIG_SENSOR_HISTORY_LENGTH];
+		++count;
+		++seq;
+	}
+
+	portEXIT_CRITICAL(&g_history_mux);
+
+	*p_seq = seq;
+
+	return count;
+}
+
+uint32_t
+sensor_history_oldest_seq (void)
+{
+	uint32_t oldest = 0;
+
+	portENTER_CRITICAL(&g_history_mux);
+	oldest = sensor_history_oldest_locked();
+	portEXIT_CRITICAL(&g_history_mux);
+
+	return oldest;
+}
+
+uint32_t
+sensor_history_next_seq (void)
+{
+	return g_next_seq;
+}
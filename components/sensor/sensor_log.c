@@ -0,0 +1,526 @@
+/*
+ * sensor_log.c
+ *
+ *  Created on: 19 oct 2026
+ *      Author: Filippo
+ */
+
+#include "sensor_log.h"
+#include "sdkconfig.h"
+
+#if CONFIG_SENSOR_LOG
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "esp_partition.h"
+#include "esp_spi_flash.h"
+#include "esp_rom_crc.h"
+#include "esp_timer.h"
+#include "esp_system.h"
+#include "esp_log.h"
+#include "nvs_flash.h"
+#include "sys/param.h"
+#include "sensor_log_codec.h"
+#include "app_static.h"
+
+// Every block fills one flash sector: header, then the codec bit stream
+//
+#define SENSOR_LOG_MAGIC			0x31424C53			// "SLB1"
+#define SENSOR_LOG_BLOCK_SIZE		SPI_FLASH_SEC_SIZE
+#define SENSOR_LOG_PAYLOAD_SIZE		(SENSOR_LOG_BLOCK_SIZE - sizeof(sensor_log_header_t))
+
+typedef struct sensor_log_header
+{
+	uint32_t magic;
+	uint32_t seq;				// Grows with every block written, from 1
+	uint32_t erase_count;		// Of this sector, this erase included
+	uint16_t boot;
+	uint16_t count;
+	int64_t first_ms;
+	int64_t last_ms;
+	uint16_t payload_len;
+	uint16_t reserved;
+	uint32_t crc;				// CRC32 of the payload
+} sensor_log_header_t;
+
+_Static_assert(sizeof(sensor_log_header_t) == 40,
+			   "tools/sensor_log_bench.c sizes the payload with a 40 byte header");
+_Static_assert(CONFIG_SENSOR_MAX_SENSORS <= SENSOR_LOG_CODEC_SENSORS,
+			   "The codec has 4 bits of sensor id");
+
+// RAM index, one entry per sector
+//
+typedef struct sensor_log_index
+{
+	uint32_t seq;				// 0 for no block
+	uint32_t erase_count;
+	uint32_t first_s;
+	uint32_t last_s;
+	uint16_t boot;
+	uint16_t count;
+} sensor_log_index_t;
+
+static const char g_tag[] = "sensor_log";
+static const char g_sensor_log_namespace[] = "sensor_log";
+
+static const esp_partition_t * gp_partition = NULL;
+static sensor_log_index_t g_index[CONFIG_SENSOR_LOG_MAX_SECTORS] = {0};
+static portMUX_TYPE g_index_mux = portMUX_INITIALIZER_UNLOCKED;
+static uint32_t g_sectors = 0;
+static uint32_t g_write_sector = 0;
+static uint32_t g_next_seq = 1;
+static uint16_t g_boot = 1;
+
+// Block being filled, under gh_write_mutex
+//
+static SemaphoreHandle_t gh_write_mutex = NULL;
+static uint8_t g_block[SENSOR_LOG_PAYLOAD_SIZE];
+static sensor_log_codec_t g_codec;
+static uint16_t g_block_count = 0;
+static int64_t g_block_first_ms = 0;
+static int64_t g_block_last_ms = 0;
+
+// One query at a time decodes in the read block
+//
+static SemaphoreHandle_t gh_query_mutex = NULL;
+static uint8_t g_read_block[SENSOR_LOG_PAYLOAD_SIZE];
+static sensor_log_codec_t g_read_codec;
+
+static sensor_log_stats_t g_stats = {0};
+
+static uint16_t sensor_log_next_boot(uint16_t last_boot);
+static esp_err_t sensor_log_commit(void);
+static void sensor_log_shutdown(void);
+static esp_err_t sensor_log_decode(const uint8_t * p_payload, size_t len,
+								   uint16_t boot, int64_t base_ms, uint32_t count,
+								   int64_t from_ms, int64_t to_ms,
+								   sensor_log_query_cb_t cb, void * p_arg);
+
+esp_err_t
+sensor_log_init (void)
+{
+	sensor_log_header_t header = {0};
+	uint32_t last_sector = 0;
+	uint32_t last_seq = 0;
+	uint32_t erase_known_max = 0;
+	uint16_t last_boot = 0;
+
+	if (NULL != gp_partition)
+	{
+		return ESP_OK;
+	}
+
+	gp_partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA,
+											ESP_PARTITION_SUBTYPE_ANY,
+											CONFIG_SENSOR_LOG_PARTITION);
+
+	if ((NULL == gp_partition) || (gp_partition->size < 2 * SENSOR_LOG_BLOCK_SIZE))
+	{
+		ESP_LOGW(g_tag, "sensor_log_init: no \"%s\" partition, flash history disabled",
+				 CONFIG_SENSOR_LOG_PARTITION);
+		gp_partition = NULL;
+
+		return ESP_ERR_NOT_FOUND;
+	}
+
+	g_sectors = MIN(gp_partition->size / SENSOR_LOG_BLOCK_SIZE, CONFIG_SENSOR_LOG_MAX_SECTORS);
+
+	for (uint32_t sector = 0; sector < g_sectors; ++sector)
+	{
+		if ((ESP_OK != esp_partition_read(gp_partition, sector * SENSOR_LOG_BLOCK_SIZE,
+										  &header, sizeof(header))) ||
+			(SENSOR_LOG_MAGIC != header.magic) || (0 == header.seq) ||
+			(UINT32_MAX == header.seq))
+		{
+			continue;
+		}
+
+		g_index[sector].seq = header.seq;
+		g_index[sector].erase_count = header.erase_count;
+		g_index[sector].first_s = (uint32_t) (header.first_ms / 1000);
+		g_index[sector].last_s = (uint32_t) (header.last_ms / 1000);
+		g_index[sector].boot = header.boot;
+		g_index[sector].count = header.count;
+
+		erase_known_max = MAX(erase_known_max, header.erase_count);
+
+		if (header.seq > last_seq)
+		{
+			last_seq = header.seq;
+			last_sector = sector;
+			last_boot = header.boot;
+		}
+	}
+
+	// A blank or torn sector lost its count, assume the worst known
+	//
+	for (uint32_t sector = 0; sector < g_sectors; ++sector)
+	{
+		if (0 == g_index[sector].seq)
+		{
+			g_index[sector].erase_count = erase_known_max;
+		}
+	}
+
+	if (0 != last_seq)
+	{
+		g_write_sector = (last_sector + 1) % g_sectors;
+		g_next_seq = last_seq + 1;
+	}
+
+	g_boot = sensor_log_next_boot(last_boot);
+
+	gh_write_mutex = APP_MUTEX_CREATE();
+	gh_query_mutex = APP_MUTEX_CREATE();
+	g_stats.sectors = g_sectors;
+	g_stats.boot = g_boot;
+
+	// Any esp_restart() keeps the samples of the RAM block
+	//
+	esp_register_shutdown_handler(sensor_log_shutdown);
+
+	ESP_LOGI(g_tag, "sensor_log_init: %u sectors at 0x%X, boot %u, next block %u in sector %u",
+			 g_sectors, gp_partition->address, g_boot, g_next_seq, g_write_sector);
+
+	return ESP_OK;
+}
+
+// Flash only knows the boots that committed a block. A short boot that
+// lost power before its first one would hand its number to the next
+// boot, and with it its UTC offset: the last number given is kept in NVS.
+//
+static uint16_t
+sensor_log_next_boot (uint16_t last_boot)
+{
+	nvs_handle h_nvs = 0;
+	uint16_t saved = 0;
+	uint16_t boot = 0;
+
+	if (ESP_OK != nvs_open(g_sensor_log_namespace, NVS_READWRITE, &h_nvs))
+	{
+		ESP_LOGW(g_tag, "sensor_log_next_boot: no NVS, boot numbered from flash");
+
+		return (last_boot >= SENSOR_LOG_BOOT_CURRENT - 1) ? 1 : (last_boot + 1);
+	}
+
+	if (ESP_OK == nvs_get_u16(h_nvs, "boot", &saved))
+	{
+		last_boot = saved;
+	}
+
+	boot = (last_boot >= SENSOR_LOG_BOOT_CURRENT - 1) ? 1 : (last_boot + 1);
+
+	if ((ESP_OK != nvs_set_u16(h_nvs, "boot", boot)) ||
+		(ESP_OK != nvs_commit(h_nvs)))
+	{
+		ESP_LOGW(g_tag, "sensor_log_next_boot: boot %u not saved", boot);
+	}
+
+	nvs_close(h_nvs);
+
+	return boot;
+}
+
+void
+sensor_log_append (const sensor_sample_t * p_sample)
+{
+	sensor_log_record_t record = {
+		.timestamp_ms = p_sample->timestamp_us / 1000,
+		.value = p_sample->value,
+		.sensor_id = p_sample->sensor_id,
+		.quantity = p_sample->quantity,
+		.tag = p_sample->tag
+	};
+
+	if (NULL == gp_partition)
+	{
+		return;
+	}
+
+	xSemaphoreTake(gh_write_mutex, portMAX_DELAY);
+
+	if ((0 == g_block_count) ||
+		(false == sensor_log_codec_put(&g_codec, &record)))
+	{
+		// Full block, or the first sample of a new one
+		//
+		sensor_log_commit();
+		memset(g_block, 0, sizeof(g_block));
+		sensor_log_codec_init(&g_codec, g_block, sizeof(g_block), record.timestamp_ms);
+		g_block_first_ms = record.timestamp_ms;
+
+		if (false == sensor_log_codec_put(&g_codec, &record))
+		{
+			xSemaphoreGive(gh_write_mutex);
+
+			return;
+		}
+	}
+
+	g_block_count++;
+	g_block_last_ms = record.timestamp_ms;
+
+	xSemaphoreGive(gh_write_mutex);
+}
+
+esp_err_t
+sensor_log_flush (void)
+{
+	esp_err_t err = ESP_OK;
+
+	if (NULL == gp_partition)
+	{
+		return ESP_ERR_INVALID_STATE;
+	}
+
+	xSemaphoreTake(gh_write_mutex, portMAX_DELAY);
+	err = sensor_log_commit();
+	xSemaphoreGive(gh_write_mutex);
+
+	return err;
+}
+
+static void
+sensor_log_shutdown (void)
+{
+	sensor_log_flush();
+}
+
+esp_err_t
+sensor_log_query (uint16_t boot, int64_t from_ms, int64_t to_ms,
+				  sensor_log_query_cb_t cb, void * p_arg)
+{
+	sensor_log_header_t header = {0};
+	sensor_log_index_t entry = {0};
+	int64_t start_us = esp_timer_get_time();
+	uint32_t blocks = 0;
+	esp_err_t err = ESP_OK;
+
+	if (NULL == gp_partition)
+	{
+		return ESP_ERR_INVALID_STATE;
+	}
+
+	if (SENSOR_LOG_BOOT_CURRENT == boot)
+	{
+		boot = g_boot;
+	}
+
+	xSemaphoreTake(gh_query_mutex, portMAX_DELAY);
+	g_stats.query_samples = 0;
+
+	// Oldest first: the ring restarts after the sector written last
+	//
+	for (uint32_t idx = 0; (idx < g_sectors) && (ESP_OK == err); ++idx)
+	{
+		uint32_t sector = (g_write_sector + idx) % g_sectors;
+
+		portENTER_CRITICAL(&g_index_mux);
+		entry = g_index[sector];
+		portEXIT_CRITICAL(&g_index_mux);
+
+		if ((0 == entry.seq) || (boot != entry.boot) ||
+			((int64_t) entry.last_s * 1000 + 999 < from_ms) ||
+			((int64_t) entry.first_s * 1000 > to_ms))
+		{
+			continue;
+		}
+
+		// The writer may erase the sector meanwhile: the sequence and
+		// the CRC must both still match
+		//
+		if ((ESP_OK != esp_partition_read(gp_partition, sector * SENSOR_LOG_BLOCK_SIZE,
+										  &header, sizeof(header))) ||
+			(SENSOR_LOG_MAGIC != header.magic) || (entry.seq != header.seq) ||
+			(header.payload_len > SENSOR_LOG_PAYLOAD_SIZE) ||
+			(ESP_OK != esp_partition_read(gp_partition,
+										  sector * SENSOR_LOG_BLOCK_SIZE + sizeof(header),
+										  g_read_block, header.payload_len)) ||
+			(header.crc != esp_rom_crc32_le(0, g_read_block, header.payload_len)))
+		{
+			ESP_LOGW(g_tag, "sensor_log_query: block %u in sector %u skipped",
+					 entry.seq, sector);
+			continue;
+		}
+
+		blocks++;
+		err = sensor_log_decode(g_read_block, header.payload_len, boot,
+								header.first_ms, header.count, from_ms, to_ms,
+								cb, p_arg);
+
+		if (ESP_ERR_INVALID_CRC == err)
+		{
+			ESP_LOGW(g_tag, "sensor_log_query: block %u does not decode", entry.seq);
+			err = ESP_OK;
+		}
+	}
+
+	// Samples not written yet
+	//
+	if ((ESP_OK == err) && (boot == g_boot))
+	{
+		size_t len = 0;
+		uint32_t count = 0;
+		int64_t base_ms = 0;
+
+		xSemaphoreTake(gh_write_mutex, portMAX_DELAY);
+		len = sensor_log_codec_bytes(&g_codec);
+		count = g_block_count;
+		base_ms = g_block_first_ms;
+		memcpy(g_read_block, g_block, len);
+		xSemaphoreGive(gh_write_mutex);
+
+		if (count > 0)
+		{
+			err = sensor_log_decode(g_read_block, len, boot, base_ms, count,
+									from_ms, to_ms, cb, p_arg);
+		}
+	}
+
+	g_stats.query_ms = (uint32_t) ((esp_timer_get_time() - start_us) / 1000);
+	xSemaphoreGive(gh_query_mutex);
+
+	ESP_LOGI(g_tag, "sensor_log_query: boot %u, %u blocks, %u samples in %u ms",
+			 boot, blocks, g_stats.query_samples, g_stats.query_ms);
+
+	return err;
+}
+
+void
+sensor_log_get_stats (sensor_log_stats_t * p_stats)
+{
+	portENTER_CRITICAL(&g_index_mux);
+	g_stats.erase_min = UINT32_MAX;
+	g_stats.erase_max = 0;
+
+	for (uint32_t sector = 0; sector < g_sectors; ++sector)
+	{
+		g_stats.erase_min = MIN(g_stats.erase_min, g_index[sector].erase_count);
+		g_stats.erase_max = MAX(g_stats.erase_max, g_index[sector].erase_count);
+	}
+
+	if (0 == g_sectors)
+	{
+		g_stats.erase_min = 0;
+	}
+
+	*p_stats = g_stats;
+	portEXIT_CRITICAL(&g_index_mux);
+}
+
+// Writes the RAM block to the next sector of the ring, with
+// gh_write_mutex taken. Going round the ring erases every sector in turn,
+// which keeps the erase counts within one of each other.
+//
+static esp_err_t
+sensor_log_commit (void)
+{
+	uint32_t sector = g_write_sector;
+	uint32_t offset = sector * SENSOR_LOG_BLOCK_SIZE;
+	sensor_log_header_t header = {
+		.magic = SENSOR_LOG_MAGIC,
+		.seq = g_next_seq,
+		.erase_count = g_index[sector].erase_count + 1,
+		.boot = g_boot,
+		.count = g_block_count,
+		.first_ms = g_block_first_ms,
+		.last_ms = g_block_last_ms,
+		.payload_len = (uint16_t) sensor_log_codec_bytes(&g_codec),
+		.reserved = 0xFFFF
+	};
+	esp_err_t err = ESP_OK;
+
+	if (0 == g_block_count)
+	{
+		return ESP_OK;
+	}
+
+	header.crc = esp_rom_crc32_le(0, g_block, header.payload_len);
+
+	// Queries stop trusting the sector before it is erased
+	//
+	portENTER_CRITICAL(&g_index_mux);
+	g_index[sector].seq = 0;
+	g_index[sector].erase_count = header.erase_count;
+	portEXIT_CRITICAL(&g_index_mux);
+
+	err = esp_partition_erase_range(gp_partition, offset, SENSOR_LOG_BLOCK_SIZE);
+
+	if (ESP_OK == err)
+	{
+		err = esp_partition_write(gp_partition, offset + sizeof(header), g_block,
+								  header.payload_len);
+	}
+
+	// Header last: a block torn by a reset has no magic
+	//
+	if (ESP_OK == err)
+	{
+		err = esp_partition_write(gp_partition, offset, &header, sizeof(header));
+	}
+
+	if (ESP_OK == err)
+	{
+		portENTER_CRITICAL(&g_index_mux);
+		g_index[sector].seq = header.seq;
+		g_index[sector].first_s = (uint32_t) (header.first_ms / 1000);
+		g_index[sector].last_s = (uint32_t) (header.last_ms / 1000);
+		g_index[sector].boot = header.boot;
+		g_index[sector].count = header.count;
+		g_stats.blocks_written++;
+		g_stats.samples += header.count;
+		g_stats.payload_bytes += header.payload_len;
+		portEXIT_CRITICAL(&g_index_mux);
+	}
+	else
+	{
+		ESP_LOGE(g_tag, "sensor_log_commit: sector %u, %s", sector, esp_err_to_name(err));
+	}
+
+	// A failed sector is skipped, its samples are lost
+	//
+	g_next_seq++;
+	g_write_sector = (sector + 1) % g_sectors;
+	g_block_count = 0;
+
+	return err;
+}
+
+static esp_err_t
+sensor_log_decode (const uint8_t * p_payload, size_t len, uint16_t boot,
+				   int64_t base_ms, uint32_t count, int64_t from_ms, int64_t to_ms,
+				   sensor_log_query_cb_t cb, void * p_arg)
+{
+	sensor_log_record_t record = {0};
+	sensor_sample_t sample = {0};
+	esp_err_t err = ESP_OK;
+
+	sensor_log_codec_init(&g_read_codec, (uint8_t *) p_payload, len, base_ms);
+
+	for (uint32_t idx = 0; (idx < count) && (ESP_OK == err); ++idx)
+	{
+		if (false == sensor_log_codec_get(&g_read_codec, &record))
+		{
+			return ESP_ERR_INVALID_CRC;
+		}
+
+		if ((record.timestamp_ms < from_ms) || (record.timestamp_ms > to_ms))
+		{
+			continue;
+		}
+
+		sample.timestamp_us = record.timestamp_ms * 1000;
+		sample.value = record.value;
+		sample.boot = boot;
+		sample.sensor_id = record.sensor_id;
+		sample.quantity = record.quantity;
+		sample.unit = sensor_quantity_unit((sensor_quantity_t) record.quantity);
+		sample.tag = record.tag;
+
+		g_stats.query_samples++;
+		err = cb(&sample, p_arg);
+	}
+
+	return err;
+}
+#endif
@@ -0,0 +1,397 @@
+/*
+ * sensor_log_codec.c
+ *
+ *  Created on: 19 oct 2026
+ *      Author: Filippo
+ */
+
+#include "sensor_log_codec.h"
+#include <string.h>
+
+// Writes bits MSB first. Without a buffer it only counts them.
+//
+static void
+sensor_log_codec_write (uint8_t * p_buf, uint32_t * p_pos, uint64_t value,
+						uint32_t bits)
+{
+	if (NULL != p_buf)
+	{
+		for (uint32_t idx = bits; idx > 0; --idx)
+		{
+			if (0 != ((value >> (idx - 1)) & 1))
+			{
+				p_buf[*p_pos >> 3] |= (uint8_t) (0x80 >> (*p_pos & 7));
+			}
+
+			++*p_pos;
+		}
+	}
+	else
+	{
+		*p_pos += bits;
+	}
+}
+
+static bool
+sensor_log_codec_read (sensor_log_codec_t * p_codec, uint32_t bits,
+					   uint64_t * p_value)
+{
+	uint64_t value = 0;
+
+	if (p_codec->pos_bits + bits > p_codec->size_bits)
+	{
+		return false;
+	}
+
+	for (uint32_t idx = 0; idx < bits; ++idx)
+	{
+		value = (value << 1) |
+				((p_codec->p_buf[p_codec->pos_bits >> 3] >> (7 - (p_codec->pos_bits & 7))) & 1);
+		++p_codec->pos_bits;
+	}
+
+	*p_value = value;
+
+	return true;
+}
+
+static int64_t
+sensor_log_codec_sign (uint64_t value, uint32_t bits)
+{
+	return (0 != (value & (1ULL << (bits - 1)))) ?
+		   (int64_t) (value | (~0ULL << bits)) : (int64_t) value;
+}
+
+// Encodes one record, in p_series (a copy when only counting)
+//
+static bool
+sensor_log_codec_encode (uint8_t * p_buf, uint32_t * p_pos,
+						 sensor_log_series_t * p_series, int64_t base_ms,
+						 const sensor_log_record_t * p_record)
+{
+	uint32_t bits = 0;
+	int64_t delta = 0;
+	int64_t dod = 0;
+
+	if (false == p_series->b_started)
+	{
+		p_series->prev_ms = base_ms;
+		p_series->prev_delta = 0;
+		p_series->prev_tag = 0;
+	}
+
+	delta = p_record->timestamp_ms - p_series->prev_ms;
+	dod = delta - p_series->prev_delta;
+
+	if ((dod < INT32_MIN) || (dod > INT32_MAX))
+	{
+		return false;
+	}
+
+	sensor_log_codec_write(p_buf, p_pos,
+						   p_record->sensor_id * SENSOR_LOG_CODEC_QUANTITIES + p_record->quantity,
+						   6);
+
+	if (0 == dod)
+	{
+		sensor_log_codec_write(p_buf, p_pos, 0x0, 1);
+	}
+	else if ((dod >= -64) && (dod <= 63))
+	{
+		sensor_log_codec_write(p_buf, p_pos, 0x2, 2);
+		sensor_log_codec_write(p_buf, p_pos, (uint64_t) dod & 0x7F, 7);
+	}
+	else if ((dod >= -256) && (dod <= 255))
+	{
+		sensor_log_codec_write(p_buf, p_pos, 0x6, 3);
+		sensor_log_codec_write(p_buf, p_pos, (uint64_t) dod & 0x1FF, 9);
+	}
+	else if ((dod >= -2048) && (dod <= 2047))
+	{
+		sensor_log_codec_write(p_buf, p_pos, 0xE, 4);
+		sensor_log_codec_write(p_buf, p_pos, (uint64_t) dod & 0xFFF, 12);
+	}
+	else
+	{
+		sensor_log_codec_write(p_buf, p_pos, 0xF, 4);
+		sensor_log_codec_write(p_buf, p_pos, (uint64_t) dod & 0xFFFFFFFF, 32);
+	}
+
+	if (p_record->tag == p_series->prev_tag)
+	{
+		sensor_log_codec_write(p_buf, p_pos, 0, 1);
+	}
+	else
+	{
+		sensor_log_codec_write(p_buf, p_pos, 1, 1);
+		sensor_log_codec_write(p_buf, p_pos, p_record->tag, 8);
+	}
+
+	memcpy(&bits, &p_record->value, sizeof(bits));
+
+	if (false == p_series->b_started)
+	{
+		sensor_log_codec_write(p_buf, p_pos, bits, 32);
+		p_series->leading = 0xFF;
+	}
+	else
+	{
+		uint32_t xor = bits ^ p_series->prev_bits;
+
+		if (0 == xor)
+		{
+			sensor_log_codec_write(p_buf, p_pos, 0x0, 1);
+		}
+		else
+		{
+			uint8_t leading = (uint8_t) __builtin_clz(xor);
+			uint8_t trailing = (uint8_t) __builtin_ctz(xor);
+
+			// 5 bits of leading zeros
+			//
+			if (leading > 31)
+			{
+				leading = 31;
+			}
+
+			if ((0xFF != p_series->leading) && (leading >= p_series->leading) &&
+				(trailing >= p_series->trailing))
+			{
+				sensor_log_codec_write(p_buf, p_pos, 0x2, 2);
+				sensor_log_codec_write(p_buf, p_pos, xor >> p_series->trailing,
+									   32 - p_series->leading - p_series->trailing);
+			}
+			else
+			{
+				uint32_t meaningful = 32 - leading - trailing;
+
+				sensor_log_codec_write(p_buf, p_pos, 0x3, 2);
+				sensor_log_codec_write(p_buf, p_pos, leading, 5);
+				sensor_log_codec_write(p_buf, p_pos, meaningful - 1, 5);
+				sensor_log_codec_write(p_buf, p_pos, xor >> trailing, meaningful);
+
+				p_series->leading = leading;
+				p_series->trailing = trailing;
+			}
+		}
+	}
+
+	p_series->prev_ms = p_record->timestamp_ms;
+	p_series->prev_delta = delta;
+	p_series->prev_bits = bits;
+	p_series->prev_tag = p_record->tag;
+	p_series->b_started = true;
+
+	return true;
+}
+
+void
+sensor_log_codec_init (sensor_log_codec_t * p_codec, uint8_t * p_buf,
+					   size_t size, int64_t base_ms)
+{
+	memset(p_codec, 0, sizeof(*p_codec));
+	p_codec->p_buf = p_buf;
+	p_codec->size_bits = (uint32_t) size * 8;
+	p_codec->base_ms = base_ms;
+}
+
+bool
+sensor_log_codec_put (sensor_log_codec_t * p_codec,
+					  const sensor_log_record_t * p_record)
+{
+	sensor_log_series_t * p_series = NULL;
+	sensor_log_series_t series = {0};
+	uint32_t pos = p_codec->pos_bits;
+
+	if ((p_record->sensor_id >= SENSOR_LOG_CODEC_SENSORS) ||
+		(p_record->quantity >= SENSOR_LOG_CODEC_QUANTITIES))
+	{
+		return false;
+	}
+
+	p_series = &p_codec->series[p_record->sensor_id * SENSOR_LOG_CODEC_QUANTITIES +
+								p_record->quantity];
+
+	// Counts the bits on a copy of the state first
+	//
+	series = *p_series;
+
+	if ((false == sensor_log_codec_encode(NULL, &pos, &series, p_codec->base_ms, p_record)) ||
+		(pos > p_codec->size_bits))
+	{
+		return false;
+	}
+
+	return sensor_log_codec_encode(p_codec->p_buf, &p_codec->pos_bits, p_series,
+								   p_codec->base_ms, p_record);
+}
+
+bool
+sensor_log_codec_get (sensor_log_codec_t * p_codec,
+					  sensor_log_record_t * p_record)
+{
+	sensor_log_series_t * p_series = NULL;
+	uint64_t value = 0;
+	int64_t dod = 0;
+	uint32_t bits = 0;
+
+	if (false == sensor_log_codec_read(p_codec, 6, &value))
+	{
+		return false;
+	}
+
+	p_series = &p_codec->series[value];
+	p_record->sensor_id = (uint8_t) (value / SENSOR_LOG_CODEC_QUANTITIES);
+	p_record->quantity = (uint8_t) (value % SENSOR_LOG_CODEC_QUANTITIES);
+
+	if (false == p_series->b_started)
+	{
+		p_series->prev_ms = p_codec->base_ms;
+		p_series->prev_delta = 0;
+		p_series->prev_tag = 0;
+		p_series->leading = 0xFF;
+	}
+
+	// Time: count the leading ones of the prefix, at most four
+	//
+	uint32_t ones = 0;
+
+	while (ones < 4)
+	{
+		if (false == sensor_log_codec_read(p_codec, 1, &value))
+		{
+			return false;
+		}
+
+		if (0 == value)
+		{
+			break;
+		}
+
+		++ones;
+	}
+
+	switch (ones)
+	{
+		case 0:
+			dod = 0;
+		break;
+
+		case 1:
+		case 2:
+		case 3:
+		{
+			static const uint8_t widths[] = { 0, 7, 9, 12 };
+
+			if (false == sensor_log_codec_read(p_codec, widths[ones], &value))
+			{
+				return false;
+			}
+
+			dod = sensor_log_codec_sign(value, widths[ones]);
+		}
+		break;
+
+		default:
+			if (false == sensor_log_codec_read(p_codec, 32, &value))
+			{
+				return false;
+			}
+
+			dod = sensor_log_codec_sign(value, 32);
+		break;
+	}
+
+	p_series->prev_delta += dod;
+	p_series->prev_ms += p_series->prev_delta;
+	p_record->timestamp_ms = p_series->prev_ms;
+
+	// Tag
+	//
+	if (false == sensor_log_codec_read(p_codec, 1, &value))
+	{
+		return false;
+	}
+
+	if (1 == value)
+	{
+		if (false == sensor_log_codec_read(p_codec, 8, &value))
+		{
+			return false;
+		}
+
+		p_series->prev_tag = (uint8_t) value;
+	}
+
+	p_record->tag = p_series->prev_tag;
+
+	// Value
+	//
+	if (false == p_series->b_started)
+	{
+		if (false == sensor_log_codec_read(p_codec, 32, &value))
+		{
+			return false;
+		}
+
+		bits = (uint32_t) value;
+	}
+	else
+	{
+		if (false == sensor_log_codec_read(p_codec, 1, &value))
+		{
+			return false;
+		}
+
+		bits = p_series->prev_bits;
+
+		if (1 == value)
+		{
+			if (false == sensor_log_codec_read(p_codec, 1, &value))
+			{
+				return false;
+			}
+
+			if (1 == value)
+			{
+				uint64_t leading = 0;
+				uint64_t length = 0;
+
+				if ((false == sensor_log_codec_read(p_codec, 5, &leading)) ||
+					(false == sensor_log_codec_read(p_codec, 5, &length)) ||
+					(leading + length + 1 > 32))
+				{
+					return false;
+				}
+
+				p_series->leading = (uint8_t) leading;
+				p_series->trailing = (uint8_t) (32 - leading - (length + 1));
+			}
+			else if (0xFF == p_series->leading)
+			{
+				return false;
+			}
+
+			if (false == sensor_log_codec_read(p_codec,
+											   32 - p_series->leading - p_series->trailing,
+											   &value))
+			{
+				return false;
+			}
+
+			bits ^= (uint32_t) (value << p_series->trailing);
+		}
+	}
+
+	memcpy(&p_record->value, &bits, sizeof(bits));
+	p_series->prev_bits = bits;
+	p_series->b_started = true;
+
+	return true;
+}
+
+size_t
+sensor_log_codec_bytes (const sensor_log_codec_t * p_codec)
+{
+	return (p_codec->pos_bits + 7) / 8;
+}
@@ -0,0 +1,270 @@
+/*
+ * sensor_time.c
+ *
+ *  Created on: 19 oct 2026
+ *      Author: Filippo
+ */
+
+#include "sensor_time.h"
+#include <stdio.h>
+#include <string.h>
+#include <sys/time.h>
+#include "freertos/FreeRTOS.h"
+#include "nvs_flash.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+#include "sdkconfig.h"
+#include "sensor.h"
+#include "sensor_log.h"
+#include "sntp_time_sync.h"
+
+// Offsets of the last boots kept in NVS, slot boot % SENSOR_TIME_BOOTS
+//
+#define SENSOR_TIME_BOOTS			8
+
+typedef struct sensor_time_offset
+{
+	uint16_t boot;				// 0 for a free slot
+	int64_t offset_ms;
+} sensor_time_offset_t;
+
+static const char g_tag[] = "sensor_time";
+static const char g_sensor_time_namespace[] = "sensor_time";
+
+static bool gb_init = false;
+static uint16_t g_boot_id = 0;
+static sensor_time_offset_t g_offsets[SENSOR_TIME_BOOTS] = {0};
+static bool gb_dirty = false;
+
+// The offsets are written on the LwIP task, saved by the sensor task
+// and read by the exporters
+//
+static portMUX_TYPE g_time_mux = portMUX_INITIALIZER_UNLOCKED;
+
+static void sensor_time_synced(const sntp_time_sync_event_t * p_event,
+							   void * p_arg);
+static uint16_t sensor_time_next_boot(nvs_handle h_nvs);
+
+void
+sensor_time_init (void)
+{
+	nvs_handle h_nvs = 0;
+	size_t len = sizeof(g_offsets);
+
+	if (true == gb_init)
+	{
+		return;
+	}
+
+	gb_init = true;
+
+#if CONFIG_SENSOR_LOG
+	// The flash log numbers its boots already, exports select them
+	//
+	if (ESP_OK == sensor_log_init())
+	{
+		sensor_log_stats_t stats = {0};
+
+		sensor_log_get_stats(&stats);
+		g_boot_id = stats.boot;
+	}
+#endif
+
+	if (ESP_OK == nvs_open(g_sensor_time_namespace, NVS_READWRITE, &h_nvs))
+	{
+		if ((ESP_OK != nvs_get_blob(h_nvs, "offsets", g_offsets, &len)) ||
+			(sizeof(g_offsets) != len))
+		{
+			memset(g_offsets, 0, sizeof(g_offsets));
+		}
+
+		if (0 == g_boot_id)
+		{
+			g_boot_id = sensor_time_next_boot(h_nvs);
+		}
+
+		nvs_close(h_nvs);
+	}
+
+	ESP_LOGI(g_tag, "sensor_time_init: boot %u", g_boot_id);
+
+	sntp_time_sync_subscribe(sensor_time_synced, NULL);
+}
+
+uint16_t
+sensor_time_boot_id (void)
+{
+	return g_boot_id;
+}
+
+bool
+sensor_time_utc_offset_ms (uint16_t boot, int64_t * p_offset_ms)
+{
+	bool b_found = false;
+
+	if ((0 == boot) || (NULL == p_offset_ms))
+	{
+		return false;
+	}
+
+	portENTER_CRITICAL(&g_time_mux);
+
+	if (boot == g_offsets[boot % SENSOR_TIME_BOOTS].boot)
+	{
+		*p_offset_ms = g_offsets[boot % SENSOR_TIME_BOOTS].offset_ms;
+		b_found = true;
+	}
+
+	portEXIT_CRITICAL(&g_time_mux);
+
+	return b_found;
+}
+
+size_t
+sensor_time_format_latest_json (char * p_buf, size_t size)
+{
+	sensor_sample_t temperature = {0};
+	sensor_sample_t humidity = {0};
+	int64_t offset_ms = 0;
+	int32_t len = 0;
+
+	if ((NULL == p_buf) || (0 == size))
+	{
+		return 0;
+	}
+
+	sensor_get_latest(SENSOR_ID_ANY, SENSOR_QUANTITY_TEMPERATURE, &temperature);
+	sensor_get_latest(SENSOR_ID_ANY, SENSOR_QUANTITY_HUMIDITY, &humidity);
+
+	// Both come from the same read on the DHT22, the temperature sets
+	// the time
+	//
+	len = snprintf(p_buf, size, "{\"boot\":%u,\"t_ms\":%lld,\"utc_ms\":",
+				   temperature.boot, temperature.timestamp_us / 1000);
+
+	if ((len > 0) && ((size_t) len < size))
+	{
+		if (true == sensor_time_utc_offset_ms(temperature.boot, &offset_ms))
+		{
+			len += snprintf(p_buf + len, size - len, "%lld",
+							temperature.timestamp_us / 1000 + offset_ms);
+		}
+		else
+		{
+			len += snprintf(p_buf + len, size - len, "null");
+		}
+	}
+
+	if ((len > 0) && ((size_t) len < size))
+	{
+		len += snprintf(p_buf + len, size - len,
+						",\"temperature\":%.1f,\"humidity\":%.1f}",
+						temperature.value, humidity.value);
+	}
+
+	if ((len <= 0) || ((size_t) len >= size))
+	{
+		p_buf[0] = '\0';
+
+		return 0;
+	}
+
+	return (size_t) len;
+}
+
+// The sync has just handed the server time to the clock: in smooth mode
+// the local time is still event offset away from UTC
+//
+static void
+sensor_time_synced (const sntp_time_sync_event_t * p_event, void * p_arg)
+{
+	struct timeval now = {0};
+	int64_t mono_us = esp_timer_get_time();
+	int64_t utc_us = 0;
+	uint8_t slot = g_boot_id % SENSOR_TIME_BOOTS;
+	bool b_save = false;
+
+	gettimeofday(&now, NULL);
+	utc_us = (int64_t) now.tv_sec * 1000000LL + now.tv_usec + p_event->offset_us;
+
+	// The first sync of the boot fixes the offset used for every sample
+	// of the boot, so an export gives the same times before and after a
+	// restart
+	//
+	portENTER_CRITICAL(&g_time_mux);
+
+	if ((0 != g_boot_id) && (g_boot_id != g_offsets[slot].boot))
+	{
+		g_offsets[slot].boot = g_boot_id;
+		g_offsets[slot].offset_ms = (utc_us - mono_us) / 1000;
+		gb_dirty = true;
+		b_save = true;
+	}
+
+	portEXIT_CRITICAL(&g_time_mux);
+
+	if (false == b_save)
+	{
+		return;
+	}
+
+	ESP_LOGI(g_tag, "sensor_time_synced: boot %u, offset %lld ms",
+			 g_boot_id, (utc_us - mono_us) / 1000);
+
+	// The offset is in use already, only its copy for the next boots
+	// waits for the sensor task
+	//
+	if (false == sensor_post_time_save())
+	{
+		ESP_LOGW(g_tag, "sensor_time_synced: save not queued");
+	}
+}
+
+void
+sensor_time_save (void)
+{
+	sensor_time_offset_t offsets[SENSOR_TIME_BOOTS] = {0};
+	nvs_handle h_nvs = 0;
+	bool b_dirty = false;
+
+	portENTER_CRITICAL(&g_time_mux);
+	b_dirty = gb_dirty;
+	gb_dirty = false;
+	memcpy(offsets, g_offsets, sizeof(offsets));
+	portEXIT_CRITICAL(&g_time_mux);
+
+	if (false == b_dirty)
+	{
+		return;
+	}
+
+	if ((ESP_OK != nvs_open(g_sensor_time_namespace, NVS_READWRITE, &h_nvs)) ||
+		(ESP_OK != nvs_set_blob(h_nvs, "offsets", offsets, sizeof(offsets))) ||
+		(ESP_OK != nvs_commit(h_nvs)))
+	{
+		ESP_LOGW(g_tag, "sensor_time_save: offsets not saved");
+	}
+
+	if (0 != h_nvs)
+	{
+		nvs_close(h_nvs);
+	}
+}
+
+// Boot counter for the projects without the flash log, never 0
+//
+static uint16_t
+sensor_time_next_boot (nvs_handle h_nvs)
+{
+	uint16_t boot = 0;
+
+	nvs_get_u16(h_nvs, "boot", &boot);
+	boot = ((0 == boot) || (boot >= SENSOR_LOG_BOOT_CURRENT - 1)) ? 1 : (boot + 1);
+
+	if (ESP_OK == nvs_set_u16(h_nvs, "boot", boot))
+	{
+		nvs_commit(h_nvs);
+	}
+
+	return boot;
+}
@@ -0,0 +1,23 @@
+/*
+ * sensor_bme680.h
+ *
+ *  Created on: 19 oct 2026
+ *      Author: Filippo
+ */
+
+#ifndef COMPONENTS_SENSOR_BME680_H_
+#	define COMPONENTS_SENSOR_BME680_H_
+
+#	include <stdint.h>
+#	include "esp_err.h"
+#	include "driver/i2c.h"
+
+// Adds a BME680 to the sensor scheduler. Several sensors may share the
+// same port, the bus is only ever used from the sensor task.
+// i2cdev_init() must have been called.
+//
+esp_err_t sensor_bme680_register(uint8_t addr, i2c_port_t port,
+								 gpio_num_t sda_gpio, gpio_num_t scl_gpio,
+								 uint32_t period_ms, uint8_t * p_id);
+
+#endif /* COMPONENTS_SENSOR_BME680_H_ */
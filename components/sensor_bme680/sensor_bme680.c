@@ -0,0 +1,177 @@
+/*
+ * sensor_bme680.c
+ *
+ *  Created on: 19 oct 2026
+ *      Author: Filippo
+ */
+
+#include "sensor_bme680.h"
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_log.h"
+#include "bme680.h"
+#include "sdkconfig.h"
+#include "sensor.h"
+
+// Heater plate temperature step of the gas sequence (deg C) and heating time (ms)
+//
+#define BME680_HEATER_BASE_TEMP		200
+#define BME680_HEATER_STEP_TEMP		50
+#define BME680_HEATER_DURATION_MS	100
+
+static const char g_tag[] = "bme680";
+
+typedef struct sensor_bme680
+{
+	bme680_t dev;
+	uint8_t heater_profile;
+	bme680_values_fixed_t values;
+} sensor_bme680_t;
+
+static sensor_bme680_t g_bme680[CONFIG_SENSOR_BME680_MAX] = {0};
+static uint8_t g_bme680_count = 0;
+
+static esp_err_t sensor_bme680_init(void * p_ctx);
+static esp_err_t sensor_bme680_trigger(void * p_ctx, uint32_t * p_ready_us);
+static esp_err_t sensor_bme680_read(void * p_ctx);
+static int32_t sensor_bme680_decode(void * p_ctx, sensor_sample_t * p_samples,
+									int32_t max_samples);
+
+static const sensor_driver_t g_sensor_bme680_driver = {
+	.p_name = "BME680",
+	.init = sensor_bme680_init,
+	.trigger = sensor_bme680_trigger,
+	.read = sensor_bme680_read,
+	.decode = sensor_bme680_decode
+};
+
+esp_err_t
+sensor_bme680_register (uint8_t addr, i2c_port_t port,
+						gpio_num_t sda_gpio, gpio_num_t scl_gpio,
+						uint32_t period_ms, uint8_t * p_id)
+{
+	if (g_bme680_count >= CONFIG_SENSOR_BME680_MAX)
+	{
+		return ESP_ERR_NO_MEM;
+	}
+
+	sensor_bme680_t * p_bme = &g_bme680[g_bme680_count];
+
+	memset(p_bme, 0, sizeof(sensor_bme680_t));
+
+	esp_err_t err = bme680_init_desc(&p_bme->dev, addr, port, sda_gpio, scl_gpio);
+
+	if (ESP_OK == err)
+	{
+		err = sensor_register(&g_sensor_bme680_driver, p_bme, period_ms, p_id);
+	}
+
+	if (ESP_OK == err)
+	{
+		++g_bme680_count;
+	}
+
+	return err;
+}
+
+static esp_err_t
+sensor_bme680_init (void * p_ctx)
+{
+	sensor_bme680_t * p_bme = (sensor_bme680_t *) p_ctx;
+	esp_err_t err = bme680_init_sensor(&p_bme->dev);
+
+	if (ESP_OK != err)
+	{
+		ESP_LOGE(g_tag, "sensor at 0x%02x not found", p_bme->dev.i2c_dev.addr);
+		return err;
+	}
+
+	// Changes the oversampling rates to 4x oversampling for temperature
+	// and 2x oversampling for humidity and Pressure measurement.
+	//
+	bme680_set_oversampling_rates(&p_bme->dev, BME680_OSR_4X, BME680_OSR_2X, BME680_OSR_2X);
+
+	// Change the IIR filter size for temperature and pressure to 7.
+	//
+	bme680_set_filter_size(&p_bme->dev, BME680_IIR_SIZE_7);
+
+	// Load the whole gas sequence once, each cycle only selects the profile
+	//
+	for (uint8_t profile = 0; profile < CONFIG_SENSOR_BME680_HEATER_STEPS; ++profile)
+	{
+		bme680_set_heater_profile(&p_bme->dev, profile,
+								  BME680_HEATER_BASE_TEMP + (profile * BME680_HEATER_STEP_TEMP),
+								  BME680_HEATER_DURATION_MS);
+	}
+
+	// Set ambient temperature to 10 degree Celsius
+	//
+	bme680_set_ambient_temperature(&p_bme->dev, 10);
+
+	return ESP_OK;
+}
+
+static esp_err_t
+sensor_bme680_trigger (void * p_ctx, uint32_t * p_ready_us)
+{
+	sensor_bme680_t * p_bme = (sensor_bme680_t *) p_ctx;
+	uint32_t duration = 0;
+
+	bme680_use_heater_profile(&p_bme->dev, p_bme->heater_profile);
+
+	// Depends on the heater profile, so it is read back every cycle
+	//
+	bme680_get_measurement_duration(&p_bme->dev, &duration);
+
+	*p_ready_us = duration * portTICK_PERIOD_MS * 1000;
+
+	return bme680_force_measurement(&p_bme->dev);
+}
+
+static esp_err_t
+sensor_bme680_read (void * p_ctx)
+{
+	sensor_bme680_t * p_bme = (sensor_bme680_t *) p_ctx;
+	bool b_busy = false;
+
+	if ((ESP_OK == bme680_is_measuring(&p_bme->dev, &b_busy)) && (true == b_busy))
+	{
+		return ESP_ERR_NOT_FINISHED;
+	}
+
+	return bme680_get_results_fixed(&p_bme->dev, &p_bme->values);
+}
+
+static int32_t
+sensor_bme680_decode (void * p_ctx, sensor_sample_t * p_samples,
+					  int32_t max_samples)
+{
+	sensor_bme680_t * p_bme = (sensor_bme680_t *) p_ctx;
+
+	if (max_samples < 4)
+	{
+		return 0;
+	}
+
+	memset(p_samples, 0, 4 * sizeof(sensor_sample_t));
+
+	// Fixed point results: 0.01 deg C, 0.001 %RH, Pa, Ohm
+	//
+	p_samples[0].quantity = SENSOR_QUANTITY_TEMPERATURE;
+	p_samples[0].value = p_bme->values.temperature / 100.0f;
+	p_samples[1].quantity = SENSOR_QUANTITY_HUMIDITY;
+	p_samples[1].value = p_bme->values.humidity / 1000.0f;
+	p_samples[2].quantity = SENSOR_QUANTITY_PRESSURE;
+	p_samples[2].value = p_bme->values.pressure;
+	p_samples[3].quantity = SENSOR_QUANTITY_GAS_RESISTANCE;
+	p_samples[3].value = p_bme->values.gas_resistance;
+
+	for (int32_t i = 0; i < 4; ++i)
+	{
+		p_samples[i].tag = p_bme->heater_profile;
+	}
+
+	p_bme->heater_profile = (p_bme->heater_profile + 1) % CONFIG_SENSOR_BME680_HEATER_STEPS;
+
+	return 4;
+}
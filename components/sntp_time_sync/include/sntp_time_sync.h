@@ -0,0 +1,70 @@
+/*
+ * sntp_time_sync.h
+ *
+ *  Created on: 20 apr 2023
+ *      Author: Filippo
+ */
+
+#ifndef COMPONENTS_SNTP_TIME_SYNC_H_
+#	define COMPONENTS_SNTP_TIME_SYNC_H_
+
+#	include <stdbool.h>
+#	include <stdint.h>
+#	include <stddef.h>
+#	include "esp_err.h"
+
+// Length of a formatted local time, "dd.mm.YYYY HH:MM:SS"
+//
+#	define SNTP_TIME_SYNC_TIME_LEN	19
+
+typedef struct sntp_time_sync_event
+{
+	bool b_first;				// The time has just become valid
+	bool b_stepped;				// Time set at once, not slewed
+	int64_t offset_us;			// Server time minus local time
+	int32_t drift_ppb;			// Smoothed drift, 0 until measured
+	uint32_t interval_s;		// Time to the next sync
+} sntp_time_sync_event_t;
+
+typedef struct sntp_time_sync_status
+{
+	bool b_valid;
+	uint32_t sync_count;
+	int64_t last_sync_us;		// esp_timer time of the last sync
+	int64_t offset_us;
+	int32_t drift_ppb;
+	uint32_t interval_s;
+} sntp_time_sync_status_t;
+
+// Called on the LwIP task after every sync, keep it short
+//
+typedef void (*sntp_time_sync_cb_t)(const sntp_time_sync_event_t * p_event,
+									void * p_arg);
+
+// Sets the time zone and starts SNTP, further calls do nothing
+//
+void sntp_time_sync_start(void);
+
+// Registers a callback for the syncs. If the time is already valid it
+// is called at once with b_first set.
+//
+esp_err_t sntp_time_sync_subscribe(sntp_time_sync_cb_t cb, void * p_arg);
+
+// True once the first sync has set the clock
+//
+bool sntp_time_sync_is_valid(void);
+
+void sntp_time_sync_get_status(sntp_time_sync_status_t * p_status);
+
+// Wall clock time in ms since the epoch, 0 until the time is valid
+//
+int64_t sntp_time_sync_now_ms(void);
+
+// Formats a wall clock time as local time into p_buf, which needs
+// SNTP_TIME_SYNC_TIME_LEN + 1 bytes. Returns the length, 0 on error.
+// Safe from any task: the date and minute are rendered once per
+// minute, only the seconds are written on every call.
+//
+size_t sntp_time_sync_format(int64_t epoch_ms, char * p_buf, size_t size);
+
+#endif /* COMPONENTS_SNTP_TIME_SYNC_H_ */
@@ -0,0 +1,409 @@
+/*
+ * sntp_time_sync.c
+ *
+ *  Created on: 20 apr 2023
+ *      Author: Filippo
+ */
+
+#include "sntp_time_sync.h"
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <time.h>
+#include "esp_log.h"
+#include "esp_sntp.h"
+#include "esp_timer.h"
+#include "esp_event.h"
+#include "esp_netif.h"
+#include "lwip/tcpip.h"
+#include "freertos/FreeRTOS.h"
+#include "sdkconfig.h"
+
+#define SNTP_TIME_SYNC_MAX_SUBSCRIBERS	4
+
+// "dd.mm.YYYY HH:MM:", cached for the current minute
+//
+#define SNTP_TIME_SYNC_PREFIX_LEN		(SNTP_TIME_SYNC_TIME_LEN - 2)
+
+// Offsets above this are steps or outliers, they do not feed the drift
+//
+#define SNTP_TIME_SYNC_DRIFT_MAX_OFFSET_US	1000000LL
+
+typedef struct sntp_time_sync_subscriber
+{
+	sntp_time_sync_cb_t cb;
+	void * p_arg;
+} sntp_time_sync_subscriber_t;
+
+static const char g_tag[] = "sntp_time_sync";
+static const char * const g_servers[] = {
+	CONFIG_SNTP_TIME_SYNC_SERVER_1,
+	CONFIG_SNTP_TIME_SYNC_SERVER_2,
+	CONFIG_SNTP_TIME_SYNC_SERVER_3
+};
+
+static bool gb_started = false;
+static bool gb_drift_measured = false;
+static sntp_time_sync_subscriber_t g_subscribers[SNTP_TIME_SYNC_MAX_SUBSCRIBERS] = {0};
+static uint8_t g_subscriber_count = 0;
+static sntp_time_sync_status_t g_status = {0};
+static int64_t g_prefix_minute = -1;
+static char g_prefix[SNTP_TIME_SYNC_PREFIX_LEN + 1] = {0};
+
+// Protects the status, written on the LwIP task, and the format cache
+//
+static portMUX_TYPE g_sntp_mux = portMUX_INITIALIZER_UNLOCKED;
+
+static void sntp_time_sync_set_servers(void);
+#if CONFIG_LWIP_DHCP_GET_NTP_SRV
+static void sntp_time_sync_got_ip(void * p_arg, esp_event_base_t event_base,
+								  int32_t event_id, void * p_event_data);
+static void sntp_time_sync_lease_servers(void * p_arg);
+#endif
+static void sntp_time_sync_notification(struct timeval * p_tv);
+static uint32_t sntp_time_sync_next_interval(int32_t drift_ppb);
+
+void
+sntp_time_sync_start (void)
+{
+#if CONFIG_LWIP_DHCP_GET_NTP_SRV
+	esp_err_t err = ESP_OK;
+#endif
+
+	// TZ is applied on every boot, even when the RTC kept the time
+	//
+	setenv("TZ", CONFIG_SNTP_TIME_SYNC_TZ, 1);
+	tzset();
+
+	portENTER_CRITICAL(&g_sntp_mux);
+	g_prefix_minute = -1;
+	portEXIT_CRITICAL(&g_sntp_mux);
+
+	if (true == gb_started)
+	{
+		return;
+	}
+
+	gb_started = true;
+
+	ESP_LOGI(g_tag, "init SNTP service");
+
+	sntp_setoperatingmode(SNTP_OPMODE_POLL);
+	sntp_time_sync_set_servers();
+
+#if CONFIG_LWIP_DHCP_GET_NTP_SRV
+	// A lease with NTP servers (renewals too) writes them from slot 0 and
+	// clears every other slot. The station posts IP_EVENT_STA_GOT_IP on
+	// every bind, the configured names go back after the DHCP ones then.
+	// The loop may not exist yet when this runs before the WiFi task.
+	//
+	err = esp_event_loop_create_default();
+
+	if ((ESP_OK == err) || (ESP_ERR_INVALID_STATE == err))
+	{
+		err = esp_event_handler_register(IP_EVENT, IP_EVENT_STA_GOT_IP,
+										 &sntp_time_sync_got_ip, NULL);
+	}
+
+	if (ESP_OK != err)
+	{
+		ESP_LOGE(g_tag, "sntp_time_sync_start: no lease handler, %s",
+				 esp_err_to_name(err));
+	}
+#endif
+
+	// The first sync from 1970 is too far for adjtime() and steps the
+	// clock, the following ones are slewed
+	//
+	sntp_set_sync_mode(SNTP_SYNC_MODE_SMOOTH);
+	sntp_set_time_sync_notification_cb(sntp_time_sync_notification);
+	sntp_set_sync_interval(CONFIG_SNTP_TIME_SYNC_INTERVAL_MIN_S * 1000U);
+	sntp_init();
+}
+
+esp_err_t
+sntp_time_sync_subscribe (sntp_time_sync_cb_t cb, void * p_arg)
+{
+	sntp_time_sync_event_t event = {0};
+	bool b_valid = false;
+
+	if (NULL == cb)
+	{
+		return ESP_ERR_INVALID_ARG;
+	}
+
+	portENTER_CRITICAL(&g_sntp_mux);
+
+	if (g_subscriber_count >= SNTP_TIME_SYNC_MAX_SUBSCRIBERS)
+	{
+		portEXIT_CRITICAL(&g_sntp_mux);
+
+		return ESP_ERR_NO_MEM;
+	}
+
+	g_subscribers[g_subscriber_count].cb = cb;
+	g_subscribers[g_subscriber_count].p_arg = p_arg;
+	++g_subscriber_count;
+
+	b_valid = g_status.b_valid;
+	event.offset_us = g_status.offset_us;
+	event.drift_ppb = g_status.drift_ppb;
+	event.interval_s = g_status.interval_s;
+	portEXIT_CRITICAL(&g_sntp_mux);
+
+	// A late subscriber does not miss the valid time
+	//
+	if (true == b_valid)
+	{
+		event.b_first = true;
+		cb(&event, p_arg);
+	}
+
+	return ESP_OK;
+}
+
+bool
+sntp_time_sync_is_valid (void)
+{
+	bool b_valid = false;
+
+	portENTER_CRITICAL(&g_sntp_mux);
+	b_valid = g_status.b_valid;
+	portEXIT_CRITICAL(&g_sntp_mux);
+
+	return b_valid;
+}
+
+void
+sntp_time_sync_get_status (sntp_time_sync_status_t * p_status)
+{
+	if (NULL == p_status)
+	{
+		return;
+	}
+
+	portENTER_CRITICAL(&g_sntp_mux);
+	*p_status = g_status;
+	portEXIT_CRITICAL(&g_sntp_mux);
+}
+
+int64_t
+sntp_time_sync_now_ms (void)
+{
+	struct timeval now = {0};
+
+	if (false == sntp_time_sync_is_valid())
+	{
+		return 0;
+	}
+
+	gettimeofday(&now, NULL);
+
+	return (int64_t) now.tv_sec * 1000LL + now.tv_usec / 1000;
+}
+
+size_t
+sntp_time_sync_format (int64_t epoch_ms, char * p_buf, size_t size)
+{
+	char prefix[SNTP_TIME_SYNC_PREFIX_LEN + 1] = {0};
+	int64_t minute = 0;
+	uint8_t second = 0;
+	bool b_cached = false;
+
+	if ((NULL == p_buf) || (size < SNTP_TIME_SYNC_TIME_LEN + 1) ||
+		(epoch_ms < 0))
+	{
+		return 0;
+	}
+
+	// Time zones are whole minutes away from UTC, so the seconds are
+	// the same in local time
+	//
+	minute = epoch_ms / 60000;
+	second = (uint8_t) ((epoch_ms / 1000) % 60);
+
+	portENTER_CRITICAL(&g_sntp_mux);
+
+	if (minute == g_prefix_minute)
+	{
+		memcpy(prefix, g_prefix, sizeof(prefix));
+		b_cached = true;
+	}
+
+	portEXIT_CRITICAL(&g_sntp_mux);
+
+	if (false == b_cached)
+	{
+		time_t minute_start = (time_t) (minute * 60);
+		struct tm time_info = {0};
+
+		localtime_r(&minute_start, &time_info);
+
+		if (SNTP_TIME_SYNC_PREFIX_LEN != strftime(prefix, sizeof(prefix),
+												  "%d.%m.%Y %H:%M:",
+												  &time_info))
+		{
+			return 0;
+		}
+
+		portENTER_CRITICAL(&g_sntp_mux);
+		memcpy(g_prefix, prefix, sizeof(g_prefix));
+		g_prefix_minute = minute;
+		portEXIT_CRITICAL(&g_sntp_mux);
+	}
+
+	memcpy(p_buf, prefix, SNTP_TIME_SYNC_PREFIX_LEN);
+	p_buf[SNTP_TIME_SYNC_PREFIX_LEN] = (char) ('0' + second / 10);
+	p_buf[SNTP_TIME_SYNC_PREFIX_LEN + 1] = (char) ('0' + second % 10);
+	p_buf[SNTP_TIME_SYNC_TIME_LEN] = '\0';
+
+	return SNTP_TIME_SYNC_TIME_LEN;
+}
+
+// Keeps the servers DHCP wrote in the first slots, they hold an address
+// and no name, and puts the configured names after them
+//
+static void
+sntp_time_sync_set_servers (void)
+{
+	uint8_t slot = 0;
+
+	while ((slot < CONFIG_LWIP_SNTP_MAX_SERVERS) &&
+		   (NULL == sntp_getservername(slot)) &&
+		   (NULL != sntp_getserver(slot)) &&
+		   (false == ip_addr_isany(sntp_getserver(slot))))
+	{
+		ESP_LOGI(g_tag, "server %u from DHCP", slot);
+		++slot;
+	}
+
+	for (uint8_t idx = 0;
+		 (idx < sizeof(g_servers) / sizeof(g_servers[0])) &&
+		 (slot < CONFIG_LWIP_SNTP_MAX_SERVERS);
+		 ++idx)
+	{
+		if ('\0' != g_servers[idx][0])
+		{
+			sntp_setservername(slot, g_servers[idx]);
+			++slot;
+		}
+	}
+}
+
+#if CONFIG_LWIP_DHCP_GET_NTP_SRV
+// Runs on the event loop task, the slots belong to the LwIP task
+//
+static void
+sntp_time_sync_got_ip (void * p_arg, esp_event_base_t event_base,
+					   int32_t event_id, void * p_event_data)
+{
+	if (ERR_OK != tcpip_callback(sntp_time_sync_lease_servers, NULL))
+	{
+		ESP_LOGW(g_tag, "sntp_time_sync_got_ip: servers not restored");
+	}
+}
+
+static void
+sntp_time_sync_lease_servers (void * p_arg)
+{
+	sntp_time_sync_set_servers();
+}
+#endif
+
+// Runs on the LwIP task once the new time has been handed to the
+// clock. In smooth mode the slew has only just started, so the local
+// time still shows the error accumulated since the last sync.
+//
+static void
+sntp_time_sync_notification (struct timeval * p_tv)
+{
+	sntp_time_sync_event_t event = {0};
+	struct timeval now = {0};
+	int64_t mono_us = esp_timer_get_time();
+	int64_t elapsed_us = 0;
+	int32_t drift_ppb = 0;
+
+	gettimeofday(&now, NULL);
+	event.offset_us = ((int64_t) p_tv->tv_sec - now.tv_sec) * 1000000LL +
+					  (p_tv->tv_usec - now.tv_usec);
+
+	portENTER_CRITICAL(&g_sntp_mux);
+	event.b_first = (false == g_status.b_valid);
+	elapsed_us = mono_us - g_status.last_sync_us;
+	drift_ppb = g_status.drift_ppb;
+	portEXIT_CRITICAL(&g_sntp_mux);
+
+	// A step leaves nothing to measure: the clock already shows the
+	// server time
+	//
+	event.b_stepped = (true == event.b_first) ||
+					  (llabs(event.offset_us) >= SNTP_TIME_SYNC_DRIFT_MAX_OFFSET_US);
+
+	if ((false == event.b_stepped) && (elapsed_us > 0))
+	{
+		int32_t sample_ppb = (int32_t) (event.offset_us * 1000000000LL / elapsed_us);
+
+		// The first sample is taken as is, the next ones are averaged
+		// to ride out the network jitter
+		//
+		drift_ppb = (false == gb_drift_measured) ? sample_ppb :
+					(3 * drift_ppb + sample_ppb) / 4;
+		gb_drift_measured = true;
+	}
+
+	event.drift_ppb = drift_ppb;
+	event.interval_s = sntp_time_sync_next_interval(drift_ppb);
+
+	// lwIP schedules the next request with this value right after the
+	// callback returns
+	//
+	sntp_set_sync_interval(event.interval_s * 1000U);
+
+	portENTER_CRITICAL(&g_sntp_mux);
+	g_status.b_valid = true;
+	++g_status.sync_count;
+	g_status.last_sync_us = mono_us;
+	g_status.offset_us = event.offset_us;
+	g_status.drift_ppb = drift_ppb;
+	g_status.interval_s = event.interval_s;
+	portEXIT_CRITICAL(&g_sntp_mux);
+
+	ESP_LOGI(g_tag, "sync: offset %lld us%s, drift %d ppb, next in %u s",
+			 event.offset_us, (true == event.b_stepped) ? " (step)" : "",
+			 drift_ppb, event.interval_s);
+
+	for (uint8_t idx = 0; idx < g_subscriber_count; ++idx)
+	{
+		g_subscribers[idx].cb(&event, g_subscribers[idx].p_arg);
+	}
+}
+
+// Longest interval that keeps the drift within the allowed error, the
+// shortest one until the drift has been measured
+//
+static uint32_t
+sntp_time_sync_next_interval (int32_t drift_ppb)
+{
+	int64_t interval_s = CONFIG_SNTP_TIME_SYNC_INTERVAL_MIN_S;
+
+	if ((true == gb_drift_measured) && (0 == drift_ppb))
+	{
+		interval_s = CONFIG_SNTP_TIME_SYNC_INTERVAL_MAX_S;
+	}
+	else if (true == gb_drift_measured)
+	{
+		interval_s = (int64_t) CONFIG_SNTP_TIME_SYNC_MAX_OFFSET_MS * 1000000LL /
+					 llabs(drift_ppb);
+	}
+
+	if (interval_s < CONFIG_SNTP_TIME_SYNC_INTERVAL_MIN_S)
+	{
+		interval_s = CONFIG_SNTP_TIME_SYNC_INTERVAL_MIN_S;
+	}
+	else if (interval_s > CONFIG_SNTP_TIME_SYNC_INTERVAL_MAX_S)
+	{
+		interval_s = CONFIG_SNTP_TIME_SYNC_INTERVAL_MAX_S;
+	}
+
+	return (uint32_t) interval_s;
+}
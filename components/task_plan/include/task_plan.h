@@ -0,0 +1,62 @@
+/*
+ * task_plan.h
+ *
+ *  Created on: 19 oct 2026
+ *      Author: Filippo
+ */
+
+#ifndef COMPONENTS_TASK_PLAN_H_
+#	define COMPONENTS_TASK_PLAN_H_
+
+#	include <stddef.h>
+#	include "freertos/FreeRTOS.h"
+#	include "esp_err.h"
+
+// Application tasks with a configurable placement
+//
+typedef enum task_plan_id
+{
+	TASK_PLAN_WIFI_APP = 0,
+	TASK_PLAN_HTTP_SERVER,
+	TASK_PLAN_HTTP_SERVER_MONITOR,
+	TASK_PLAN_HTTP_BULK,
+	TASK_PLAN_BUTTON,
+	TASK_PLAN_AWS_IOT,
+	TASK_PLAN_SENSOR,
+	TASK_PLAN_OTA_PULL,
+	TASK_PLAN_CAPTIVE_DNS,
+	TASK_PLAN_RGB_LED,
+	TASK_PLAN_MAX
+} task_plan_id_t;
+
+typedef struct task_plan_entry
+{
+	const char * p_name;		// NVS key and report label
+	UBaseType_t priority;
+	BaseType_t core_id;			// tskNO_AFFINITY to run on either core
+} task_plan_entry_t;
+
+// Placement of a task: the Kconfig default, or the NVS override
+//
+const task_plan_entry_t * task_plan_get(task_plan_id_t id);
+
+// Saves a placement in NVS, used from the next boot. A core_id of -1
+// lets the task run on either core.
+//
+esp_err_t task_plan_set(const char * p_name, UBaseType_t priority,
+						BaseType_t core_id);
+
+// JSON array with the placement of every task, returns the length
+//
+size_t task_plan_format_json(char * p_buf, size_t size);
+
+// Runs the placement benchmark once, in the background
+// (CONFIG_TASK_PLAN_BENCHMARK)
+//
+void task_plan_benchmark_start(void);
+
+// JSON object with the last benchmark report, "null" when there is none
+//
+size_t task_plan_benchmark_format_json(char * p_buf, size_t size);
+
+#endif /* COMPONENTS_TASK_PLAN_H_ */
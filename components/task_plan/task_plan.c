@@ -0,0 +1,210 @@
+/*
+ * task_plan.c
+ *
+ *  Created on: 19 oct 2026
+ *      Author: Filippo
+ */
+
+#include "task_plan.h"
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include "freertos/task.h"
+#include "nvs_flash.h"
+#include "esp_log.h"
+#include "sdkconfig.h"
+
+// Kconfig cores, -1 for either core
+//
+#define TASK_PLAN_CORE(core)		((core) < 0 ? tskNO_AFFINITY : (core))
+
+static const char g_tag[] = "task_plan";
+static const char g_task_plan_namespace[] = "task_plan";
+
+static task_plan_entry_t g_plan[TASK_PLAN_MAX] = {
+	[TASK_PLAN_WIFI_APP] = {
+		"wifi_app",
+		CONFIG_TASK_PLAN_WIFI_APP_PRIORITY,
+		TASK_PLAN_CORE(CONFIG_TASK_PLAN_WIFI_APP_CORE_ID)
+	},
+	[TASK_PLAN_HTTP_SERVER] = {
+		"http_server",
+		CONFIG_TASK_PLAN_HTTP_SERVER_PRIORITY,
+		TASK_PLAN_CORE(CONFIG_TASK_PLAN_HTTP_SERVER_CORE_ID)
+	},
+	[TASK_PLAN_HTTP_SERVER_MONITOR] = {
+		"http_monitor",
+		CONFIG_TASK_PLAN_HTTP_SERVER_MONITOR_PRIORITY,
+		TASK_PLAN_CORE(CONFIG_TASK_PLAN_HTTP_SERVER_MONITOR_CORE_ID)
+	},
+	[TASK_PLAN_HTTP_BULK] = {
+		"http_bulk",
+		CONFIG_TASK_PLAN_HTTP_BULK_PRIORITY,
+		TASK_PLAN_CORE(CONFIG_TASK_PLAN_HTTP_BULK_CORE_ID)
+	},
+	[TASK_PLAN_BUTTON] = {
+		"button",
+		CONFIG_TASK_PLAN_BUTTON_PRIORITY,
+		TASK_PLAN_CORE(CONFIG_TASK_PLAN_BUTTON_CORE_ID)
+	},
+	[TASK_PLAN_AWS_IOT] = {
+		"aws_iot",
+		CONFIG_TASK_PLAN_AWS_IOT_PRIORITY,
+		TASK_PLAN_CORE(CONFIG_TASK_PLAN_AWS_IOT_CORE_ID)
+	},
+	[TASK_PLAN_SENSOR] = {
+		"sensor",
+		CONFIG_TASK_PLAN_SENSOR_PRIORITY,
+		TASK_PLAN_CORE(CONFIG_TASK_PLAN_SENSOR_CORE_ID)
+	},
+	[TASK_PLAN_OTA_PULL] = {
+		"ota_pull",
+		CONFIG_TASK_PLAN_OTA_PULL_PRIORITY,
+		TASK_PLAN_CORE(CONFIG_TASK_PLAN_OTA_PULL_CORE_ID)
+	},
+	[TASK_PLAN_CAPTIVE_DNS] = {
+		"captive_dns",
+		CONFIG_TASK_PLAN_CAPTIVE_DNS_PRIORITY,
+		TASK_PLAN_CORE(CONFIG_TASK_PLAN_CAPTIVE_DNS_CORE_ID)
+	},
+	[TASK_PLAN_RGB_LED] = {
+		"rgb_led",
+		CONFIG_TASK_PLAN_RGB_LED_PRIORITY,
+		TASK_PLAN_CORE(CONFIG_TASK_PLAN_RGB_LED_CORE_ID)
+	}
+};
+
+static bool gb_plan_loaded = false;
+
+static void task_plan_load(void);
+
+const task_plan_entry_t *
+task_plan_get (task_plan_id_t id)
+{
+	if (id >= TASK_PLAN_MAX)
+	{
+		return NULL;
+	}
+
+	if (false == gb_plan_loaded)
+	{
+		task_plan_load();
+	}
+
+	return &g_plan[id];
+}
+
+esp_err_t
+task_plan_set (const char * p_name, UBaseType_t priority, BaseType_t core_id)
+{
+	nvs_handle h_nvs = 0;
+	esp_err_t err = ESP_ERR_NOT_FOUND;
+	uint8_t id = 0;
+
+	if ((NULL == p_name) || (0 == priority) || (priority >= configMAX_PRIORITIES) ||
+		(core_id < -1) || (core_id >= portNUM_PROCESSORS))
+	{
+		return ESP_ERR_INVALID_ARG;
+	}
+
+	while ((id < TASK_PLAN_MAX) && (0 != strcmp(g_plan[id].p_name, p_name)))
+	{
+		id++;
+	}
+
+	if (TASK_PLAN_MAX == id)
+	{
+		return ESP_ERR_NOT_FOUND;
+	}
+
+	err = nvs_open(g_task_plan_namespace, NVS_READWRITE, &h_nvs);
+
+	if (ESP_OK != err)
+	{
+		return err;
+	}
+
+	// Priority in the high byte, core + 1 in the low byte (0 = either core)
+	//
+	err = nvs_set_u16(h_nvs, g_plan[id].p_name,
+					  (uint16_t) ((priority << 8) | (uint8_t) (core_id + 1)));
+
+	if (ESP_OK == err)
+	{
+		err = nvs_commit(h_nvs);
+	}
+
+	nvs_close(h_nvs);
+
+	ESP_LOGI(g_tag, "task_plan_set: %s priority %u core %d from the next boot",
+			 p_name, priority, core_id);
+
+	return err;
+}
+
+size_t
+task_plan_format_json (char * p_buf, size_t size)
+{
+	int32_t len = snprintf(p_buf, size, "[");
+
+	for (uint8_t id = 0; (id < TASK_PLAN_MAX) && (len > 0) && ((size_t) len < size); ++id)
+	{
+		const task_plan_entry_t * p_entry = task_plan_get((task_plan_id_t) id);
+
+		len += snprintf(p_buf + len, size - len,
+						"%s{\"name\":\"%s\",\"priority\":%u,\"core\":%d}",
+						(0 == id) ? "" : ",", p_entry->p_name, p_entry->priority,
+						(tskNO_AFFINITY == p_entry->core_id) ? -1 : p_entry->core_id);
+	}
+
+	if ((len > 0) && ((size_t) (len + 2) <= size))
+	{
+		len += snprintf(p_buf + len, size - len, "]");
+	}
+	else
+	{
+		len = 0;
+		p_buf[0] = '\0';
+	}
+
+	return (size_t) len;
+}
+
+static void
+task_plan_load (void)
+{
+#if CONFIG_TASK_PLAN_NVS
+	nvs_handle h_nvs = 0;
+	esp_err_t err = nvs_open(g_task_plan_namespace, NVS_READONLY, &h_nvs);
+
+	// Nothing saved yet, or no NVS in this project: Kconfig defaults
+	//
+	if (ESP_OK != err)
+	{
+		ESP_LOGD(g_tag, "task_plan_load: %s", esp_err_to_name(err));
+		gb_plan_loaded = true;
+
+		return;
+	}
+
+	for (uint8_t id = 0; id < TASK_PLAN_MAX; ++id)
+	{
+		uint16_t value = 0;
+
+		if (ESP_OK == nvs_get_u16(h_nvs, g_plan[id].p_name, &value))
+		{
+			g_plan[id].priority = value >> 8;
+			g_plan[id].core_id = (0 == (value & 0xFF)) ?
+								 tskNO_AFFINITY : (BaseType_t) ((value & 0xFF) - 1);
+
+			ESP_LOGI(g_tag, "task_plan_load: %s priority %u core %d (NVS)",
+					 g_plan[id].p_name, g_plan[id].priority,
+					 (tskNO_AFFINITY == g_plan[id].core_id) ? -1 : g_plan[id].core_id);
+		}
+	}
+
+	nvs_close(h_nvs);
+#endif
+
+	gb_plan_loaded = true;
+}
@@ -0,0 +1,501 @@
+/*
+ * task_plan_bench.c
+ *
+ *  Created on: 19 oct 2026
+ *      Author: Filippo
+ */
+
+#include "task_plan.h"
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "freertos/task.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+#include "sdkconfig.h"
+
+#if CONFIG_TASK_PLAN_BENCHMARK
+
+#	include "lwip/sockets.h"
+#	include "mbedtls/sha256.h"
+
+#	define TASK_PLAN_BENCH_STACK_SIZE	4096
+#	define TASK_PLAN_BENCH_PRIORITY		2
+#	define TASK_PLAN_LOAD_STACK_SIZE	3072
+
+// Bytes hashed per simulated publish, about one TLS record
+//
+#	define TASK_PLAN_CRYPTO_BYTES		2048
+
+// A DHT22 transfer lasts about 4 ms; its bits are 26 or 70 us long, so a
+// larger gap while bit-banging corrupts the read
+//
+#	define TASK_PLAN_BITBANG_US			4000
+#	define TASK_PLAN_BITBANG_GAP_US		20
+
+#	define TASK_PLAN_REPORT_SIZE		2048
+#	define TASK_PLAN_HTTP_BUFFER_SIZE	512
+
+typedef struct task_plan_load task_plan_load_t;
+typedef esp_err_t (*task_plan_load_cb_t)(task_plan_load_t * p_load);
+
+struct task_plan_load
+{
+	const char * p_name;
+	task_plan_id_t plan_id;		// Placement used, TASK_PLAN_MAX for none
+	uint32_t period_ms;
+	task_plan_load_cb_t cb;
+
+	// Results, written by the load task only
+	//
+	uint32_t count;
+	uint32_t errors;
+	int64_t op_sum_us;
+	int64_t op_max_us;
+	int64_t late_sum_us;
+	int64_t late_max_us;
+	int64_t value_max;			// Load specific, see the callbacks
+	TaskHandle_t h_task;
+};
+
+static const char g_tag[] = "task_plan";
+
+static esp_err_t task_plan_load_http(task_plan_load_t * p_load);
+static esp_err_t task_plan_load_crypto(task_plan_load_t * p_load);
+static esp_err_t task_plan_load_bitbang(task_plan_load_t * p_load);
+
+static task_plan_load_t g_loads[] = {
+	{ "http", TASK_PLAN_MAX, 200, task_plan_load_http },
+	{ "mqtt_publish", TASK_PLAN_AWS_IOT, 100, task_plan_load_crypto },
+	{ "sensor_read", TASK_PLAN_SENSOR, 250, task_plan_load_bitbang }
+};
+
+#	define TASK_PLAN_LOAD_COUNT		(sizeof(g_loads) / sizeof(g_loads[0]))
+
+static TaskHandle_t gh_task_plan_bench = NULL;
+static TaskHandle_t gh_bench_waiter = NULL;
+static volatile bool gb_loads_running = false;
+static char * gp_report = NULL;
+
+static void task_plan_bench(void * p_param);
+static void task_plan_load_task(void * p_param);
+static UBaseType_t task_plan_sample(TaskStatus_t * p_status, uint32_t * p_total);
+static void task_plan_report(const TaskStatus_t * p_begin, UBaseType_t begin_count,
+							 const TaskStatus_t * p_end, UBaseType_t end_count,
+							 uint32_t total_delta);
+
+void
+task_plan_benchmark_start (void)
+{
+	if (NULL != gh_task_plan_bench)
+	{
+		return;
+	}
+
+	xTaskCreatePinnedToCore(task_plan_bench, "task_plan_bench",
+							TASK_PLAN_BENCH_STACK_SIZE, NULL,
+							TASK_PLAN_BENCH_PRIORITY, &gh_task_plan_bench,
+							tskNO_AFFINITY);
+}
+
+size_t
+task_plan_benchmark_format_json (char * p_buf, size_t size)
+{
+	const char * p_report = __atomic_load_n(&gp_report, __ATOMIC_ACQUIRE);
+
+	return (size_t) snprintf(p_buf, size, "%s", (NULL != p_report) ? p_report : "null");
+}
+
+static void
+task_plan_bench (void * p_param)
+{
+	TaskStatus_t * p_begin = calloc(2 * CONFIG_TASK_PLAN_BENCHMARK_MAX_TASKS,
+									sizeof(TaskStatus_t));
+	TaskStatus_t * p_end = p_begin + CONFIG_TASK_PLAN_BENCHMARK_MAX_TASKS;
+	UBaseType_t begin_count = 0;
+	UBaseType_t end_count = 0;
+	uint32_t total_begin = 0;
+	uint32_t total_end = 0;
+
+	vTaskDelay(pdMS_TO_TICKS(CONFIG_TASK_PLAN_BENCHMARK_DELAY_S * 1000));
+
+	if (NULL == p_begin)
+	{
+		ESP_LOGE(g_tag, "task_plan_bench: no memory");
+		vTaskDelete(NULL);
+	}
+
+	ESP_LOGI(g_tag, "task_plan_bench: running for %d s",
+			 CONFIG_TASK_PLAN_BENCHMARK_DURATION_S);
+
+	gh_bench_waiter = xTaskGetCurrentTaskHandle();
+	gb_loads_running = true;
+	begin_count = task_plan_sample(p_begin, &total_begin);
+
+	for (uint8_t idx = 0; idx < TASK_PLAN_LOAD_COUNT; ++idx)
+	{
+		task_plan_load_t * p_load = &g_loads[idx];
+		UBaseType_t priority = 1;
+		BaseType_t core_id = tskNO_AFFINITY;
+
+		// Loads standing in for a task run where that task would run
+		//
+		if (TASK_PLAN_MAX != p_load->plan_id)
+		{
+			priority = task_plan_get(p_load->plan_id)->priority;
+			core_id = task_plan_get(p_load->plan_id)->core_id;
+		}
+
+		xTaskCreatePinnedToCore(task_plan_load_task, p_load->p_name,
+								TASK_PLAN_LOAD_STACK_SIZE, p_load, priority,
+								&p_load->h_task, core_id);
+	}
+
+	vTaskDelay(pdMS_TO_TICKS(CONFIG_TASK_PLAN_BENCHMARK_DURATION_S * 1000));
+
+	// CPU window ends while the loads still run
+	//
+	end_count = task_plan_sample(p_end, &total_end);
+	gb_loads_running = false;
+
+	for (uint8_t idx = 0; idx < TASK_PLAN_LOAD_COUNT; ++idx)
+	{
+		ulTaskNotifyTake(pdFALSE, portMAX_DELAY);
+	}
+
+	task_plan_report(p_begin, begin_count, p_end, end_count, total_end - total_begin);
+	free(p_begin);
+
+	gh_bench_waiter = NULL;
+	vTaskDelete(NULL);
+}
+
+static void
+task_plan_load_task (void * p_param)
+{
+	task_plan_load_t * p_load = (task_plan_load_t *) p_param;
+	int64_t period_us = (int64_t) p_load->period_ms * 1000;
+	int64_t next_us = 0;
+	TickType_t wake_tick = xTaskGetTickCount();
+
+	while (true == gb_loads_running)
+	{
+		int64_t start_us = 0;
+		int64_t late_us = 0;
+
+		vTaskDelayUntil(&wake_tick, pdMS_TO_TICKS(p_load->period_ms));
+
+		// Wake up latency against the first wake up, which sets the tick
+		// phase
+		//
+		start_us = esp_timer_get_time();
+		next_us = (0 == next_us) ? start_us : (next_us + period_us);
+		late_us = (start_us > next_us) ? (start_us - next_us) : 0;
+
+		if (ESP_OK != p_load->cb(p_load))
+		{
+			p_load->errors++;
+		}
+
+		start_us = esp_timer_get_time() - start_us;
+		p_load->count++;
+		p_load->op_sum_us += start_us;
+		p_load->late_sum_us += late_us;
+		p_load->op_max_us = (start_us > p_load->op_max_us) ? start_us : p_load->op_max_us;
+		p_load->late_max_us = (late_us > p_load->late_max_us) ? late_us : p_load->late_max_us;
+	}
+
+	xTaskNotifyGive(gh_bench_waiter);
+	vTaskDelete(NULL);
+}
+
+// One GET to our own server over the loopback interface. The server keeps
+// the connection open, so the response ends after Content-Length bytes or
+// with the last chunk.
+//
+static esp_err_t
+task_plan_load_http (task_plan_load_t * p_load)
+{
+	struct sockaddr_in addr = {
+		.sin_family = AF_INET,
+		.sin_port = htons(80),
+		.sin_addr.s_addr = htonl(INADDR_LOOPBACK)
+	};
+	struct timeval timeout = { .tv_sec = 2, .tv_usec = 0 };
+	char buffer[TASK_PLAN_HTTP_BUFFER_SIZE] = {0};
+	const char * p_body = NULL;
+	const char * p_length = NULL;
+	int32_t len = 0;
+	int32_t received = 0;
+	int32_t expected = -1;
+	esp_err_t err = ESP_FAIL;
+	int sock = socket(AF_INET, SOCK_STREAM, IPPROTO_IP);
+
+	if (sock < 0)
+	{
+		return ESP_FAIL;
+	}
+
+	setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+	len = snprintf(buffer, sizeof(buffer),
+				   "GET %s HTTP/1.1\r\nHost: localhost\r\n\r\n",
+				   CONFIG_TASK_PLAN_BENCHMARK_HTTP_URI);
+
+	if ((0 != connect(sock, (struct sockaddr *) &addr, sizeof(addr))) ||
+		(len != send(sock, buffer, len, 0)))
+	{
+		close(sock);
+
+		return ESP_FAIL;
+	}
+
+	// Headers
+	//
+	len = 0;
+
+	while ((NULL == p_body) && (len < (int32_t) (sizeof(buffer) - 1)))
+	{
+		int32_t chunk = recv(sock, buffer + len, sizeof(buffer) - 1 - len, 0);
+
+		if (chunk <= 0)
+		{
+			break;
+		}
+
+		len += chunk;
+		buffer[len] = '\0';
+		p_body = strstr(buffer, "\r\n\r\n");
+	}
+
+	if ((NULL != p_body) && (0 == strncmp(buffer, "HTTP/1.1 200", 12)))
+	{
+		p_length = strstr(buffer, "Content-Length: ");
+		expected = (NULL != p_length) ? atoi(p_length + 16) : -1;
+		received = len - (p_body + 4 - buffer);
+
+		// Body, fixed length or chunked
+		//
+		while ((expected < 0) ? ((len < 5) || (0 != memcmp(&buffer[len - 5], "0\r\n\r\n", 5))) :
+			   (received < expected))
+		{
+			len = recv(sock, buffer, sizeof(buffer), 0);
+
+			if (len <= 0)
+			{
+				break;
+			}
+
+			received += len;
+		}
+
+		err = (len > 0) ? ESP_OK : ESP_FAIL;
+	}
+
+	close(sock);
+
+	// Largest response body, in bytes
+	//
+	p_load->value_max = (received > p_load->value_max) ? received : p_load->value_max;
+
+	return err;
+}
+
+// What a publish costs the MQTT task besides the socket: hashing a TLS
+// record
+//
+static esp_err_t
+task_plan_load_crypto (task_plan_load_t * p_load)
+{
+	static uint8_t record[TASK_PLAN_CRYPTO_BYTES];
+	uint8_t digest[32] = {0};
+
+	record[0]++;
+
+	return (0 == mbedtls_sha256_ret(record, sizeof(record), digest, 0)) ?
+		   ESP_OK : ESP_FAIL;
+}
+
+// Busy loop as long as a DHT22 transfer, the longest gap between two
+// time reads is what a preemption or an interrupt would have stolen
+// from the bit timing
+//
+static esp_err_t
+task_plan_load_bitbang (task_plan_load_t * p_load)
+{
+	int64_t start_us = esp_timer_get_time();
+	int64_t prev_us = start_us;
+	int64_t now_us = start_us;
+	int64_t gap_max_us = 0;
+
+	while ((now_us - start_us) < TASK_PLAN_BITBANG_US)
+	{
+		now_us = esp_timer_get_time();
+
+		if ((now_us - prev_us) > gap_max_us)
+		{
+			gap_max_us = now_us - prev_us;
+		}
+
+		prev_us = now_us;
+	}
+
+	p_load->value_max = (gap_max_us > p_load->value_max) ? gap_max_us : p_load->value_max;
+
+	return (gap_max_us > TASK_PLAN_BITBANG_GAP_US) ? ESP_FAIL : ESP_OK;
+}
+
+static UBaseType_t
+task_plan_sample (TaskStatus_t * p_status, uint32_t * p_total)
+{
+	UBaseType_t count = uxTaskGetSystemState(p_status,
+											 CONFIG_TASK_PLAN_BENCHMARK_MAX_TASKS,
+											 p_total);
+
+	if (0 == count)
+	{
+		ESP_LOGW(g_tag, "task_plan_sample: more than %d tasks",
+				 CONFIG_TASK_PLAN_BENCHMARK_MAX_TASKS);
+	}
+
+	return count;
+}
+
+static void
+task_plan_report (const TaskStatus_t * p_begin, UBaseType_t begin_count,
+				  const TaskStatus_t * p_end, UBaseType_t end_count,
+				  uint32_t total_delta)
+{
+	char * p_report = malloc(TASK_PLAN_REPORT_SIZE);
+	int32_t len = 0;
+
+	if ((NULL == p_report) || (0 == total_delta))
+	{
+		free(p_report);
+		ESP_LOGE(g_tag, "task_plan_report: no report");
+
+		return;
+	}
+
+	len = snprintf(p_report, TASK_PLAN_REPORT_SIZE, "{\"duration_s\":%d,\"cores\":[",
+				   CONFIG_TASK_PLAN_BENCHMARK_DURATION_S);
+
+	// Each core is busy for the time its idle task did not run
+	//
+	for (UBaseType_t core = 0; core < portNUM_PROCESSORS; ++core)
+	{
+		TaskHandle_t h_idle = xTaskGetIdleTaskHandleForCPU(core);
+		uint32_t idle = 0;
+
+		for (UBaseType_t idx = 0; idx < end_count; ++idx)
+		{
+			if (p_end[idx].xHandle == h_idle)
+			{
+				idle = p_end[idx].ulRunTimeCounter;
+			}
+		}
+
+		for (UBaseType_t idx = 0; idx < begin_count; ++idx)
+		{
+			if (p_begin[idx].xHandle == h_idle)
+			{
+				idle -= p_begin[idx].ulRunTimeCounter;
+			}
+		}
+
+		ESP_LOGI(g_tag, "core %u: %u permille busy", core,
+				 1000 - (uint32_t) (((uint64_t) idle * 1000) / total_delta));
+		len += snprintf(p_report + len, TASK_PLAN_REPORT_SIZE - len,
+						"%s{\"core\":%u,\"busy_permille\":%u}", (0 == core) ? "" : ",",
+						core, 1000 - (uint32_t) (((uint64_t) idle * 1000) / total_delta));
+	}
+
+	len += snprintf(p_report + len, TASK_PLAN_REPORT_SIZE - len, "],\"loads\":[");
+
+	for (uint8_t idx = 0; idx < TASK_PLAN_LOAD_COUNT; ++idx)
+	{
+		const task_plan_load_t * p_load = &g_loads[idx];
+		uint32_t count = (0 == p_load->count) ? 1 : p_load->count;
+
+		ESP_LOGI(g_tag, "%s: %u runs, %u errors, op avg %lld max %lld us, "
+				 "late avg %lld max %lld us, max value %lld",
+				 p_load->p_name, p_load->count, p_load->errors,
+				 p_load->op_sum_us / count, p_load->op_max_us,
+				 p_load->late_sum_us / count, p_load->late_max_us, p_load->value_max);
+		len += snprintf(p_report + len, TASK_PLAN_REPORT_SIZE - len,
+						"%s{\"name\":\"%s\",\"count\":%u,\"errors\":%u,"
+						"\"op_avg_us\":%lld,\"op_max_us\":%lld,"
+						"\"late_avg_us\":%lld,\"late_max_us\":%lld,\"value_max\":%lld}",
+						(0 == idx) ? "" : ",", p_load->p_name, p_load->count,
+						p_load->errors, p_load->op_sum_us / count, p_load->op_max_us,
+						p_load->late_sum_us / count, p_load->late_max_us,
+						p_load->value_max);
+	}
+
+	len += snprintf(p_report + len, TASK_PLAN_REPORT_SIZE - len, "],\"tasks\":[");
+
+	// Share of one core used by every task alive at both ends of the window
+	//
+	for (UBaseType_t idx = 0, written = 0; idx < end_count; ++idx)
+	{
+		for (UBaseType_t prev = 0; prev < begin_count; ++prev)
+		{
+			if (p_begin[prev].xTaskNumber == p_end[idx].xTaskNumber)
+			{
+				uint32_t cpu = (uint32_t) (((uint64_t) (p_end[idx].ulRunTimeCounter -
+										   p_begin[prev].ulRunTimeCounter) * 1000) /
+										   total_delta);
+				int32_t core = -1;
+				int32_t needed = 0;
+
+#	if configTASKLIST_INCLUDE_COREID
+				core = (tskNO_AFFINITY == p_end[idx].xCoreID) ? -1 : p_end[idx].xCoreID;
+#	endif
+
+				ESP_LOGI(g_tag, "task %s: core %d priority %u, %u permille",
+						 p_end[idx].pcTaskName, core, p_end[idx].uxCurrentPriority, cpu);
+
+				needed = snprintf(p_report + len, TASK_PLAN_REPORT_SIZE - len,
+								  "%s{\"name\":\"%s\",\"core\":%d,\"priority\":%u,"
+								  "\"cpu_permille\":%u}", (0 == written) ? "" : ",",
+								  p_end[idx].pcTaskName, core,
+								  p_end[idx].uxCurrentPriority, cpu);
+
+				// Keeps room for the closing brackets
+				//
+				if ((len + needed + 3) < TASK_PLAN_REPORT_SIZE)
+				{
+					len += needed;
+					written++;
+				}
+				else
+				{
+					p_report[len] = '\0';
+				}
+
+				break;
+			}
+		}
+	}
+
+	snprintf(p_report + len, TASK_PLAN_REPORT_SIZE - len, "]}");
+
+	// Published once, never freed
+	//
+	__atomic_store_n(&gp_report, p_report, __ATOMIC_RELEASE);
+}
+
+#else
+
+void
+task_plan_benchmark_start (void)
+{
+}
+
+size_t
+task_plan_benchmark_format_json (char * p_buf, size_t size)
+{
+	return (size_t) snprintf(p_buf, size, "null");
+}
+
+#endif
@@ -0,0 +1,60 @@
+/*
+ * trace.h
+ *
+ *  Created on: 19 oct 2026
+ *      Author: Filippo
+ */
+
+#ifndef COMPONENTS_TRACE_H_
+#	define COMPONENTS_TRACE_H_
+
+#	include <stddef.h>
+#	include <stdint.h>
+#	include "esp_err.h"
+#	include "sdkconfig.h"
+
+// Event types, as stored in the dump
+//
+typedef enum trace_type
+{
+	TRACE_TYPE_BEGIN = 0,
+	TRACE_TYPE_END,
+	TRACE_TYPE_INSTANT
+} trace_type_t;
+
+// Receives the binary dump, piece by piece
+//
+typedef esp_err_t (*trace_write_cb_t)(const void * p_data, size_t len,
+									  void * p_arg);
+
+// Trace points. The name must be a string literal: only its address is
+// recorded, the text is added to the dump.
+//
+#	if CONFIG_TRACE_ENABLE
+#		define TRACE_BEGIN(name)			trace_record(TRACE_TYPE_BEGIN, (name), 0)
+#		define TRACE_END(name)				trace_record(TRACE_TYPE_END, (name), 0)
+#		define TRACE_INSTANT(name, arg)		trace_record(TRACE_TYPE_INSTANT, (name), (arg))
+#	else
+#		define TRACE_BEGIN(name)			do { } while (0)
+#		define TRACE_END(name)				do { } while (0)
+#		define TRACE_INSTANT(name, arg)		do { (void) (arg); } while (0)
+#	endif
+
+// Stores an event in the ring of the calling core, safe from ISRs
+//
+void trace_record(trace_type_t type, const char * p_name, uint16_t arg);
+
+// Writes the rings in the binary format read by tools/trace_to_chrome.py.
+// Recording is paused while dumping.
+//
+esp_err_t trace_dump(trace_write_cb_t cb, void * p_arg);
+
+// Prints the binary dump as hex lines prefixed by "TRACE:" on the console
+//
+esp_err_t trace_dump_uart(void);
+
+// Drops every recorded event
+//
+void trace_clear(void);
+
+#endif /* COMPONENTS_TRACE_H_ */
@@ -0,0 +1,344 @@
+/*
+ * trace.c
+ *
+ *  Created on: 19 oct 2026
+ *      Author: Filippo
+ */
+
+#include "trace.h"
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_attr.h"
+#include "esp_cpu.h"
+#include "esp_rom_sys.h"
+
+#define TRACE_MAGIC					"TRC1"
+#define TRACE_VERSION				1
+
+// Distinct trace point names written to a dump
+//
+#define TRACE_MAX_NAMES				64
+
+// Dump bytes per console line
+//
+#define TRACE_UART_LINE_BYTES		32
+
+#if CONFIG_TRACE_ENABLE
+
+_Static_assert(0 == (CONFIG_TRACE_RING_ENTRIES & (CONFIG_TRACE_RING_ENTRIES - 1)),
+			   "CONFIG_TRACE_RING_ENTRIES must be a power of two");
+
+// 16 bytes, stored as is in the dump (little endian)
+//
+typedef struct trace_event
+{
+	uint32_t cycles;
+	uint32_t name;
+	uint32_t task;
+	uint16_t arg;
+	uint8_t type;
+	uint8_t core;
+} trace_event_t;
+
+typedef struct trace_ring
+{
+	uint32_t head;				// Total events written, wraps
+	trace_event_t events[CONFIG_TRACE_RING_ENTRIES];
+} trace_ring_t;
+
+typedef struct trace_uart_ctx
+{
+	char line[2 * TRACE_UART_LINE_BYTES + 1];
+	uint32_t fill;
+} trace_uart_ctx_t;
+
+// One ring per core, written only by that core. A writer masks the
+// interrupts of its core while it stamps and stores its event, so the
+// events of a ring are in time order.
+//
+static trace_ring_t g_rings[portNUM_PROCESSORS] = {0};
+static volatile bool gb_trace_paused = false;
+
+static esp_err_t trace_dump_names(trace_write_cb_t cb, void * p_arg);
+static esp_err_t trace_dump_tasks(trace_write_cb_t cb, void * p_arg);
+static esp_err_t trace_dump_string(trace_write_cb_t cb, void * p_arg,
+								   uint32_t key, const char * p_text);
+static esp_err_t trace_uart_write(const void * p_data, size_t len,
+								  void * p_arg);
+
+void IRAM_ATTR
+trace_record (trace_type_t type, const char * p_name, uint16_t arg)
+{
+	uint32_t core = 0;
+	UBaseType_t irq_state = 0;
+	trace_event_t * p_event = NULL;
+
+	if (true == gb_trace_paused)
+	{
+		return;
+	}
+
+	// Neither a task switch nor an ISR of this core can take a slot
+	// between the timestamp and the store
+	//
+	irq_state = portSET_INTERRUPT_MASK_FROM_ISR();
+
+	core = xPortGetCoreID();
+	p_event = &g_rings[core].events[g_rings[core].head & (CONFIG_TRACE_RING_ENTRIES - 1)];
+	++g_rings[core].head;
+
+	p_event->cycles = esp_cpu_get_ccount();
+	p_event->name = (uint32_t) p_name;
+	p_event->task = xPortInIsrContext() ? 0 : (uint32_t) xTaskGetCurrentTaskHandle();
+	p_event->arg = arg;
+	p_event->type = (uint8_t) type;
+	p_event->core = (uint8_t) core;
+
+	portCLEAR_INTERRUPT_MASK_FROM_ISR(irq_state);
+}
+
+esp_err_t
+trace_dump (trace_write_cb_t cb, void * p_arg)
+{
+	esp_err_t err = ESP_OK;
+	uint16_t header_words[2] = { TRACE_VERSION, portNUM_PROCESSORS };
+	uint32_t ticks_per_us = esp_rom_get_cpu_ticks_per_us();
+
+	gb_trace_paused = true;
+
+	err = cb(TRACE_MAGIC, 4, p_arg);
+
+	if (ESP_OK == err)
+	{
+		err = cb(header_words, sizeof(header_words), p_arg);
+	}
+
+	if (ESP_OK == err)
+	{
+		err = cb(&ticks_per_us, sizeof(ticks_per_us), p_arg);
+	}
+
+	for (uint32_t core = 0; (core < portNUM_PROCESSORS) && (ESP_OK == err); ++core)
+	{
+		trace_ring_t * p_ring = &g_rings[core];
+		uint32_t head = p_ring->head;
+		uint32_t count = (head < CONFIG_TRACE_RING_ENTRIES) ?
+						 head : CONFIG_TRACE_RING_ENTRIES;
+		uint32_t first = (head - count) & (CONFIG_TRACE_RING_ENTRIES - 1);
+		uint32_t tail_count = CONFIG_TRACE_RING_ENTRIES - first;
+
+		err = cb(&count, sizeof(count), p_arg);
+
+		// Oldest first, in at most two pieces
+		//
+		if (tail_count > count)
+		{
+			tail_count = count;
+		}
+
+		if ((ESP_OK == err) && (tail_count > 0))
+		{
+			err = cb(&p_ring->events[first], tail_count * sizeof(trace_event_t),
+					 p_arg);
+		}
+
+		if ((ESP_OK == err) && (count > tail_count))
+		{
+			err = cb(&p_ring->events[0],
+					 (count - tail_count) * sizeof(trace_event_t), p_arg);
+		}
+	}
+
+	if (ESP_OK == err)
+	{
+		err = trace_dump_names(cb, p_arg);
+	}
+
+	if (ESP_OK == err)
+	{
+		err = trace_dump_tasks(cb, p_arg);
+	}
+
+	gb_trace_paused = false;
+
+	return err;
+}
+
+esp_err_t
+trace_dump_uart (void)
+{
+	esp_err_t err = ESP_OK;
+	trace_uart_ctx_t ctx = {0};
+
+	printf("TRACE:BEGIN\n");
+	err = trace_dump(trace_uart_write, &ctx);
+
+	if ((ESP_OK == err) && (ctx.fill > 0))
+	{
+		printf("TRACE:%s\n", ctx.line);
+	}
+
+	printf("TRACE:END\n");
+
+	return err;
+}
+
+void
+trace_clear (void)
+{
+	gb_trace_paused = true;
+
+	for (uint32_t core = 0; core < portNUM_PROCESSORS; ++core)
+	{
+		g_rings[core].head = 0;
+	}
+
+	gb_trace_paused = false;
+}
+
+static esp_err_t
+trace_dump_names (trace_write_cb_t cb, void * p_arg)
+{
+	esp_err_t err = ESP_OK;
+	uint32_t names[TRACE_MAX_NAMES] = {0};
+	uint32_t count = 0;
+
+	// Distinct name addresses of the events
+	//
+	for (uint32_t core = 0; core < portNUM_PROCESSORS; ++core)
+	{
+		uint32_t total = (g_rings[core].head < CONFIG_TRACE_RING_ENTRIES) ?
+						 g_rings[core].head : CONFIG_TRACE_RING_ENTRIES;
+
+		for (uint32_t idx = 0; (idx < total) && (count < TRACE_MAX_NAMES); ++idx)
+		{
+			uint32_t name = g_rings[core].events[idx].name;
+			uint32_t known = 0;
+
+			while ((known < count) && (names[known] != name))
+			{
+				known++;
+			}
+
+			if (known == count)
+			{
+				names[count++] = name;
+			}
+		}
+	}
+
+	err = cb(&count, sizeof(count), p_arg);
+
+	for (uint32_t idx = 0; (idx < count) && (ESP_OK == err); ++idx)
+	{
+		err = trace_dump_string(cb, p_arg, names[idx], (const char *) names[idx]);
+	}
+
+	return err;
+}
+
+static esp_err_t
+trace_dump_tasks (trace_write_cb_t cb, void * p_arg)
+{
+	esp_err_t err = ESP_OK;
+	UBaseType_t max_tasks = uxTaskGetNumberOfTasks() + 4;
+	TaskStatus_t * p_status = malloc(max_tasks * sizeof(TaskStatus_t));
+	uint32_t count = 0;
+
+	// Names of the tasks still alive, deleted ones show as addresses
+	//
+	if (NULL != p_status)
+	{
+		count = uxTaskGetSystemState(p_status, max_tasks, NULL);
+	}
+
+	err = cb(&count, sizeof(count), p_arg);
+
+	for (uint32_t idx = 0; (idx < count) && (ESP_OK == err); ++idx)
+	{
+		err = trace_dump_string(cb, p_arg, (uint32_t) p_status[idx].xHandle,
+								p_status[idx].pcTaskName);
+	}
+
+	free(p_status);
+
+	return err;
+}
+
+static esp_err_t
+trace_dump_string (trace_write_cb_t cb, void * p_arg, uint32_t key,
+				   const char * p_text)
+{
+	esp_err_t err = ESP_OK;
+	uint16_t len = (uint16_t) strnlen(p_text, UINT8_MAX);
+
+	err = cb(&key, sizeof(key), p_arg);
+
+	if (ESP_OK == err)
+	{
+		err = cb(&len, sizeof(len), p_arg);
+	}
+
+	if ((ESP_OK == err) && (len > 0))
+	{
+		err = cb(p_text, len, p_arg);
+	}
+
+	return err;
+}
+
+static esp_err_t
+trace_uart_write (const void * p_data, size_t len, void * p_arg)
+{
+	static const char hex[] = "0123456789abcdef";
+	trace_uart_ctx_t * p_ctx = (trace_uart_ctx_t *) p_arg;
+	const uint8_t * p_byte = (const uint8_t *) p_data;
+
+	for (size_t idx = 0; idx < len; ++idx)
+	{
+		p_ctx->line[2 * p_ctx->fill] = hex[p_byte[idx] >> 4];
+		p_ctx->line[2 * p_ctx->fill + 1] = hex[p_byte[idx] & 0x0F];
+		p_ctx->fill++;
+
+		if (TRACE_UART_LINE_BYTES == p_ctx->fill)
+		{
+			p_ctx->line[2 * p_ctx->fill] = '\0';
+			printf("TRACE:%s\n", p_ctx->line);
+			p_ctx->fill = 0;
+		}
+	}
+
+	p_ctx->line[2 * p_ctx->fill] = '\0';
+
+	return ESP_OK;
+}
+
+#else
+
+void
+trace_record (trace_type_t type, const char * p_name, uint16_t arg)
+{
+}
+
+esp_err_t
+trace_dump (trace_write_cb_t cb, void * p_arg)
+{
+	return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t
+trace_dump_uart (void)
+{
+	return ESP_ERR_NOT_SUPPORTED;
+}
+
+void
+trace_clear (void)
+{
+}
+
+#endif
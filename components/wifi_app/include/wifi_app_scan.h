@@ -0,0 +1,46 @@
+/*
+ * wifi_app_scan.h
+ *
+ *  Created on: 19 oct 2026
+ *      Author: Filippo
+ */
+
+#ifndef COMPONENTS_WIFI_APP_SCAN_H_
+#	define COMPONENTS_WIFI_APP_SCAN_H_
+
+#	include <stdbool.h>
+#	include <stddef.h>
+
+// Creates the cache lock, wifi_app_start() calls it
+//
+void wifi_app_scan_init(void);
+
+// Asks the WiFi application task for a scan, unless one is running or
+// the cached results are younger than CONFIG_WIFI_APP_SCAN_TTL_S. With
+// b_refresh the cache only has to be WIFI_APP_SCAN_REFRESH_MIN_S old.
+// Returns true when a scan is running or has been asked for.
+//
+#	define WIFI_APP_SCAN_REFRESH_MIN_S	10
+
+bool wifi_app_scan_request(bool b_refresh);
+
+// Cached results as JSON, strongest first, one entry per SSID:
+// {"scanning":b,"age_s":n,"scan_ms":n,"ap_clients":n,
+//  "aps":[{"ssid":"..","rssi":n,"ch":n,"auth":n},..]}
+// age_s is -1 before the first scan. scan_ms is how long the last scan
+// took: the radio leaves the access point channel for most of it, so it
+// bounds the outage of the ap_clients stations on the access point
+// meanwhile (tools/scan_disruption.py measures it from a client).
+// Returns the length.
+//
+size_t wifi_app_scan_format_json(char * p_buf, size_t size);
+
+// Run on the WiFi application task: start a scan without waiting for it,
+// take the results of WIFI_EVENT_SCAN_DONE, stop a scan before the
+// station connects
+//
+void wifi_app_scan_start(void);
+void wifi_app_scan_done(void);
+void wifi_app_scan_abort(void);
+
+#endif /* COMPONENTS_WIFI_APP_SCAN_H_ */
@@ -0,0 +1,369 @@
+/*
+ * wifi_app_scan.c
+ *
+ *  Created on: 19 oct 2026
+ *      Author: Filippo
+ */
+
+#include "wifi_app_scan.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "esp_wifi.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+#include "esp_idf_version.h"
+#include "wifi_app.h"
+#include "app_static.h"
+#include "sdkconfig.h"
+
+typedef struct wifi_app_scan_ap
+{
+	char ssid[MAX_SSID_LENGTH + 1];
+	int8_t rssi;
+	uint8_t channel;
+	uint8_t authmode;			// wifi_auth_mode_t
+} wifi_app_scan_ap_t;
+
+static const char g_tag[] = "wifi_app_scan";
+
+// Records handed over by the driver, only the WiFi application task
+// touches them
+//
+static wifi_ap_record_t g_records[CONFIG_WIFI_APP_SCAN_MAX_APS] = {0};
+
+static wifi_app_scan_ap_t g_aps[CONFIG_WIFI_APP_SCAN_MAX_APS] = {0};
+static uint8_t g_ap_count = 0;
+static bool gb_scanning = false;
+static int64_t g_start_us = 0;
+static int64_t g_done_us = 0;			// 0 before the first scan
+static uint32_t g_scan_ms = 0;
+static uint8_t g_ap_clients = 0;
+
+// The cache is filled on the WiFi application task and formatted by the
+// HTTP server, too long for a critical section
+//
+static SemaphoreHandle_t gh_scan_mutex = NULL;
+
+static int wifi_app_scan_compare(const void * p_a, const void * p_b);
+static size_t wifi_app_scan_format_ssid(char * p_buf, size_t size,
+										const char * p_ssid);
+
+void
+wifi_app_scan_init (void)
+{
+	if (NULL == gh_scan_mutex)
+	{
+		gh_scan_mutex = APP_MUTEX_CREATE();
+	}
+}
+
+bool
+wifi_app_scan_request (bool b_refresh)
+{
+	int64_t age_us = 0;
+
+	if (NULL == gh_scan_mutex)
+	{
+		return false;
+	}
+
+	xSemaphoreTake(gh_scan_mutex, portMAX_DELAY);
+
+	if (true == gb_scanning)
+	{
+		xSemaphoreGive(gh_scan_mutex);
+
+		return true;
+	}
+
+	age_us = esp_timer_get_time() - g_done_us;
+
+	// Every scan takes the radio off the access point channel, page
+	// loads are served from the cache
+	//
+	if ((0 != g_done_us) &&
+		(age_us < (int64_t) CONFIG_WIFI_APP_SCAN_TTL_S * 1000000LL) &&
+		((false == b_refresh) ||
+		 (age_us < (int64_t) WIFI_APP_SCAN_REFRESH_MIN_S * 1000000LL)))
+	{
+		xSemaphoreGive(gh_scan_mutex);
+
+		return false;
+	}
+
+	gb_scanning = true;
+	xSemaphoreGive(gh_scan_mutex);
+
+	wifi_app_send_message(WIFI_APP_MSG_SCAN_START);
+
+	return true;
+}
+
+size_t
+wifi_app_scan_format_json (char * p_buf, size_t size)
+{
+	int32_t len = 0;
+	int32_t entry_len = 0;
+	int64_t age_s = -1;
+
+	if ((NULL == p_buf) || (0 == size) || (NULL == gh_scan_mutex))
+	{
+		return 0;
+	}
+
+	xSemaphoreTake(gh_scan_mutex, portMAX_DELAY);
+
+	if (0 != g_done_us)
+	{
+		age_s = (esp_timer_get_time() - g_done_us) / 1000000LL;
+	}
+
+	len = snprintf(p_buf, size,
+				   "{\"scanning\":%s,\"age_s\":%lld,\"scan_ms\":%u,"
+				   "\"ap_clients\":%u,\"aps\":[",
+				   (true == gb_scanning) ? "true" : "false", age_s,
+				   g_scan_ms, g_ap_clients);
+
+	// Entries that do not fit are left out, the list stays valid JSON
+	//
+	for (uint8_t idx = 0; (len > 0) && ((size_t) len < size) && (idx < g_ap_count); ++idx)
+	{
+		size_t ssid_len = 0;
+
+		entry_len = snprintf(p_buf + len, size - len, "%s{\"ssid\":\"",
+							 (0 == idx) ? "" : ",");
+
+		if ((entry_len < 0) || ((size_t) (len + entry_len) >= size))
+		{
+			break;
+		}
+
+		ssid_len = wifi_app_scan_format_ssid(p_buf + len + entry_len,
+											 size - len - entry_len,
+											 g_aps[idx].ssid);
+
+		if (0 == ssid_len)
+		{
+			break;
+		}
+
+		entry_len += (int32_t) ssid_len;
+		entry_len += snprintf(p_buf + len + entry_len, size - len - entry_len,
+							  "\",\"rssi\":%d,\"ch\":%u,\"auth\":%u}",
+							  g_aps[idx].rssi, g_aps[idx].channel,
+							  g_aps[idx].authmode);
+
+		if ((size_t) (len + entry_len) + sizeof("]}") > size)
+		{
+			break;
+		}
+
+		len += entry_len;
+	}
+
+	xSemaphoreGive(gh_scan_mutex);
+
+	if ((len <= 0) || ((size_t) len + sizeof("]}") > size))
+	{
+		p_buf[0] = '\0';
+
+		return 0;
+	}
+
+	len += snprintf(p_buf + len, size - len, "]}");
+
+	return (size_t) len;
+}
+
+void
+wifi_app_scan_start (void)
+{
+	wifi_sta_list_t stations = {0};
+	esp_err_t err = ESP_OK;
+	bool b_scanning = false;
+
+	// Active scan, as short as the configured dwell per channel. The
+	// access point is off the air while the radio is on another channel.
+	//
+	wifi_scan_config_t config = {
+		.ssid = NULL,
+		.bssid = NULL,
+		.channel = 0,
+		.show_hidden = false,
+		.scan_type = WIFI_SCAN_TYPE_ACTIVE,
+		.scan_time.active.min = 0,
+		.scan_time.active.max = CONFIG_WIFI_APP_SCAN_CHANNEL_MS,
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 1, 0)
+		// Back on the access point channel between two channels
+		//
+		.home_chan_dwell_time = CONFIG_WIFI_APP_SCAN_HOME_DWELL_MS
+#endif
+	};
+
+	esp_wifi_ap_get_sta_list(&stations);
+
+	xSemaphoreTake(gh_scan_mutex, portMAX_DELAY);
+	b_scanning = gb_scanning;
+	g_start_us = esp_timer_get_time();
+	g_ap_clients = (uint8_t) stations.num;
+	xSemaphoreGive(gh_scan_mutex);
+
+	// Aborted while the message was queued
+	//
+	if (false == b_scanning)
+	{
+		return;
+	}
+
+	err = esp_wifi_scan_start(&config, false);
+
+	if (ESP_OK != err)
+	{
+		// The station is connecting, the next request tries again
+		//
+		ESP_LOGW(g_tag, "wifi_app_scan_start: %s", esp_err_to_name(err));
+
+		xSemaphoreTake(gh_scan_mutex, portMAX_DELAY);
+		gb_scanning = false;
+		xSemaphoreGive(gh_scan_mutex);
+	}
+}
+
+void
+wifi_app_scan_done (void)
+{
+	uint16_t number = CONFIG_WIFI_APP_SCAN_MAX_APS;
+	uint8_t count = 0;
+	uint8_t ap_clients = 0;
+	uint32_t scan_ms = 0;
+	bool b_scanning = false;
+	int64_t now_us = esp_timer_get_time();
+
+	// Also frees the driver list, even for an aborted scan
+	//
+	if (ESP_OK != esp_wifi_scan_get_ap_records(&number, g_records))
+	{
+		number = 0;
+	}
+
+	xSemaphoreTake(gh_scan_mutex, portMAX_DELAY);
+	b_scanning = gb_scanning;
+	xSemaphoreGive(gh_scan_mutex);
+
+	if (false == b_scanning)
+	{
+		return;
+	}
+
+	qsort(g_records, number, sizeof(g_records[0]), wifi_app_scan_compare);
+
+	xSemaphoreTake(gh_scan_mutex, portMAX_DELAY);
+
+	// Strongest access point of each network, hidden ones left out
+	//
+	for (uint16_t idx = 0; idx < number; ++idx)
+	{
+		bool b_seen = ('\0' == g_records[idx].ssid[0]);
+
+		for (uint8_t prev = 0; (false == b_seen) && (prev < count); ++prev)
+		{
+			b_seen = (0 == strncmp(g_aps[prev].ssid, (const char *) g_records[idx].ssid,
+								   MAX_SSID_LENGTH));
+		}
+
+		if (true == b_seen)
+		{
+			continue;
+		}
+
+		memcpy(g_aps[count].ssid, g_records[idx].ssid, MAX_SSID_LENGTH);
+		g_aps[count].ssid[MAX_SSID_LENGTH] = '\0';
+		g_aps[count].rssi = g_records[idx].rssi;
+		g_aps[count].channel = g_records[idx].primary;
+		g_aps[count].authmode = (uint8_t) g_records[idx].authmode;
+		++count;
+	}
+
+	g_ap_count = count;
+	g_scan_ms = (uint32_t) ((now_us - g_start_us) / 1000);
+	g_done_us = now_us;
+	gb_scanning = false;
+	scan_ms = g_scan_ms;
+	ap_clients = g_ap_clients;
+	xSemaphoreGive(gh_scan_mutex);
+
+	ESP_LOGI(g_tag, "scan: %u networks in %u ms, %u AP clients",
+			 count, scan_ms, ap_clients);
+}
+
+void
+wifi_app_scan_abort (void)
+{
+	bool b_scanning = false;
+
+	xSemaphoreTake(gh_scan_mutex, portMAX_DELAY);
+	b_scanning = gb_scanning;
+	gb_scanning = false;
+	xSemaphoreGive(gh_scan_mutex);
+
+	if (true == b_scanning)
+	{
+		ESP_LOGI(g_tag, "wifi_app_scan_abort: the station connects");
+		esp_wifi_scan_stop();
+	}
+}
+
+// Strongest first
+//
+static int
+wifi_app_scan_compare (const void * p_a, const void * p_b)
+{
+	return ((const wifi_ap_record_t *) p_b)->rssi -
+		   ((const wifi_ap_record_t *) p_a)->rssi;
+}
+
+// SSIDs are any 32 bytes: quotes, backslashes and control characters are
+// escaped. Returns 0 when the escaped SSID does not fit.
+//
+static size_t
+wifi_app_scan_format_ssid (char * p_buf, size_t size, const char * p_ssid)
+{
+	size_t len = 0;
+
+	for (uint8_t idx = 0; (idx < MAX_SSID_LENGTH) && ('\0' != p_ssid[idx]); ++idx)
+	{
+		uint8_t c = (uint8_t) p_ssid[idx];
+
+		if (len + 7 > size)
+		{
+			return 0;
+		}
+
+		if (('"' == c) || ('\\' == c))
+		{
+			p_buf[len++] = '\\';
+			p_buf[len++] = (char) c;
+		}
+		else if (c < 0x20)
+		{
+			len += snprintf(p_buf + len, size - len, "\\u%04x", c);
+		}
+		else
+		{
+			p_buf[len++] = (char) c;
+		}
+	}
+
+	if ((0 == len) || (len >= size))
+	{
+		return 0;
+	}
+
+	p_buf[len] = '\0';
+
+	return len;
+}
@@ -0,0 +1,18 @@
+/*
+ * wifi_reset_button.h
+ *
+ *  Created on: 19 apr 2023
+ *      Author: Filippo
+ */
+
+#ifndef COMPONENTS_WIFI_RESET_BUTTON_H_
+#	define COMPONENTS_WIFI_RESET_BUTTON_H_
+
+#	define WIFI_RESET_BUTTON		0
+
+// Short press: forget the station and disconnect. Long press
+// (CONFIG_BUTTON_LONG_PRESS_MS): erase NVS and restart.
+//
+void wifi_reset_button_config(void);
+
+#endif /* COMPONENTS_WIFI_RESET_BUTTON_H_ */
@@ -0,0 +1,57 @@
+/*
+ * wifi_reset_button.c
+ *
+ *  Created on: 19 apr 2023
+ *      Author: Filippo
+ */
+#include "wifi_reset_button.h"
+#include "esp_log.h"
+#include "button.h"
+#include "wifi_app.h"
+
+static const char g_tag[] = "wifi_reset_button";
+
+static void wifi_reset_button_event(const button_event_t * p_event,
+									void * p_arg);
+
+void
+wifi_reset_button_config (void)
+{
+	// This button already has a pull-up resistor
+	//
+	button_config_t config = {
+		.gpio = WIFI_RESET_BUTTON,
+		.b_active_low = true,
+		.b_double_press = false,
+		.h_queue = NULL,
+		.cb = wifi_reset_button_event,
+		.p_arg = NULL
+	};
+
+	if (ESP_OK != button_register(&config, NULL))
+	{
+		ESP_LOGE(g_tag, "wifi_reset_button_config: button not registered");
+	}
+}
+
+// Runs on the button task, the WiFi application queue does the work
+//
+static void
+wifi_reset_button_event (const button_event_t * p_event, void * p_arg)
+{
+	switch (p_event->type)
+	{
+		case BUTTON_EVENT_SHORT_PRESS:
+			ESP_LOGI(g_tag, "short press: WiFi reset");
+			wifi_app_send_message(WIFI_APP_MSG_USER_REQUESTED_STA_DISCONNECT);
+		break;
+
+		case BUTTON_EVENT_LONG_PRESS:
+			ESP_LOGW(g_tag, "long press: factory reset");
+			wifi_app_send_message(WIFI_APP_MSG_FACTORY_RESET);
+		break;
+
+		default:
+		break;
+	}
+}
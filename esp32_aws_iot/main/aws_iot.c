@@ -35,6 +35,7 @@
 #include "freertos/event_groups.h"
 #include "esp_system.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 #include "esp_vfs_fat.h"
 #include "driver/sdmmc_host.h"
 
@@ -42,8 +43,13 @@
 #include "nvs.h"
 #include "nvs_flash.h"
 #include "tasks_common.h"
+#include "task_plan.h"
+#include "app_static.h"
 #include "wifi_app.h"
-#include "DHT22.h"
+#include "sensor.h"
+#include "sensor_time.h"
+#include "metrics.h"
+#include "ota_app_health.h"
 
 #include "aws_iot_config.h"
 #include "aws_iot_log.h"
@@ -55,6 +61,14 @@ static const char *TAG = "aws_iot";
 // AWS IoT task handle
 static TaskHandle_t gh_task_aws_iot = NULL;
 
+#if CONFIG_METRICS_MQTT_PUBLISH
+#define METRICS_TOPIC		"test_topic/esp32/metrics"
+
+// Metrics summary, too long for the task stack
+//
+static char g_metrics_payload[512];
+#endif
+
 /**
  * CA Root certificate, device ("Thing") certificate and device ("Thing") key.
  * "Embedded Certs" are loaded from files in "certs/" and embedded into the app binary.
@@ -120,7 +134,7 @@ disconnectCallbackHandler (AWS_IoT_Client * pClient, void * data)
 void
 aws_iot_task (void * p_param)
 {
-    char cPayload[100] = {0};
+    char cPayload[128] = {0};
     int32_t i = 0;
     IoT_Error_t rc = FAILURE;
     AWS_IoT_Client client;
@@ -128,6 +142,11 @@ aws_iot_task (void * p_param)
     IoT_Client_Connect_Params connectParams = iotClientConnectParamsDefault;
     IoT_Publish_Message_Params paramsQOS0;
     IoT_Publish_Message_Params paramsQOS1;
+#if CONFIG_METRICS_MQTT_PUBLISH
+    int64_t next_metrics_us = 0;
+
+    metrics_start();
+#endif
 
     ESP_LOGI(TAG, "AWS IoT SDK Version %d.%d.%d-%s", VERSION_MAJOR,
     		 VERSION_MINOR, VERSION_PATCH, VERSION_TAG);
@@ -180,6 +199,8 @@ aws_iot_task (void * p_param)
         }
     } while(SUCCESS != rc);
 
+    ota_app_health_report(OTA_APP_HEALTH_MQTT);
+
     /*
      * Enable Auto Reconnect functionality. Minimum and Maximum time of Exponential backoff are set in aws_iot_config.h
      *  #AWS_IOT_MQTT_MIN_RECONNECT_WAIT_INTERVAL
@@ -232,9 +253,30 @@ aws_iot_task (void * p_param)
             continue;
         }
 
+#if CONFIG_METRICS_MQTT_PUBLISH
+        // Stack margins and heap now come from the metrics sampler
+        //
+        if (esp_timer_get_time() >= next_metrics_us)
+        {
+            paramsQOS0.payload = (void *) g_metrics_payload;
+            paramsQOS0.payloadLen = metrics_format_summary(g_metrics_payload,
+            											   sizeof(g_metrics_payload));
+
+            if (paramsQOS0.payloadLen > 0)
+            {
+                rc = aws_iot_mqtt_publish(&client, METRICS_TOPIC,
+                						  strlen(METRICS_TOPIC), &paramsQOS0);
+            }
+
+            paramsQOS0.payload = (void *) cPayload;
+            next_metrics_us = esp_timer_get_time() +
+            				  (int64_t) CONFIG_METRICS_MQTT_PERIOD_S * 1000000;
+        }
+#else
         ESP_LOGI(TAG, "Stack remaining for task '%s' is %d bytes",
         		 pcTaskGetTaskName(NULL),
 				 uxTaskGetStackHighWaterMark(NULL));
+#endif
 
         vTaskDelay(3000 / portTICK_RATE_MS);
 
@@ -242,10 +284,11 @@ aws_iot_task (void * p_param)
         paramsQOS0.payloadLen = strlen(cPayload);
         rc = aws_iot_mqtt_publish(&client, TOPIC, TOPIC_LEN, &paramsQOS0);
 
-        sprintf(cPayload, "%s : %.1f, %s : %.1f",
-        		"Temperature", getTemperature(),
-				"Humidity", getHumidity());
-        paramsQOS1.payloadLen = strlen(cPayload);
+        // Boot, time since boot and UTC: readings taken before the
+        // first SNTP sync can still be placed in time
+        //
+        paramsQOS1.payloadLen = sensor_time_format_latest_json(cPayload,
+        													   sizeof(cPayload));
         rc = aws_iot_mqtt_publish(&client, TOPIC, TOPIC_LEN, &paramsQOS1);
 
         if (rc == MQTT_REQUEST_TIMEOUT_ERROR)
@@ -263,9 +306,9 @@ void aws_iot_start(void)
 {
 	if (gh_task_aws_iot == NULL)
 	{
-		xTaskCreatePinnedToCore(&aws_iot_task, "aws_iot_task",
-								AWS_IOT_TASK_STACK_SIZE, NULL,
-								AWS_IOT_TASK_PRIORITY, &gh_task_aws_iot,
-								AWS_IOT_TASK_CORE_ID);
+		gh_task_aws_iot = APP_TASK_CREATE_PINNED(&aws_iot_task, "aws_iot_task",
+												 AWS_IOT_TASK_STACK_SIZE, NULL,
+												 task_plan_get(TASK_PLAN_AWS_IOT)->priority,
+												 task_plan_get(TASK_PLAN_AWS_IOT)->core_id);
 	}
 }
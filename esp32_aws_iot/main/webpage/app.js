@@ -1,334 +0,0 @@
-/**
- * Add gobals here
- */
-var seconds 	= null;
-var otaTimerVar =  null;
-var wifiConnectInterval = null;
-
-/**
- * Initialize functions here.
- */
-$(document).ready(function(){
-	getSSID();
-	getUpdateStatus();
-	startDHTSensorInterval();
-	startLocalTimeInterval();
-	getConnectInfo();
-	$("#connect_wifi").on("click", function(){
-		checkCredentials();
-	});
-	$("#disconnect_wifi").on("click", function(){
-		disconnectWifi();
-	});
-});   
-
-/**
- * Gets file name and size for display on the web page.
- */        
-function getFileInfo() 
-{
-    var x = document.getElementById("selected_file");
-    var file = x.files[0];
-
-    document.getElementById("file_info").innerHTML = "<h4>File: " + file.name + "<br>" + "Size: " + file.size + " bytes</h4>";
-}
-
-/**
- * Handles the firmware update.
- */
-function updateFirmware() 
-{
-    // Form Data
-    var formData = new FormData();
-    var fileSelect = document.getElementById("selected_file");
-    
-    if (fileSelect.files && fileSelect.files.length == 1) 
-	{
-        var file = fileSelect.files[0];
-        formData.set("file", file, file.name);
-        document.getElementById("ota_update_status").innerHTML = "Uploading " + file.name + ", Firmware Update in Progress...";
-
-        // Http Request
-        var request = new XMLHttpRequest();
-
-        request.upload.addEventListener("progress", updateProgress);
-        request.open('POST', "/OTAupdate");
-        request.responseType = "blob";
-        request.send(formData);
-    } 
-	else 
-	{
-        window.alert('Select A File First')
-    }
-}
-
-/**
- * Progress on transfers from the server to the client (downloads).
- */
-function updateProgress(oEvent) 
-{
-    if (oEvent.lengthComputable) 
-	{
-        getUpdateStatus();
-    } 
-	else 
-	{
-        window.alert('total size is unknown')
-    }
-}
-
-/**
- * Posts the firmware udpate status.
- */
-function getUpdateStatus() 
-{
-    var xhr = new XMLHttpRequest();
-    var requestURL = "/OTAstatus";
-    xhr.open('POST', requestURL, false);
-    xhr.send('ota_update_status');
-
-    if (xhr.readyState == 4 && xhr.status == 200) 
-	{		
-        var response = JSON.parse(xhr.responseText);
-						
-	 	document.getElementById("latest_firmware").innerHTML = response.compile_date + " - " + response.compile_time
-
-		// If flashing was complete it will return a 1, else -1
-		// A return of 0 is just for information on the Latest Firmware request
-        if (response.ota_update_status == 1) 
-		{
-    		// Set the countdown timer time
-            seconds = 10;
-            // Start the countdown timer
-            otaRebootTimer();
-        } 
-        else if (response.ota_update_status == -1)
-		{
-            document.getElementById("ota_update_status").innerHTML = "!!! Upload Error !!!";
-        }
-    }
-}
-
-/**
- * Displays the reboot countdown.
- */
-function otaRebootTimer() 
-{	
-    document.getElementById("ota_update_status").innerHTML = "OTA Firmware Update Complete. This page will close shortly, Rebooting in: " + seconds;
-
-    if (--seconds == 0) 
-	{
-        clearTimeout(otaTimerVar);
-        window.location.reload();
-    } 
-	else 
-	{
-        otaTimerVar = setTimeout(otaRebootTimer, 1000);
-    }
-}
-
-/**
- * Gets DHT values for display purpose
- */
-function getDHTSensorValues()
-{
-	$.getJSON('/dhtSensor.json', function(data){
-		$('#temperature_reading').text(data["temp"]);
-		$('#humidity_reading').text(data["humidity"]);
-	});
-}
-
-/**
- * Sets the interval for getting the update DHT22 value
- */
-function startDHTSensorInterval()
-{
-	setInterval(getDHTSensorValues, 5000);
-}
-
-/**
- * Clears connection status
- */
-function stopWifiConnectStatusInterval()
-{
-	if (wifiConnectInterval != null)
-	{
-		clearInterval(wifiConnectInterval);
-		wifiConnectInterval = null;
-	}
-}
-
-/**
- * Gets WiFi connection status
- */
-function getWifiConnectStatus()
-{
-	var xhr = new XMLHttpRequest();
-	var requestURL = "/wifiConnectStatus";
-	xhr.open('POST', requestURL, false);
-	xhr.send('wifi_connect_status');
-	
-	if (xhr.readyState == 4 && xhr.status == 200)
-	{
-		var response = JSON.parse(xhr.responseText);
-		
-		document.getElementById("wifi_connect_status").innerHTML = "Connecting...";
-		
-		if (response.wifi_connect_status == 2)
-		{
-			document.getElementById("wifi_connect_status").innerHTML = "<h4 class='rd'>Failed to Connect. Please check your AP credentials and compatibility</h4>";
-			stopWifiConnectStatusInterval();
-		}
-		else if (response.wifi_connect_status == 3)
-		{
-			document.getElementById("wifi_connect_status").innerHTML = "<h4 class='gr'>Connection succeess!!!</h4>";
-			stopWifiConnectStatusInterval();
-			getConnectInfo();
-		}
-	}
-}
-
-/**
- * Starts the interval for check connection status
- */
-function startWifiConnectStatusInterval()
-{
-	wifiConnectInterval = setInterval(getWifiConnectStatus, 2000);
-}
-
-/**
- * Connect Wifi funtion called using ssid and password into text fields
- */
-function connectWifi()
-{
-	selectedSSID = $("#connect_ssid").val();
-	pwd = $("#connect_pass").val();
-	
-	$.ajax({
-		url: '/wifiConnect.json',
-		dataType: 'json',
-		method: 'POST',
-		cache: false,
-		headers: {'my-connect-ssid': selectedSSID, 'my-connect-pwd': pwd},
-		data: {'timestamp': Date.now()}
-	});
-	
-	startWifiConnectStatusInterval();
-}
-
-/**
- * Checks credentials on connect_wifi button click
- */
-function checkCredentials()
-{
-	errorList = "";
-	credsOk = true;
-	
-	selectedSSID = $("#connect_ssid").val();
-	pwd = $("#connect_pass").val();
-	
-	if (selectedSSID == "")
-	{
-		errorList += "<h4 class='rd'>SSID cannot be empty!</h4>";
-		credsOk = false;
-	}
-	
-	if (pwd == "")
-	{
-		errorList += "<h4 class='rd'>Password cannot be empty!</h4>";
-		credsOk = false;
-	}
-	
-	if (credsOk == false)
-	{
-		$("#wifi_connect_credentials_errors").html(errorList);
-	}
-	else
-	{
-		$("#wifi_connect_credentials_errors").html("");
-		connectWifi();
-	}
-}
-
-/**
- * Shows Wifi password if box checked
- */
-function showPassword()
-{
-	var x = document.getElementById("connect_pass");
-	if (x.type === "password")
-	{
-		x.type = "text";
-	}
-	else
-	{
-		x.type = "password";
-	}
-}
-
-/**
- * Gets the connection information for displaying on the web page
- */
-function getConnectInfo()
-{
-	$.getJSON('/wifiConnectInfo.json', function(data){
-		$("#connected_ap_label").html("Connected to: ");
-		$("#connected_ap").text(data["ap"]);
-		
-		$("#ip_address_label").html("IP Address: ");
-		$("#wifi_connect_ip").text(data["ip"]);
-		
-		$("#netmask_label").html("Netmask: ");
-		$("#wifi_connect_netmask").text(data["netmask"]);
-		
-		$("#gateway_label").html("Gateway: ");
-		$("#wifi_connect_gw").text(data["gw"]);
-		
-		document.getElementById('disconnect_wifi').style.display='block';
-	});
-}
-
-/**
- * Disconnect Wifi once the disconnect button is pressed
- */
-function disconnectWifi()
-{
-	$.ajax({
-		url: 'wifiDisconnect.json',
-		dataType: 'json',
-		method: 'DELETE',
-		cache: false,
-		data: { 'timestamp': Date.now() }
-	});
-	
-	// Update the webpage
-	setTimeout("location.reload(true);", 2000);
-}
-
-/**
- * Set interval for display local time
- */
-function startLocalTimeInterval()
-{
-	setInterval(getLocalTime, 10000);
-}
-
-/**
- * Connect the ESP32 to internet and the time will be updated
- */
-function getLocalTime()
-{
-	$.getJSON('/localTime.json', function(data) {
-		$("#local_time").text(data["time"]);
-	});
-}
-
-/**
- * Get the SSID of the ESP32 access point and display it on the page
- */
-function getSSID()
-{
-	$.getJSON('/apSSID.json', function(data) {
-		$("#ap_ssid").text(data["ssid"]);
-	});
-}
\ No newline at end of file
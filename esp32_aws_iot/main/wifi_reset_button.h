@@ -1,16 +0,0 @@
-/*
- * wifi_reset_button.h
- *
- *  Created on: 19 apr 2023
- *      Author: Filippo
- */
-
-#ifndef MAIN_WIFI_RESET_BUTTON_H_
-#	define MAIN_WIFI_RESET_BUTTON_H_
-
-#	define ESP_INTR_FLAG_DEFAULT	0
-#	define WIFI_RESET_BUTTON		0
-
-void wifi_reset_button_config(void);
-
-#endif /* MAIN_WIFI_RESET_BUTTON_H_ */
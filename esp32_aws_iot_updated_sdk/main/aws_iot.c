@@ -42,8 +42,10 @@
 #include "nvs.h"
 #include "nvs_flash.h"
 #include "tasks_common.h"
+#include "task_plan.h"
+#include "app_static.h"
 #include "wifi_app.h"
-#include "DHT22.h"
+#include "sensor.h"
 
 #include "aws_iot_config.h"
 #include "aws_iot_log.h"
@@ -199,8 +201,8 @@ void aws_iot_task(void *param) {
         rc = aws_iot_mqtt_publish(&client, TOPIC, TOPIC_LEN, &paramsQOS0);
 
         sprintf(cPayload, "%s : %.1f, %s : %.1f",
-        		"Temperature", getTemperature(),
-				"Humidity", getHumidity());
+        		"Temperature", sensor_get_latest_value(SENSOR_QUANTITY_TEMPERATURE),
+				"Humidity", sensor_get_latest_value(SENSOR_QUANTITY_HUMIDITY));
         paramsQOS1.payloadLen = strlen(cPayload);
         rc = aws_iot_mqtt_publish(&client, TOPIC, TOPIC_LEN, &paramsQOS1);
         if (rc == MQTT_REQUEST_TIMEOUT_ERROR) {
@@ -217,9 +219,9 @@ void aws_iot_start(void)
 {
 	if (task_aws_iot == NULL)
 	{
-		xTaskCreatePinnedToCore(&aws_iot_task, "aws_iot_task",
-								AWS_IOT_TASK_STACK_SIZE, NULL,
-								AWS_IOT_TASK_PRIORITY, &task_aws_iot,
-								AWS_IOT_TASK_CORE_ID);
+		task_aws_iot = APP_TASK_CREATE_PINNED(&aws_iot_task, "aws_iot_task",
+											  AWS_IOT_TASK_STACK_SIZE, NULL,
+											  task_plan_get(TASK_PLAN_AWS_IOT)->priority,
+											  task_plan_get(TASK_PLAN_AWS_IOT)->core_id);
 	}
 }
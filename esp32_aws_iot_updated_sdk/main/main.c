@@ -1,22 +1,31 @@
 #include "nvs_flash.h"
 #include "wifi_app.h"
+#include "log_defer.h"
 #include "esp_err.h"
 #include "freertos/timers.h"
-#include "DHT22.h"
+#include "sensor.h"
+#include "sensor_dht22.h"
 #include "wifi_reset_button.h"
 #include "esp_log.h"
 #include "sntp_time_sync.h"
+#include "ota_app_pull.h"
+#include "ota_app_health.h"
 
 static const char g_tag[] = "main";
 
 int aws_iot_demo_main(int argc, char ** argv);
 
 static void wifi_application_connected_events(void);
+static void sensor_sample_health(const sensor_sample_t * p_sample, void * p_arg);
 
 void
 app_main (void)
 {
 	TickType_t tick_wakeup = xTaskGetTickCount();
+	// Deferred logging first, every later line goes through it
+	//
+	log_defer_start();
+
     // Initialize NVS
 	//
 	esp_err_t ret = nvs_flash_init();
@@ -30,13 +39,22 @@ app_main (void)
 
 	ESP_ERROR_CHECK(ret);
 
+	// A freshly updated image is kept only once it has connected, reached
+	// the broker and read a sensor, otherwise the previous one comes back
+	//
+	ota_app_health_start(OTA_APP_HEALTH_WIFI | OTA_APP_HEALTH_MQTT |
+						 OTA_APP_HEALTH_SENSOR);
+
 	wifi_app_start();
 
 	wifi_reset_button_config();
 
 	vTaskDelayUntil(&tick_wakeup, 1000 / portTICK_PERIOD_MS);
 
-	dht22_task_start();
+	sensor_dht22_register(CONFIG_SENSOR_DHT22_GPIO,
+						  CONFIG_SENSOR_DHT22_PERIOD_MS, NULL);
+	sensor_subscribe(sensor_sample_health, NULL);
+	sensor_task_start();
 
 	wifi_app_set_callback(wifi_application_connected_events);
 }
@@ -45,6 +63,14 @@ static void
 wifi_application_connected_events (void)
 {
 	ESP_LOGI(g_tag, "WiFi application conneted!");
-	sntp_time_sync_task_start();
+	ota_app_health_report(OTA_APP_HEALTH_WIFI);
+	sntp_time_sync_start();
+	ota_app_pull_start();
 	aws_iot_demo_main(0, NULL);
 }
+
+static void
+sensor_sample_health (const sensor_sample_t * p_sample, void * p_arg)
+{
+	ota_app_health_report(OTA_APP_HEALTH_SENSOR);
+}
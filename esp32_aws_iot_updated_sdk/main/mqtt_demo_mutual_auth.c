@@ -75,8 +75,11 @@
 /* Clock for timer. */
 #include "clock.h"
 
-#include "DHT22.h"
+#include "sensor.h"
+#include "sensor_time.h"
+#include "trace.h"
 #include "wifi_app.h"
+#include "ota_app_health.h"
 
 /**
  * These configuration settings are required to run the mutual auth demo.
@@ -953,6 +956,9 @@ static void eventCallback( MQTTContext_t * pMqttContext,
 
     packetIdentifier = pDeserializedInfo->packetIdentifier;
 
+    TRACE_BEGIN( "mqtt eventCallback" );
+    TRACE_INSTANT( "mqtt packet type", pPacketInfo->type );
+
     /* Handle incoming publish. The lower 4 bits of the publish packet
      * type is used for the dup, QoS, and retain flags. Hence masking
      * out the lower bits to check if the packet is publish. */
@@ -1019,6 +1025,8 @@ static void eventCallback( MQTTContext_t * pMqttContext,
                             pPacketInfo->type ) );
         }
     }
+
+    TRACE_END( "mqtt eventCallback" );
 }
 
 /*-----------------------------------------------------------*/
@@ -1097,6 +1105,9 @@ static int establishMqttSession( MQTTContext_t * pMqttContext,
     else
     {
         LogInfo( ( "MQTT connection successfully established with broker.\n\n" ) );
+
+        /* One of the checks a freshly updated image must pass. */
+        ota_app_health_report( OTA_APP_HEALTH_MQTT );
     }
 
     return returnStatus;
@@ -1213,11 +1224,16 @@ static int unsubscribeFromTopic( MQTTContext_t * pMqttContext )
 
 static int publishToTopic( MQTTContext_t * pMqttContext )
 {
-	char cPayload[100] = {0};
-	sprintf(cPayload, "%s : %d, %s : %.1f, %s : %.1f",
-			"WiFi RSSI", wifi_app_get_rssi(),
-			"Temperature", getTemperature(),
-			"Humidity", getHumidity());
+	char cPayload[160] = {0};
+	char cSample[128] = {0};
+
+	// Boot, time since boot and UTC: readings taken before the first
+	// SNTP sync can still be placed in time
+	//
+	snprintf(cPayload, sizeof(cPayload), "{\"rssi\":%d,\"sensor\":%s}",
+			 wifi_app_get_rssi(),
+			 (0 != sensor_time_format_latest_json(cSample, sizeof(cSample))) ?
+			 cSample : "null");
     int returnStatus = EXIT_SUCCESS;
     MQTTStatus_t mqttStatus = MQTTSuccess;
     uint8_t publishIndex = MAX_OUTGOING_PUBLISHES;
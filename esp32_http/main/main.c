@@ -1,10 +1,15 @@
 #include "nvs_flash.h"
 #include "wifi_app.h"
+#include "log_defer.h"
 #include "esp_err.h"
 
 void
 app_main (void)
 {
+	// Deferred logging first, every later line goes through it
+	//
+	log_defer_start();
+
     // Initialize NVS
 	//
 	esp_err_t ret = nvs_flash_init();
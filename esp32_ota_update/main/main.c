@@ -1,10 +1,16 @@
 #include "nvs_flash.h"
 #include "wifi_app.h"
+#include "log_defer.h"
+#include "ota_app_health.h"
 #include "esp_err.h"
 
 void
 app_main (void)
 {
+	// Deferred logging first, every later line goes through it
+	//
+	log_defer_start();
+
     // Initialize NVS
 	//
 	esp_err_t ret = nvs_flash_init();
@@ -18,5 +24,11 @@ app_main (void)
 
 	ESP_ERROR_CHECK(ret);
 
+	// Images are pushed from the browser on the access point, there is
+	// no station and no sensor: a new image is kept once the web server
+	// is up to take the next one, otherwise the previous one comes back
+	//
+	ota_app_health_start(OTA_APP_HEALTH_HTTP);
+
 	wifi_app_start();
 }
@@ -10,13 +10,20 @@
 void
 app_main (void)
 {
+    rgb_led_init();
+
+    // Every status for 3 s, the LEDC fades run the patterns while this
+    // task sleeps
+    //
     while (true)
     {
-    	rgb_led_wifi_app_started();
-        vTaskDelay(1000 / portTICK_PERIOD_MS);
-        rgb_led_http_server_started();
-		vTaskDelay(1000 / portTICK_PERIOD_MS);
-		rgb_led_wifi_connected();
-		vTaskDelay(1000 / portTICK_PERIOD_MS);
+    	for (int32_t status = 0; status < RGB_LED_STATUS_MAX; ++status)
+    	{
+    		rgb_led_status((rgb_led_status_t) status);
+    		vTaskDelay(3000 / portTICK_PERIOD_MS);
+    	}
+
+    	rgb_led_clear(RGB_LED_LAYER_ERROR);
+    	rgb_led_clear(RGB_LED_LAYER_OTA);
     }
 }
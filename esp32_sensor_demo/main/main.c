@@ -1,3 +1,4 @@
+
 /**
  * Application entry point
  */
@@ -5,13 +6,80 @@
 #include <stdio.h>
 #include <stdbool.h>
 #include <unistd.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "nvs_flash.h"
+#include "i2cdev.h"
+#include "bme680.h"
+
+#include "sensor.h"
+#include "sensor_history.h"
+#include "sensor_bme680.h"
 
-#include "bme680_sensor.h"
+#define PORT 0
+#if defined(CONFIG_EXAMPLE_I2C_ADDRESS_0)
+#define ADDR_BME680 BME680_I2C_ADDR_0
+#define ADDR_BME680_SECOND BME680_I2C_ADDR_1
+#endif
+#if defined(CONFIG_EXAMPLE_I2C_ADDRESS_1)
+#define ADDR_BME680 BME680_I2C_ADDR_1
+#define ADDR_BME680_SECOND BME680_I2C_ADDR_0
+#endif
+
+static const char g_tag[] = "main";
 
 void
 app_main (void)
 {
-	// Start the BME680 task
+	sensor_sample_t sample;
+	uint32_t seq = 0;
+
+	// The boot number and the UTC offsets of the sensor history live in
+	// NVS
 	//
-	BME680_task_start();
+	esp_err_t ret = nvs_flash_init();
+
+	if ((ESP_ERR_NVS_NO_FREE_PAGES == ret) ||
+		(ESP_ERR_NVS_NEW_VERSION_FOUND == ret))
+	{
+		ESP_ERROR_CHECK(nvs_flash_erase());
+		ret = nvs_flash_init();
+	}
+
+	ESP_ERROR_CHECK(ret);
+
+	ESP_ERROR_CHECK(i2cdev_init());
+
+	// Both sensors share the bus and the sensor task
+	//
+	ESP_ERROR_CHECK(sensor_bme680_register(ADDR_BME680, PORT,
+										   CONFIG_EXAMPLE_I2C_MASTER_SDA,
+										   CONFIG_EXAMPLE_I2C_MASTER_SCL,
+										   CONFIG_EXAMPLE_BME680_PERIOD_MS, NULL));
+#if defined(CONFIG_EXAMPLE_BME680_SECOND_SENSOR)
+	ESP_ERROR_CHECK(sensor_bme680_register(ADDR_BME680_SECOND, PORT,
+										   CONFIG_EXAMPLE_I2C_MASTER_SDA,
+										   CONFIG_EXAMPLE_I2C_MASTER_SCL,
+										   CONFIG_EXAMPLE_BME680_PERIOD_MS, NULL));
+#endif
+
+	sensor_task_start();
+
+	// Walk the sample history, the sensor task never waits for us
+	//
+	for (;;)
+	{
+		vTaskDelay(10000 / portTICK_PERIOD_MS);
+
+		while (1 == sensor_history_read(&seq, &sample, 1))
+		{
+			ESP_LOGI(g_tag, "sensor %d: %s %.2f %s (profile %d)",
+					 sample.sensor_id,
+					 sensor_quantity_name(sample.quantity),
+					 sample.value,
+					 sensor_unit_name(sample.unit),
+					 sample.tag);
+		}
+	}
 }
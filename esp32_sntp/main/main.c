@@ -1,8 +1,10 @@
 #include "nvs_flash.h"
 #include "wifi_app.h"
+#include "log_defer.h"
 #include "esp_err.h"
 #include "freertos/timers.h"
-#include "DHT22.h"
+#include "sensor.h"
+#include "sensor_dht22.h"
 #include "wifi_reset_button.h"
 #include "esp_log.h"
 #include "sntp_time_sync.h"
@@ -15,6 +17,10 @@ void
 app_main (void)
 {
 	TickType_t tick_wakeup = xTaskGetTickCount();
+	// Deferred logging first, every later line goes through it
+	//
+	log_defer_start();
+
     // Initialize NVS
 	//
 	esp_err_t ret = nvs_flash_init();
@@ -34,7 +40,9 @@ app_main (void)
 
 	vTaskDelayUntil(&tick_wakeup, 1000 / portTICK_PERIOD_MS);
 
-	dht22_task_start();
+	sensor_dht22_register(CONFIG_SENSOR_DHT22_GPIO,
+						  CONFIG_SENSOR_DHT22_PERIOD_MS, NULL);
+	sensor_task_start();
 
 	wifi_app_set_callback(wifi_application_connected_events);
 }
@@ -43,5 +51,5 @@ static void
 wifi_application_connected_events (void)
 {
 	ESP_LOGI(g_tag, "WiFi application conneted!");
-	sntp_time_sync_task_start();
+	sntp_time_sync_start();
 }
@@ -1,15 +0,0 @@
-/*
- * tasks_common.h
- *
- *  Created on: 8 apr 2023
- *      Author: Filippo
- */
-
-#ifndef MAIN_TASKS_COMMON_H_
-#	define MAIN_TASKS_COMMON_H_
-
-#	define WIFI_APP_TASK_STACK_SIZE		4096
-#	define WIFI_APP_TASK_PRIORITY		5
-#	define WIFI_APP_CORE_ID				0
-
-#endif /* MAIN_TASKS_COMMON_H_ */
@@ -1,13 +1,19 @@
 #include "nvs_flash.h"
 #include "wifi_app.h"
+#include "log_defer.h"
 #include "esp_err.h"
 #include "freertos/timers.h"
-#include "DHT22.h"
+#include "sensor.h"
+#include "sensor_dht22.h"
 
 void
 app_main (void)
 {
 	TickType_t tick_wakeup = xTaskGetTickCount();
+	// Deferred logging first, every later line goes through it
+	//
+	log_defer_start();
+
     // Initialize NVS
 	//
 	esp_err_t ret = nvs_flash_init();
@@ -25,5 +31,7 @@ app_main (void)
 
 	vTaskDelayUntil(&tick_wakeup, 1000 / portTICK_PERIOD_MS);
 
-	dht22_task_start();
+	sensor_dht22_register(CONFIG_SENSOR_DHT22_GPIO,
+						  CONFIG_SENSOR_DHT22_PERIOD_MS, NULL);
+	sensor_task_start();
 }
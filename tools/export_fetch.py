@@ -0,0 +1,107 @@
+#!/usr/bin/env python3
+"""
+Downloads the sensor history from /export.csv or /export.bin, reports the
+transfer throughput and writes the samples as CSV.
+
+    python3 tools/export_fetch.py 192.168.0.1 --format bin -o history.csv
+    python3 tools/export_fetch.py 192.168.0.1 --from-ms 60000 --to-ms 120000
+
+The binary export is decoded here, so both formats give the same CSV,
+UTC times included: the export carries the offset recorded by the first
+SNTP sync of its boot.
+"""
+
+import argparse
+import struct
+import sys
+import time
+import urllib.parse
+import urllib.request
+
+MAGIC = b"SHB2"
+QUANTITIES = ["temperature", "humidity", "pressure", "gas_resistance"]
+UNITS = ["C", "%RH", "Pa", "Ohm"]
+HEADER = "timestamp_ms,sensor_id,quantity,unit,value,tag,boot,utc_ms"
+
+
+def decode_bin(data):
+    if not data.startswith(MAGIC):
+        raise ValueError("not a binary export, magic %r" % data[:4])
+
+    boot, offset_ms = struct.unpack_from("<Hq", data, len(MAGIC))
+    pos = len(MAGIC) + 10
+    timestamp_ms = 0
+    rows = [HEADER]
+
+    while pos < len(data):
+        delta = 0
+        shift = 0
+
+        while True:
+            byte = data[pos]
+            pos += 1
+            delta |= (byte & 0x7F) << shift
+            shift += 7
+
+            if not byte & 0x80:
+                break
+
+        timestamp_ms += delta
+        ids, tag = data[pos], data[pos + 1]
+        value, = struct.unpack_from("<f", data, pos + 2)
+        pos += 6
+        quantity = ids & 0x0F
+        name = QUANTITIES[quantity] if quantity < len(QUANTITIES) else "unknown"
+        unit = UNITS[quantity] if quantity < len(UNITS) else ""
+        utc = "%d" % (timestamp_ms + offset_ms) if offset_ms else ""
+        rows.append("%d,%d,%s,%s,%.2f,%d,%d,%s" % (timestamp_ms, ids >> 4, name,
+                                                   unit, value, tag, boot, utc))
+
+    return "\n".join(rows) + "\n"
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    parser.add_argument("host")
+    parser.add_argument("--port", type=int, default=8080,
+                        help="export server port, 80 without CONFIG_HTTP_SERVER_BULK")
+    parser.add_argument("--format", choices=["csv", "bin"], default="bin")
+    parser.add_argument("--from-ms", type=int)
+    parser.add_argument("--to-ms", type=int)
+    parser.add_argument("-o", "--output", help="CSV file, stdout by default")
+    args = parser.parse_args()
+
+    query = {}
+
+    if args.from_ms is not None:
+        query["from"] = args.from_ms
+
+    if args.to_ms is not None:
+        query["to"] = args.to_ms
+
+    url = "http://%s:%d/export.%s" % (args.host, args.port, args.format)
+
+    if query:
+        url += "?" + urllib.parse.urlencode(query)
+
+    start = time.monotonic()
+
+    with urllib.request.urlopen(url, timeout=60) as resp:
+        data = resp.read()
+
+    elapsed = time.monotonic() - start
+    text = decode_bin(data) if args.format == "bin" else data.decode()
+    samples = text.count("\n") - 1
+    print("%s: %d samples, %d bytes in %.2f s, %.1f KB/s, %.1f bytes/sample"
+          % (url, samples, len(data), elapsed, len(data) / elapsed / 1024,
+             len(data) / max(samples, 1)), file=sys.stderr)
+
+    if args.output:
+        with open(args.output, "w") as f:
+            f.write(text)
+    else:
+        sys.stdout.write(text)
+
+
+if __name__ == "__main__":
+    main()
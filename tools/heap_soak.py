@@ -0,0 +1,154 @@
+#!/usr/bin/env python3
+"""
+Soak test of the heap: scrapes /metrics for hours and reports the worst
+case heap usage and the smallest largest-free-block per heap.
+
+    python3 tools/heap_soak.py 192.168.0.1 --hours 72 -o soak.csv
+    python3 tools/http_tabs_load.py 192.168.0.1 --tabs 4 --duration 259200
+
+Run a load next to it (the dashboard tabs above, OTA uploads, reconnects),
+an idle device does not fragment. The worst case comes from the device's
+own minimums (esp_heap_min_free_bytes and
+esp_heap_largest_free_block_min_bytes), so nothing between two scrapes is
+missed. A reboot resets them: it is counted and the worst case of the
+boot before is kept. Stop early with Ctrl-C, the report is printed anyway.
+"""
+
+import argparse
+import csv
+import re
+import sys
+import time
+import urllib.request
+
+SAMPLE = re.compile(r'^(\w+)(?:\{([^}]*)\})?\s+(\S+)$')
+LABEL = re.compile(r'(\w+)="([^"]*)"')
+
+FIELDS = [
+    "esp_heap_total_bytes",
+    "esp_heap_free_bytes",
+    "esp_heap_min_free_bytes",
+    "esp_heap_largest_free_block_bytes",
+    "esp_heap_largest_free_block_min_bytes",
+]
+
+
+def scrape(host, timeout):
+    """Returns (uptime in seconds, {caps: {field: value}})."""
+    url = "http://%s/metrics" % host
+    with urllib.request.urlopen(url, timeout=timeout) as resp:
+        text = resp.read().decode("utf-8")
+
+    uptime = None
+    heaps = {}
+
+    for line in text.splitlines():
+        match = SAMPLE.match(line)
+        if not match:
+            continue
+        name, labels, value = match.groups()
+        if name == "esp_uptime_seconds":
+            uptime = float(value)
+        elif name in FIELDS:
+            caps = dict(LABEL.findall(labels or "")).get("caps", "")
+            heaps.setdefault(caps, {})[name] = int(float(value))
+
+    return uptime, heaps
+
+
+class Worst:
+    def __init__(self):
+        self.total = 0
+        self.min_free = None
+        self.min_largest = None
+
+    def add(self, fields):
+        self.total = fields.get("esp_heap_total_bytes", self.total)
+        free = fields.get("esp_heap_min_free_bytes")
+        largest = fields.get("esp_heap_largest_free_block_min_bytes")
+        if free is not None and (self.min_free is None or free < self.min_free):
+            self.min_free = free
+        if largest is not None and (self.min_largest is None or largest < self.min_largest):
+            self.min_largest = largest
+
+
+def report(worst, scrapes, failures, reboots, elapsed):
+    print("\n%.1f h, %u scrapes, %u failed, %u reboots"
+          % (elapsed / 3600, scrapes, failures, reboots))
+    print("%-10s %12s %12s %12s" % ("heap", "total", "max used", "min largest"))
+    for caps, w in sorted(worst.items()):
+        used = (w.total - w.min_free) if w.min_free is not None else 0
+        print("%-10s %12u %12u %12s" % (caps, w.total, used,
+                                         "-" if w.min_largest is None else w.min_largest))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    parser.add_argument("host", help="address of the ESP32")
+    parser.add_argument("--hours", type=float, default=72, help="soak duration")
+    parser.add_argument("--interval-s", type=float, default=60, help="time between scrapes")
+    parser.add_argument("--timeout-s", type=float, default=10, help="scrape timeout")
+    parser.add_argument("-o", "--output", help="CSV file for every scrape")
+    args = parser.parse_args()
+
+    worst = {}
+    scrapes = 0
+    failures = 0
+    reboots = 0
+    last_uptime = None
+    start = time.monotonic()
+    writer = None
+    out = None
+
+    if args.output:
+        out = open(args.output, "w", newline="")
+        writer = csv.writer(out)
+        writer.writerow(["time_s", "uptime_s", "caps"] + FIELDS)
+
+    try:
+        while time.monotonic() - start < args.hours * 3600:
+            tick = time.monotonic()
+
+            try:
+                uptime, heaps = scrape(args.host, args.timeout_s)
+            except OSError as err:
+                failures += 1
+                print("scrape failed: %s" % err, file=sys.stderr)
+            else:
+                scrapes += 1
+                if last_uptime is not None and uptime is not None and uptime < last_uptime:
+                    reboots += 1
+                    print("reboot after %.0f s of uptime" % last_uptime, file=sys.stderr)
+                last_uptime = uptime
+
+                for caps, fields in heaps.items():
+                    worst.setdefault(caps, Worst()).add(fields)
+                    if writer:
+                        writer.writerow(["%.0f" % (tick - start), uptime, caps]
+                                        + [fields.get(f, "") for f in FIELDS])
+                if out:
+                    out.flush()
+
+                internal = heaps.get("internal", {})
+                print("%8.0f s  internal free %u, largest %u"
+                      % (tick - start, internal.get("esp_heap_free_bytes", 0),
+                         internal.get("esp_heap_largest_free_block_bytes", 0)))
+
+            time.sleep(max(0, args.interval_s - (time.monotonic() - tick)))
+    except KeyboardInterrupt:
+        pass
+    finally:
+        if out:
+            out.close()
+
+    if not worst:
+        print("no scrape succeeded, is CONFIG_HTTP_SERVER_METRICS enabled?")
+        return 1
+
+    report(worst, scrapes, failures, reboots, time.monotonic() - start)
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,131 @@
+#!/usr/bin/env python3
+"""
+Measures the dashboard latency while a firmware upload is running.
+
+Several clients poll short JSON endpoints, first alone and then during a
+POST /OTAupdate of the given file. esp_http_server of IDF 4.4 runs every
+handler of a server on its single task, so the upload goes to the second
+server (CONFIG_HTTP_SERVER_BULK, --upload-port) and the polls should
+keep their idle latency. With --upload-port 80 on a build without it,
+the polls wait for the whole transfer.
+
+An image that is not valid firmware (random bytes, say) is rejected by
+esp_ota_end(), so the device does not reboot at the end:
+
+    head -c 1500000 /dev/urandom > junk.bin
+    python3 tools/http_parallel_bench.py 192.168.0.1 junk.bin
+"""
+
+import argparse
+import http.client
+import statistics
+import threading
+import time
+
+URIS = ["/dhtSensor.json", "/localTime.json", "/apSSID.json", "/OTAstatus"]
+POST_URIS = {"/OTAstatus"}
+
+
+def poll(host, port, uri, stop, samples, errors):
+    conn = None
+
+    while not stop.is_set():
+        start = time.monotonic()
+
+        try:
+            if conn is None:
+                conn = http.client.HTTPConnection(host, port, timeout=30)
+
+            conn.request("POST" if uri in POST_URIS else "GET", uri)
+            resp = conn.getresponse()
+            resp.read()
+
+            if resp.status == 200:
+                samples.append(time.monotonic() - start)
+            else:
+                errors.append(resp.status)
+        except (OSError, http.client.HTTPException) as exc:
+            errors.append(type(exc).__name__)
+            conn = None
+
+        time.sleep(0.05)
+
+
+def run_clients(args, duration, during=None):
+    stop = threading.Event()
+    samples = []
+    errors = []
+    threads = []
+
+    for idx in range(args.clients):
+        uri = URIS[idx % len(URIS)]
+        thread = threading.Thread(target=poll, daemon=True,
+                                  args=(args.host, args.port, uri, stop,
+                                        samples, errors))
+        thread.start()
+        threads.append(thread)
+
+    if during is None:
+        time.sleep(duration)
+    else:
+        during()
+
+    stop.set()
+
+    for thread in threads:
+        thread.join()
+
+    return samples, errors
+
+
+def upload(args):
+    with open(args.image, "rb") as f:
+        image = f.read()
+
+    boundary = "----benchboundary"
+    body = (("--%s\r\nContent-Disposition: form-data; name=\"file\"; "
+             "filename=\"image.bin\"\r\nContent-Type: "
+             "application/octet-stream\r\n\r\n" % boundary).encode()
+            + image + ("\r\n--%s--\r\n" % boundary).encode())
+    conn = http.client.HTTPConnection(args.host, args.upload_port, timeout=120)
+    start = time.monotonic()
+    conn.request("POST", "/OTAupdate", body,
+                 {"Content-Type": "multipart/form-data; boundary=" + boundary})
+    resp = conn.getresponse()
+    resp.read()
+    elapsed = time.monotonic() - start
+    print("upload: %d bytes in %.1f s (%.1f KB/s), status %d"
+          % (len(body), elapsed, len(body) / elapsed / 1024, resp.status))
+
+
+def report(label, samples, errors):
+    if not samples:
+        print("%-8s no answers, %d errors" % (label, len(errors)))
+        return
+
+    samples.sort()
+    p95 = samples[min(len(samples) - 1, int(len(samples) * 0.95))]
+    print("%-8s %5d requests  median %6.1f ms  p95 %6.1f ms  max %6.1f ms  "
+          "errors %d" % (label, len(samples),
+                         statistics.median(samples) * 1000, p95 * 1000,
+                         samples[-1] * 1000, len(errors)))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    parser.add_argument("host")
+    parser.add_argument("image", help="file POSTed to /OTAupdate")
+    parser.add_argument("--port", type=int, default=80)
+    parser.add_argument("--upload-port", type=int, default=8080,
+                        help="port of /OTAupdate, 80 without CONFIG_HTTP_SERVER_BULK")
+    parser.add_argument("--clients", type=int, default=4)
+    parser.add_argument("--idle", type=float, default=10.0,
+                        help="seconds of polling before the upload")
+    args = parser.parse_args()
+
+    report("idle", *run_clients(args, args.idle))
+    report("upload", *run_clients(args, 0, lambda: upload(args)))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,141 @@
+#!/usr/bin/env python3
+"""
+Simulates dashboard tabs polling the device and reports the request
+latency percentiles.
+
+Every tab runs the polling loops of app.js, each on its own keep-alive
+connection: /dhtSensor.json every 5 s, /localTime.json every 10 s and
+/wifiConnectStatus every 2 s, plus /apSSID.json and /wifiConnectInfo.json
+once when the tab opens. Use --speedup to poll faster than a browser.
+
+    python3 tools/http_tabs_load.py 192.168.0.1 --tabs 6 --duration 60
+
+Connections closed by the server (LRU purge, idle timeout) are counted
+and opened again, like a browser does.
+"""
+
+import argparse
+import http.client
+import threading
+import time
+
+# (method, uri, period in seconds, 0 for once)
+POLLERS = [
+    ("GET", "/dhtSensor.json", 5.0),
+    ("GET", "/localTime.json", 10.0),
+    ("POST", "/wifiConnectStatus", 2.0),
+    ("GET", "/apSSID.json", 0),
+    ("GET", "/wifiConnectInfo.json", 0),
+]
+
+
+class Results:
+    def __init__(self):
+        self.lock = threading.Lock()
+        self.latencies = []
+        self.status = {}
+        self.errors = 0
+        self.reconnects = 0
+
+    def add(self, latency, status):
+        with self.lock:
+            self.status[status] = self.status.get(status, 0) + 1
+
+            if status == 200:
+                self.latencies.append(latency)
+
+    def error(self):
+        with self.lock:
+            self.errors += 1
+
+    def reconnect(self):
+        with self.lock:
+            self.reconnects += 1
+
+
+def poller(args, method, uri, period, stop, results):
+    conn = None
+
+    while not stop.is_set():
+        start = time.monotonic()
+
+        try:
+            if conn is None:
+                conn = http.client.HTTPConnection(args.host, args.port,
+                                                  timeout=args.timeout)
+
+            conn.request(method, uri)
+            resp = conn.getresponse()
+            resp.read()
+            results.add(time.monotonic() - start, resp.status)
+
+            if resp.will_close:
+                conn.close()
+                conn = None
+                results.reconnect()
+        except (OSError, http.client.HTTPException):
+            results.error()
+
+            if conn is not None:
+                conn.close()
+                conn = None
+                results.reconnect()
+
+        if period == 0:
+            break
+
+        stop.wait(max(0.0, period / args.speedup - (time.monotonic() - start)))
+
+    if conn is not None:
+        conn.close()
+
+
+def percentile(values, pct):
+    return values[min(len(values) - 1, int(len(values) * pct / 100.0))]
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    parser.add_argument("host")
+    parser.add_argument("--port", type=int, default=80)
+    parser.add_argument("--tabs", type=int, default=3)
+    parser.add_argument("--duration", type=float, default=60.0)
+    parser.add_argument("--speedup", type=float, default=1.0,
+                        help="divides the polling periods of app.js")
+    parser.add_argument("--timeout", type=float, default=15.0)
+    args = parser.parse_args()
+
+    stop = threading.Event()
+    results = Results()
+    threads = []
+
+    for _ in range(args.tabs):
+        for method, uri, period in POLLERS:
+            thread = threading.Thread(target=poller, daemon=True,
+                                      args=(args, method, uri, period, stop,
+                                            results))
+            thread.start()
+            threads.append(thread)
+
+    time.sleep(args.duration)
+    stop.set()
+
+    for thread in threads:
+        thread.join()
+
+    lat = sorted(results.latencies)
+    print("tabs %d, %d pollers, %.0f s" % (args.tabs, len(threads),
+                                           args.duration))
+    print("status %s, errors %d, reconnects %d"
+          % (dict(sorted(results.status.items())), results.errors,
+             results.reconnects))
+
+    if lat:
+        print("latency ms: p50 %.1f  p90 %.1f  p99 %.1f  max %.1f"
+              % tuple(1000 * v for v in (percentile(lat, 50),
+                                         percentile(lat, 90),
+                                         percentile(lat, 99), lat[-1])))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,114 @@
+/*
+ * multipart_check.c
+ *
+ *  Created on: 19 oct 2026
+ *      Author: Filippo
+ */
+
+// Host check of the OTA upload framing: builds the multipart body a
+// browser's FormData sends around an image, feeds it in chunks like the
+// upload handler does and checks the bytes that come out are the image,
+// closing boundary excluded.
+//
+//   cmake -S tools -B build-host && cmake --build build-host
+//   ./build-host/multipart_check
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "http_server_multipart.h"
+
+#define CHECK_IMAGE_SIZE	100000
+#define CHECK_BODY_SIZE		(CHECK_IMAGE_SIZE + 512)
+
+// Scratch block of the handler (CONFIG_HTTP_SERVER_SCRATCH_BLOCK_SIZE)
+//
+#define CHECK_CHUNK_SIZE	2048
+
+static char g_image[CHECK_IMAGE_SIZE];
+static char g_body[CHECK_BODY_SIZE];
+static char g_out[CHECK_BODY_SIZE];
+
+// One upload, the body cut in chunk_size pieces. Returns 0 when the file
+// comes out whole.
+//
+static int
+check_upload (const char * p_label, const char * p_content_type,
+			  const char * p_boundary, size_t chunk_size)
+{
+	http_server_multipart_t part;
+	size_t body_len = 0;
+	size_t out_len = 0;
+
+	body_len += sprintf(g_body + body_len,
+						"--%s\r\nContent-Disposition: form-data; name=\"file\"; "
+						"filename=\"esp32_wifi.bin\"\r\nContent-Type: "
+						"application/octet-stream\r\n\r\n", p_boundary);
+	memcpy(g_body + body_len, g_image, sizeof(g_image));
+	body_len += sizeof(g_image);
+	body_len += sprintf(g_body + body_len, "\r\n--%s--\r\n", p_boundary);
+
+	http_server_multipart_init(&part, p_content_type, (int32_t) body_len);
+
+	for (size_t pos = 0; pos < body_len; pos += chunk_size)
+	{
+		size_t len = (body_len - pos < chunk_size) ? body_len - pos : chunk_size;
+		const char * p_file = NULL;
+		size_t file_len = 0;
+
+		if (false == http_server_multipart_feed(&part, g_body + pos, len,
+												&p_file, &file_len))
+		{
+			printf("%s: no end of the part headers\n", p_label);
+			return 1;
+		}
+
+		memcpy(g_out + out_len, p_file, file_len);
+		out_len += file_len;
+	}
+
+	if ((sizeof(g_image) != out_len) || (0 != memcmp(g_out, g_image, out_len)))
+	{
+		printf("%s: %zu bytes out for a %zu bytes image\n", p_label, out_len,
+			   sizeof(g_image));
+		return 1;
+	}
+
+	printf("%s: %zu bytes in, the %zu image bytes out\n", p_label, body_len,
+		   out_len);
+
+	return 0;
+}
+
+int
+main (void)
+{
+	int errors = 0;
+
+	srand(1);
+
+	for (size_t idx = 0; idx < sizeof(g_image); ++idx)
+	{
+		g_image[idx] = (char) (rand() & 0xFF);
+	}
+
+	// A blank line inside the image must not end the part headers again
+	//
+	memcpy(g_image + 1000, "\r\n\r\n", 4);
+
+	errors += check_upload("chrome",
+						   "multipart/form-data; boundary=----WebKitFormBoundaryx5Tq3Yk8WbN2rLcD",
+						   "----WebKitFormBoundaryx5Tq3Yk8WbN2rLcD", CHECK_CHUNK_SIZE);
+	errors += check_upload("firefox",
+						   "multipart/form-data; boundary=---------------------------2938475619284756",
+						   "---------------------------2938475619284756", CHECK_CHUNK_SIZE);
+	errors += check_upload("quoted",
+						   "multipart/form-data; boundary=\"benchboundary\"; charset=utf-8",
+						   "benchboundary", CHECK_CHUNK_SIZE);
+	errors += check_upload("small chunks",
+						   "multipart/form-data; boundary=----benchboundary",
+						   "----benchboundary", 300);
+
+	return (errors > 0) ? 1 : 0;
+}
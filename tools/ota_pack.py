@@ -0,0 +1,323 @@
+#!/usr/bin/env python3
+"""
+Makes compressed, delta and signed OTA images for the ota_app component,
+and checks them by applying them here.
+
+    python3 tools/ota_pack.py compress build/app.bin -o app.otaz
+    python3 tools/ota_pack.py delta old/app.bin build/app.bin -o app.otad
+    python3 tools/ota_pack.py store build/app.bin --sign key.pem -o app.ota
+    python3 tools/ota_pack.py apply app.otad --base old/app.bin -o check.bin
+
+--sign adds the signature CONFIG_OTA_APP_SIGNED requires (openssl is used,
+EC or RSA keys). The device gets the public key:
+
+    openssl ecparam -name prime256v1 -genkey -noout -out key.pem
+    openssl ec -in key.pem -pubout -out ota_signing_key.pem
+
+Upload the output through /OTAupdate like a plain image. A delta only
+applies to the image running on the device, identified by its SHA-256.
+Deltas use bsdiff4 when it is installed (pip install bsdiff4), otherwise
+a simpler built-in block matcher.
+"""
+
+import argparse
+import bz2
+import hashlib
+import os
+import struct
+import subprocess
+import sys
+import tempfile
+import time
+import zlib
+
+try:
+    import bsdiff4
+except ImportError:
+    bsdiff4 = None
+
+MAGIC = b"OTAP"
+VERSION = 1
+FORMAT_IMAGE = 1
+FORMAT_COMPRESSED = 2
+FORMAT_DELTA = 3
+# magic, version, format, header_len, target_size, base_size, 2 x SHA-256
+HEADER = struct.Struct("<4sBBHII32s32s")
+RECORD = struct.Struct("<IIi")
+SIGNATURE_SLACK = 8
+ESP_IMAGE_MAGIC = 0xE9
+MATCH_BLOCK = 32
+MATCH_STRIDE = 4
+
+
+def image_sha256(image):
+    """The hash esp_partition_get_sha256() gives for the running app."""
+    if not image or image[0] != ESP_IMAGE_MAGIC:
+        raise ValueError("not an ESP application image")
+
+    # hash_appended flag of esp_image_header_t
+    if image[23] == 1:
+        return image[-32:]
+
+    return hashlib.sha256(image).digest()
+
+
+def bsdiff4_records(base, target):
+    patch = bsdiff4.diff(base, target)
+    magic, ctrl_len, diff_len, _ = struct.unpack("<8sqqq", patch[:32])
+
+    if magic != b"BSDIFF40":
+        raise ValueError("unexpected bsdiff4 output")
+
+    def offtin(raw):
+        value = struct.unpack("<q", raw)[0]
+        return -(value & 0x7FFFFFFFFFFFFFFF) if value < 0 else value
+
+    pos = 32
+    ctrl = bz2.decompress(patch[pos:pos + ctrl_len])
+    pos += ctrl_len
+    diff = bz2.decompress(patch[pos:pos + diff_len])
+    extra = bz2.decompress(patch[pos + diff_len:])
+    diff_pos = extra_pos = 0
+
+    for idx in range(0, len(ctrl), 24):
+        add, copy, seek = (offtin(ctrl[idx + k:idx + k + 8]) for k in (0, 8, 16))
+        yield (add, copy, seek, diff[diff_pos:diff_pos + add],
+               extra[extra_pos:extra_pos + copy])
+        diff_pos += add
+        extra_pos += copy
+
+
+def extend(base, target, base_pos, target_pos):
+    """bsdiff style forward extension: longest run with mostly equal bytes."""
+    best_len = score = best_score = 0
+    idx = 0
+    limit = min(len(base) - base_pos, len(target) - target_pos)
+
+    while idx < limit and idx - best_len < 64:
+        if base[base_pos + idx] == target[target_pos + idx]:
+            score += 1
+
+        idx += 1
+
+        if score * 2 - idx > best_score * 2 - best_len:
+            best_score = score
+            best_len = idx
+
+    return best_len
+
+
+def matcher_records(base, target):
+    index = {}
+
+    for pos in range(0, len(base) - MATCH_BLOCK + 1, MATCH_STRIDE):
+        index.setdefault(base[pos:pos + MATCH_BLOCK], pos)
+
+    matches = []
+    pos = 0
+
+    while pos <= len(target) - MATCH_BLOCK:
+        base_pos = index.get(target[pos:pos + MATCH_BLOCK])
+
+        if base_pos is None:
+            pos += 1
+            continue
+
+        length = extend(base, target, base_pos, pos)
+        matches.append((pos, base_pos, length))
+        pos += length
+
+    # Record i: diff over match i, then the unmatched bytes up to match
+    # i + 1, then a seek to where match i + 1 starts in the base
+    first = matches[0][0] if matches else len(target)
+    yield (0, first, matches[0][1] if matches else 0, b"", target[:first])
+
+    for idx, (pos, base_pos, length) in enumerate(matches):
+        end = matches[idx + 1][0] if idx + 1 < len(matches) else len(target)
+        next_base = matches[idx + 1][1] if idx + 1 < len(matches) else base_pos + length
+        diff = bytes((target[pos + k] - base[base_pos + k]) & 0xFF
+                     for k in range(length))
+        yield (length, end - pos - length, next_base - base_pos - length, diff,
+               target[pos + length:end])
+
+
+def openssl_dgst(args, data):
+    with tempfile.NamedTemporaryFile(delete=False) as f:
+        f.write(data)
+
+    try:
+        return subprocess.run(["openssl", "dgst", "-sha256"] + args + [f.name],
+                              check=True, capture_output=True).stdout
+    finally:
+        os.unlink(f.name)
+
+
+def pack(fmt, target, payload, base=b"", key=None):
+    header_len = HEADER.size
+
+    if key:
+        # DER ECDSA signatures vary by a few bytes, room is kept for the
+        # longest and the rest padded
+        trial = openssl_dgst(["-sign", key], b"")
+        header_len += 2 + len(trial) + SIGNATURE_SLACK
+
+    header = HEADER.pack(MAGIC, VERSION, fmt, header_len, len(target),
+                         len(base), image_sha256(base) if base else bytes(32),
+                         image_sha256(target))
+
+    if key:
+        signature = openssl_dgst(["-sign", key], header)
+        extension = struct.pack("<H", len(signature)) + signature
+
+        if len(extension) > header_len - HEADER.size:
+            raise ValueError("signature longer than expected")
+
+        header += extension.ljust(header_len - HEADER.size, b"\0")
+
+    return header + (payload if fmt == FORMAT_IMAGE else zlib.compress(payload, 9))
+
+
+def make_delta(base, target):
+    if bsdiff4:
+        records = bsdiff4_records(base, target)
+        tool = "bsdiff4"
+    else:
+        records = matcher_records(base, target)
+        tool = "block matcher"
+
+    out = bytearray()
+
+    for add, copy, seek, diff, extra in records:
+        out += RECORD.pack(add, copy, seek) + diff + extra
+
+    return bytes(out), tool
+
+
+def apply(patch, base, public_key=None):
+    magic, version, fmt, header_len, target_size, base_size, base_sha, \
+        target_sha = HEADER.unpack_from(patch)
+
+    if magic != MAGIC or version != VERSION or header_len < HEADER.size:
+        raise ValueError("bad header")
+
+    if public_key:
+        if header_len < HEADER.size + 2:
+            raise ValueError("not signed")
+
+        sig_len = struct.unpack_from("<H", patch, HEADER.size)[0]
+
+        with tempfile.NamedTemporaryFile(delete=False) as f:
+            f.write(patch[HEADER.size + 2:HEADER.size + 2 + sig_len])
+
+        try:
+            openssl_dgst(["-verify", public_key, "-signature", f.name],
+                         patch[:HEADER.size])
+        except subprocess.CalledProcessError:
+            raise ValueError("bad signature")
+        finally:
+            os.unlink(f.name)
+
+    if fmt == FORMAT_IMAGE:
+        data = patch[header_len:header_len + target_size]
+    else:
+        data = zlib.decompressobj().decompress(patch[header_len:])
+
+    if fmt in (FORMAT_IMAGE, FORMAT_COMPRESSED):
+        return check(data, target_size, target_sha)
+
+    if base is None or base_size != len(base) or image_sha256(base) != base_sha:
+        raise ValueError("the delta needs its base image")
+
+    out = bytearray()
+    pos = base_pos = 0
+
+    while pos < len(data):
+        add, copy, seek = RECORD.unpack_from(data, pos)
+        pos += RECORD.size
+        out += bytes((data[pos + k] + base[base_pos + k]) & 0xFF
+                     for k in range(add))
+        pos += add
+        base_pos += add
+        out += data[pos:pos + copy]
+        pos += copy
+        base_pos += seek
+
+    return check(bytes(out), target_size, target_sha)
+
+
+def check(image, target_size, target_sha):
+    if len(image) != target_size:
+        raise ValueError("%d bytes rebuilt, %d expected" % (len(image), target_size))
+
+    if image[23] == 1 and hashlib.sha256(image[:-32]).digest() != image[-32:]:
+        raise ValueError("appended SHA-256 does not match the image")
+
+    if image_sha256(image) != target_sha:
+        raise ValueError("image SHA-256 differs from the header")
+
+    return image
+
+
+def read(path):
+    with open(path, "rb") as f:
+        return f.read()
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    sub = parser.add_subparsers(dest="command", required=True)
+    cmd = sub.add_parser("store", help="plain image, to sign it")
+    cmd.add_argument("image")
+    cmd.add_argument("--sign", metavar="KEY", help="private key (PEM)")
+    cmd.add_argument("-o", "--output", required=True)
+    cmd = sub.add_parser("compress")
+    cmd.add_argument("image")
+    cmd.add_argument("--sign", metavar="KEY", help="private key (PEM)")
+    cmd.add_argument("-o", "--output", required=True)
+    cmd = sub.add_parser("delta")
+    cmd.add_argument("base", help="image running on the device")
+    cmd.add_argument("image")
+    cmd.add_argument("--sign", metavar="KEY", help="private key (PEM)")
+    cmd.add_argument("-o", "--output", required=True)
+    cmd = sub.add_parser("apply")
+    cmd.add_argument("patch")
+    cmd.add_argument("--base")
+    cmd.add_argument("--verify", metavar="KEY", help="public key (PEM)")
+    cmd.add_argument("-o", "--output", required=True)
+    args = parser.parse_args()
+
+    start = time.monotonic()
+
+    if args.command == "apply":
+        out = apply(read(args.patch), read(args.base) if args.base else None,
+                    args.verify)
+        print("%d image bytes rebuilt" % len(out))
+    else:
+        target = read(args.image)
+        base = None
+
+        if args.command == "store":
+            out = pack(FORMAT_IMAGE, target, target, key=args.sign)
+            tool = "stored"
+        elif args.command == "compress":
+            out = pack(FORMAT_COMPRESSED, target, target, key=args.sign)
+            tool = "zlib"
+        else:
+            base = read(args.base)
+            payload, tool = make_delta(base, target)
+            out = pack(FORMAT_DELTA, target, payload, base, args.sign)
+
+        if apply(out, base) != target:
+            sys.exit("self check failed")
+
+        print("%s (%s): %d bytes for a %d byte image, %.1f%% of the transfer, "
+              "%.1f s" % (args.command, tool, len(out), len(target),
+                          100.0 * len(out) / len(target),
+                          time.monotonic() - start))
+
+    with open(args.output, "wb") as f:
+        f.write(out)
+
+
+if __name__ == "__main__":
+    main()
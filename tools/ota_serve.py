@@ -0,0 +1,128 @@
+#!/usr/bin/env python3
+"""
+Local update server for the OTA pull client (CONFIG_OTA_APP_PULL).
+
+    python3 tools/ota_serve.py build/app.bin --version 1.4.0
+    python3 tools/ota_serve.py build/app.bin --version 1.4.0 \\
+        --delta app.otad --base old/app.bin --drop 100000
+
+Serves /manifest.json, /app.bin and, with --delta, /app.delta. Range
+requests are answered with 206 like a CDN would. --drop cuts every
+connection after that many body bytes, so the device has to resume.
+Point CONFIG_OTA_APP_PULL_MANIFEST_URL at http://<host>:<port>/manifest.json.
+"""
+
+import argparse
+import http.server
+import json
+import re
+import socket
+import sys
+
+sys.path.insert(0, __import__("os").path.dirname(__file__))
+
+from ota_pack import image_sha256  # noqa: E402
+
+
+def make_handler(files, manifest, drop):
+    class Handler(http.server.BaseHTTPRequestHandler):
+        protocol_version = "HTTP/1.1"
+
+        def do_GET(self):
+            if self.path == "/manifest.json":
+                self.answer(200, manifest, "application/json")
+                return
+
+            data = files.get(self.path)
+
+            if data is None:
+                self.answer(404, b"not found", "text/plain")
+                return
+
+            match = re.match(r"bytes=(\d+)-(\d*)$", self.headers.get("Range", ""))
+
+            if not match:
+                self.answer(200, data, "application/octet-stream")
+                return
+
+            start = int(match.group(1))
+            end = min(int(match.group(2) or len(data) - 1), len(data) - 1)
+
+            if start >= len(data):
+                self.send_response(416)
+                self.send_header("Content-Range", "bytes */%d" % len(data))
+                self.send_header("Content-Length", "0")
+                self.end_headers()
+                return
+
+            self.answer(206, data[start:end + 1], "application/octet-stream",
+                        {"Content-Range": "bytes %d-%d/%d" % (start, end, len(data))})
+
+        def answer(self, status, body, content_type, headers=None):
+            self.send_response(status)
+            self.send_header("Content-Type", content_type)
+            self.send_header("Content-Length", str(len(body)))
+
+            for key, value in (headers or {}).items():
+                self.send_header(key, value)
+
+            self.end_headers()
+
+            if drop and len(body) > drop and content_type != "application/json":
+                self.wfile.write(body[:drop])
+                self.wfile.flush()
+                self.connection.shutdown(socket.SHUT_RDWR)
+                self.close_connection = True
+                self.log_message("dropped after %d of %d bytes", drop, len(body))
+                return
+
+            self.wfile.write(body)
+
+    return Handler
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    parser.add_argument("image")
+    parser.add_argument("--version", required=True)
+    parser.add_argument("--delta", help="delta made by ota_pack.py")
+    parser.add_argument("--base", help="image the delta applies to")
+    parser.add_argument("--host", default="")
+    parser.add_argument("--port", type=int, default=8070)
+    parser.add_argument("--url", help="base URL the device uses, "
+                        "default http://<this host>:<port>")
+    parser.add_argument("--drop", type=int, default=0,
+                        help="cut connections after this many body bytes")
+    args = parser.parse_args()
+
+    if args.delta and not args.base:
+        parser.error("--delta needs --base")
+
+    base_url = args.url or "http://%s:%d" % (
+        socket.gethostbyname(socket.gethostname()), args.port)
+
+    with open(args.image, "rb") as f:
+        files = {"/app.bin": f.read()}
+
+    manifest = {"version": args.version, "url": base_url + "/app.bin",
+                "sha256": image_sha256(files["/app.bin"]).hex()}
+
+    if args.delta:
+        with open(args.delta, "rb") as f:
+            files["/app.delta"] = f.read()
+
+        with open(args.base, "rb") as f:
+            base_sha = image_sha256(f.read()).hex()
+
+        manifest["delta"] = {"base": base_sha, "url": base_url + "/app.delta"}
+
+    body = json.dumps(manifest, indent=2).encode()
+    print(body.decode())
+
+    server = http.server.ThreadingHTTPServer(
+        (args.host, args.port), make_handler(files, body, args.drop))
+    server.serve_forever()
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,151 @@
+#!/usr/bin/env python3
+"""
+Measures how long a WiFi scan takes the access point off the air, from a
+client connected to it. DNS queries go to the captive portal DNS every
+--interval-ms while /wifiScan.json?refresh=1 starts a scan:
+
+    python3 tools/scan_disruption.py 192.168.0.1
+    python3 tools/scan_disruption.py 192.168.0.1 --interval-ms 10 --baseline-s 5
+
+Reports the round trip before the scan, the queries lost and the longest
+gap without an answer during the scan, next to the scan_ms the ESP32
+reports. The captive portal (CONFIG_WIFI_APP_CAPTIVE_PORTAL) has to be
+enabled, and the cache older than 10 s for the refresh to start a scan.
+"""
+
+import argparse
+import json
+import random
+import socket
+import struct
+import sys
+import time
+import urllib.request
+
+
+def dns_query(ident):
+    # One A question for "scan.test", recursion desired
+    header = struct.pack(">HHHHHH", ident, 0x0100, 1, 0, 0, 0)
+    return header + b"\x04scan\x04test\x00" + struct.pack(">HH", 1, 1)
+
+
+def get_scan(host, refresh, timeout):
+    url = "http://%s/wifiScan.json%s" % (host, "?refresh=1" if refresh else "")
+    with urllib.request.urlopen(url, timeout=timeout) as resp:
+        return json.loads(resp.read().decode("utf-8"))
+
+
+def probe(sock, interval, duration, stop=None):
+    """
+    Sends a query every interval seconds for duration seconds, or until
+    stop() is true. Returns (sent, [(send time, round trip or None)]).
+    """
+    pending = {}
+    results = {}
+    ident = random.randrange(0x10000)
+    start = time.monotonic()
+    next_send = start
+    sent = 0
+
+    while True:
+        now = time.monotonic()
+
+        if (now - start >= duration) or (stop is not None and stop()):
+            break
+
+        if now >= next_send:
+            ident = (ident + 1) & 0xFFFF
+            pending[ident] = now
+            results[ident] = (now, None)
+            sock.send(dns_query(ident))
+            sent += 1
+            next_send += interval
+
+        sock.settimeout(max(0.001, next_send - time.monotonic()))
+
+        try:
+            data = sock.recv(512)
+        except socket.timeout:
+            continue
+
+        if len(data) >= 2:
+            (answer,) = struct.unpack(">H", data[:2])
+            if answer in pending:
+                results[answer] = (pending[answer], time.monotonic() - pending.pop(answer))
+
+    # Late answers still count
+    sock.settimeout(0.5)
+    while pending:
+        try:
+            data = sock.recv(512)
+        except socket.timeout:
+            break
+        (answer,) = struct.unpack(">H", data[:2])
+        if answer in pending:
+            results[answer] = (pending[answer], time.monotonic() - pending.pop(answer))
+
+    return sent, sorted(results.values())
+
+
+def longest_gap(samples):
+    """Longest time between two answered queries, in seconds."""
+    answered = [sent + rtt for sent, rtt in samples if rtt is not None]
+    if len(answered) < 2:
+        return 0.0
+    return max(b - a for a, b in zip(answered, answered[1:]))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    parser.add_argument("host", help="access point address of the ESP32")
+    parser.add_argument("--interval-ms", type=float, default=20, help="time between queries")
+    parser.add_argument("--baseline-s", type=float, default=3, help="probing before the scan")
+    parser.add_argument("--timeout-s", type=float, default=15, help="longest wait for the scan")
+    args = parser.parse_args()
+
+    interval = args.interval_ms / 1000.0
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    sock.connect((args.host, 53))
+
+    sent, samples = probe(sock, interval, args.baseline_s)
+    rtts = sorted(rtt for _, rtt in samples if rtt is not None)
+    if not rtts:
+        print("no DNS answer from %s, is the captive portal enabled?" % args.host)
+        return 1
+    print("baseline: %u/%u answered, median %.1f ms, max %.1f ms"
+          % (len(rtts), sent, rtts[len(rtts) // 2] * 1000, rtts[-1] * 1000))
+
+    scan = get_scan(args.host, True, args.timeout_s)
+    if not scan["scanning"]:
+        print("no scan started, the cache is %d s old" % scan["age_s"])
+        return 1
+
+    # The scan state is polled between probes, not during them
+    state = {"scan": scan, "polled": time.monotonic()}
+
+    def done():
+        now = time.monotonic()
+        if now - state["polled"] >= 0.5:
+            state["polled"] = now
+            try:
+                state["scan"] = get_scan(args.host, False, 2)
+            except OSError:
+                # The HTTP request was lost off channel too
+                return False
+        return not state["scan"]["scanning"]
+
+    sent, samples = probe(sock, interval, args.timeout_s, done)
+    rtts = [rtt for _, rtt in samples if rtt is not None]
+    scan = state["scan"]
+
+    print("scan: %u/%u answered, %u lost, max %.1f ms, longest gap %.1f ms"
+          % (len(rtts), sent, sent - len(rtts), max(rtts, default=0) * 1000,
+             longest_gap(samples) * 1000))
+    print("device: scan_ms %u, %u networks, %u AP clients"
+          % (scan["scan_ms"], len(scan["aps"]), scan["ap_clients"]))
+
+    return 0 if not scan["scanning"] else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,246 @@
+/*
+ * sensor_log_bench.c
+ *
+ *  Created on: 19 oct 2026
+ *      Author: Filippo
+ */
+
+// Host benchmark of the flash history codec: encodes 24 h of DHT22-like
+// samples into flash-sized blocks, checks every sample decodes back and
+// reports bytes per sample and the time to decode the whole range. The
+// timestamp deltas at the edges of every width are checked first, the
+// jitter of the run never reaches them.
+//
+//   cmake -S tools -B build-host && cmake --build build-host
+//   ./build-host/sensor_log_bench [period_ms]
+//
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "sensor_log_codec.h"
+
+// Flash sector minus the block header of sensor_log.c
+//
+#define BENCH_PAYLOAD_SIZE	(4096 - 40)
+#define BENCH_HOURS			24
+#define BENCH_MAX_BLOCKS	1024
+// Two quantities every 500 ms at most
+//
+#define BENCH_MAX_SAMPLES	(BENCH_HOURS * 3600 * 2 * 2)
+
+typedef struct bench_block
+{
+	uint8_t payload[BENCH_PAYLOAD_SIZE];
+	int64_t base_ms;
+	uint32_t count;
+	size_t bytes;
+} bench_block_t;
+
+static bench_block_t g_blocks[BENCH_MAX_BLOCKS];
+static sensor_log_record_t g_expected[BENCH_MAX_SAMPLES];
+
+static double
+bench_now_s (void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Delta of delta values around the 7, 9 and 12 bit fields
+//
+static const int64_t g_edge_dods[] = {
+	-64, 63, 64, -65, 1, -1,
+	-256, 255, 256, -257,
+	-2048, 2047, 2048, -2049
+};
+
+#define BENCH_EDGE_COUNT	(sizeof(g_edge_dods) / sizeof(g_edge_dods[0]))
+
+// Encodes one series with every edge dod and decodes it back, returns
+// the number of wrong timestamps
+//
+static uint32_t
+bench_edges (void)
+{
+	static uint8_t payload[BENCH_PAYLOAD_SIZE];
+	int64_t expected[BENCH_EDGE_COUNT + 1];
+	int64_t delta = 10000;
+	int64_t ts = 0;
+	uint32_t errors = 0;
+	sensor_log_codec_t codec;
+	sensor_log_record_t rec = {0};
+
+	sensor_log_codec_init(&codec, payload, sizeof(payload), 0);
+
+	for (uint32_t idx = 0; idx <= BENCH_EDGE_COUNT; ++idx)
+	{
+		if (idx > 0)
+		{
+			delta += g_edge_dods[idx - 1];
+		}
+
+		ts += delta;
+		rec.timestamp_ms = ts;
+		expected[idx] = ts;
+
+		if (false == sensor_log_codec_put(&codec, &rec))
+		{
+			return BENCH_EDGE_COUNT + 1;
+		}
+	}
+
+	sensor_log_codec_init(&codec, payload, sizeof(payload), 0);
+
+	for (uint32_t idx = 0; idx <= BENCH_EDGE_COUNT; ++idx)
+	{
+		if ((false == sensor_log_codec_get(&codec, &rec)) ||
+			(rec.timestamp_ms != expected[idx]))
+		{
+			fprintf(stderr, "edge dod %lld: timestamp %lld, expected %lld\n",
+					(long long) ((idx > 0) ? g_edge_dods[idx - 1] : 0),
+					(long long) rec.timestamp_ms, (long long) expected[idx]);
+			errors++;
+		}
+	}
+
+	return errors;
+}
+
+// DHT22 gives 0.1 resolution, the median filter keeps it
+//
+static float
+bench_walk (float * p_value, float step, float lo, float hi)
+{
+	*p_value += step * (float) ((rand() % 3) - 1);
+	*p_value = fminf(fmaxf(*p_value, lo), hi);
+
+	return roundf(*p_value * 10.0f) / 10.0f;
+}
+
+int
+main (int argc, char ** argv)
+{
+	int64_t period_ms = (argc > 1) ? atoll(argv[1]) : 4000;
+	uint32_t block_count = 0;
+	uint32_t samples = 0;
+	size_t bytes = 0;
+	float temperature = 21.0f;
+	float humidity = 50.0f;
+	sensor_log_codec_t codec;
+	sensor_log_record_t rec = {0};
+
+	if (period_ms < 500)
+	{
+		fprintf(stderr, "period below 500 ms\n");
+		return 1;
+	}
+
+	if (0 != bench_edges())
+	{
+		return 1;
+	}
+
+	printf("edge deltas: %u dod values decode back\n", (unsigned) BENCH_EDGE_COUNT);
+
+	srand(1);
+	memset(g_blocks, 0, sizeof(g_blocks));
+	sensor_log_codec_init(&codec, g_blocks[0].payload, BENCH_PAYLOAD_SIZE, 0);
+
+	for (int64_t t_ms = 0; t_ms < BENCH_HOURS * 3600LL * 1000; t_ms += period_ms)
+	{
+		// Timer period plus the read back jitter
+		//
+		int64_t ts = t_ms + 25 + (rand() % 7);
+
+		for (uint8_t quantity = 0; quantity < 2; ++quantity)
+		{
+			rec.timestamp_ms = ts;
+			rec.sensor_id = 0;
+			rec.quantity = quantity;
+			rec.tag = 0;
+			rec.value = (0 == quantity) ? bench_walk(&temperature, 0.1f, -10.0f, 40.0f) :
+										  bench_walk(&humidity, 0.1f, 0.0f, 100.0f);
+
+			if (0 == g_blocks[block_count].count)
+			{
+				sensor_log_codec_init(&codec, g_blocks[block_count].payload,
+									  BENCH_PAYLOAD_SIZE, ts);
+				g_blocks[block_count].base_ms = ts;
+			}
+
+			if (false == sensor_log_codec_put(&codec, &rec))
+			{
+				g_blocks[block_count].bytes = sensor_log_codec_bytes(&codec);
+
+				if (++block_count == BENCH_MAX_BLOCKS)
+				{
+					fprintf(stderr, "too many blocks\n");
+					return 1;
+				}
+
+				sensor_log_codec_init(&codec, g_blocks[block_count].payload,
+									  BENCH_PAYLOAD_SIZE, ts);
+				g_blocks[block_count].base_ms = ts;
+				sensor_log_codec_put(&codec, &rec);
+			}
+
+			g_blocks[block_count].count++;
+			g_expected[samples++] = rec;
+		}
+	}
+
+	g_blocks[block_count].bytes = sensor_log_codec_bytes(&codec);
+	block_count++;
+
+	for (uint32_t idx = 0; idx < block_count; ++idx)
+	{
+		bytes += g_blocks[idx].bytes;
+	}
+
+	// 24 h range query: decode every block
+	//
+	double start_s = bench_now_s();
+	uint32_t decoded = 0;
+	uint32_t errors = 0;
+
+	for (uint32_t idx = 0; idx < block_count; ++idx)
+	{
+		sensor_log_codec_init(&codec, g_blocks[idx].payload, BENCH_PAYLOAD_SIZE,
+							  g_blocks[idx].base_ms);
+
+		for (uint32_t rec_idx = 0; rec_idx < g_blocks[idx].count; ++rec_idx)
+		{
+			if (false == sensor_log_codec_get(&codec, &rec))
+			{
+				errors++;
+				break;
+			}
+
+			if ((rec.timestamp_ms != g_expected[decoded].timestamp_ms) ||
+				(rec.value != g_expected[decoded].value) ||
+				(rec.quantity != g_expected[decoded].quantity))
+			{
+				errors++;
+			}
+
+			decoded++;
+		}
+	}
+
+	double decode_s = bench_now_s() - start_s;
+
+	printf("period %lld ms, %u samples in %u blocks of %d bytes\n",
+		   (long long) period_ms, samples, block_count, BENCH_PAYLOAD_SIZE);
+	printf("%.2f bytes/sample (%zu in RAM), %.1f KB of payload per day\n",
+		   (double) bytes / samples, sizeof(sensor_log_record_t), bytes / 1024.0);
+	printf("24 h query: %u samples decoded in %.2f ms, %u errors\n",
+		   decoded, decode_s * 1000, errors);
+
+	return (errors > 0 || decoded != samples) ? 1 : 0;
+}
@@ -0,0 +1,155 @@
+#!/usr/bin/env python3
+"""
+Converts a trace dump of the trace component into Chrome trace JSON
+(chrome://tracing, https://ui.perfetto.dev).
+
+The input is either the binary file from GET /trace.bin or a console log
+containing the TRACE: lines printed by trace_dump_uart().
+
+    curl -o trace.bin http://192.168.0.1/trace.bin
+    python3 tools/trace_to_chrome.py trace.bin -o trace.json
+"""
+
+import argparse
+import json
+import struct
+import sys
+
+MAGIC = b"TRC1"
+EVENT = struct.Struct("<IIIHBB")
+PHASES = {0: "B", 1: "E", 2: "i"}
+
+
+def read_input(path):
+    with open(path, "rb") as f:
+        data = f.read()
+
+    if data.startswith(MAGIC):
+        return data
+
+    # Console capture: concatenate the hex payload of the TRACE: lines
+    hex_data = []
+
+    for line in data.decode("utf-8", "replace").splitlines():
+        pos = line.find("TRACE:")
+
+        if pos < 0:
+            continue
+
+        payload = line[pos + 6:].strip()
+
+        if payload == "BEGIN":
+            hex_data = []
+        elif payload != "END":
+            hex_data.append(payload)
+
+    return bytes.fromhex("".join(hex_data))
+
+
+class Reader:
+    def __init__(self, data):
+        self.data = data
+        self.pos = 0
+
+    def take(self, fmt):
+        values = struct.unpack_from(fmt, self.data, self.pos)
+        self.pos += struct.calcsize(fmt)
+        return values
+
+    def strings(self):
+        (count,) = self.take("<I")
+        table = {}
+
+        for _ in range(count):
+            key, length = self.take("<IH")
+            table[key] = self.data[self.pos:self.pos + length].decode("utf-8", "replace")
+            self.pos += length
+
+        return table
+
+
+def decode(data):
+    if not data.startswith(MAGIC):
+        sys.exit("not a trace dump")
+
+    reader = Reader(data)
+    reader.pos = len(MAGIC)
+    version, cores, ticks_per_us = reader.take("<HHI")
+
+    if version != 1:
+        sys.exit("unsupported trace version %d" % version)
+
+    per_core = []
+
+    for _ in range(cores):
+        (count,) = reader.take("<I")
+        events = [EVENT.unpack_from(data, reader.pos + i * EVENT.size) for i in range(count)]
+        reader.pos += count * EVENT.size
+        per_core.append(events)
+
+    names = reader.strings()
+    tasks = reader.strings()
+
+    return ticks_per_us, per_core, names, tasks
+
+
+def to_chrome(ticks_per_us, per_core, names, tasks):
+    out = []
+
+    for core, events in enumerate(per_core):
+        out.append({"name": "thread_name", "ph": "M", "pid": core, "tid": 0,
+                    "args": {"name": "isr"}})
+        out.append({"name": "process_name", "ph": "M", "pid": core,
+                    "args": {"name": "core %d" % core}})
+
+        # The cycle counter is 32 bit and per core: unwrap it, events of a
+        # core are stored in order. Only a drop of more than half the range
+        # is a wrap, anything smaller would be a reordered event.
+        base = 0
+        last = None
+
+        for cycles, name, task, arg, kind, _ in events:
+            if last is not None and last - cycles > 1 << 31:
+                base += 1 << 32
+
+            last = cycles
+            event = {
+                "name": names.get(name, "0x%08x" % name),
+                "ph": PHASES.get(kind, "i"),
+                "ts": (base + cycles) / ticks_per_us,
+                "pid": core,
+                "tid": task,
+            }
+
+            if kind == 2:
+                event["s"] = "t"
+                event["args"] = {"arg": arg}
+
+            out.append(event)
+
+    seen = {(e["pid"], e["tid"]) for e in out if "tid" in e and e["tid"] != 0}
+
+    for core, task in sorted(seen):
+        out.append({"name": "thread_name", "ph": "M", "pid": core, "tid": task,
+                    "args": {"name": tasks.get(task, "task 0x%08x" % task)}})
+
+    return {"traceEvents": out, "displayTimeUnit": "ns"}
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument("input", help="trace.bin or console log")
+    parser.add_argument("-o", "--output", default="-", help="JSON file (default stdout)")
+    args = parser.parse_args()
+
+    trace = to_chrome(*decode(read_input(args.input)))
+
+    if args.output == "-":
+        json.dump(trace, sys.stdout)
+    else:
+        with open(args.output, "w") as f:
+            json.dump(trace, f)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,79 @@
+#!/usr/bin/env python3
+"""
+Inlines the scripts, style sheets and icon of a page into one gzip file,
+so the page loads in a single request. The http_server component runs
+it at build time on webpage/index.html:
+
+    python3 tools/web_bundle.py components/http_server/webpage/index.html \
+        -o index.html.gz
+
+Only local files referenced by <script src>, <link rel="stylesheet"> and
+<link rel="icon"> are inlined. The output is reproducible: the gzip
+header carries no name and no time.
+"""
+
+import argparse
+import base64
+import gzip
+import os
+import re
+import sys
+
+SCRIPT = re.compile(r"<script\b([^>]*?)\bsrc=['\"]([^'\"]+)['\"]([^>]*)>\s*</script>",
+                    re.IGNORECASE)
+STYLE = re.compile(r"<link\b[^>]*\brel=['\"]stylesheet['\"][^>]*\bhref=['\"]([^'\"]+)['\"][^>]*>",
+                   re.IGNORECASE)
+HEAD_END = re.compile(r"</head>", re.IGNORECASE)
+
+
+def read_text(base, name):
+    with open(os.path.join(base, name), encoding="utf-8") as f:
+        return f.read()
+
+
+def bundle(path, icon):
+    base = os.path.dirname(os.path.abspath(path))
+    html = read_text(base, os.path.basename(path))
+
+    def script(match):
+        attrs = (match.group(1) + match.group(3)).replace("async", "").strip()
+        # A "</script" in a string would end the inline element
+        body = read_text(base, match.group(2)).replace("</script", "<\\/script")
+        return "<script%s>%s</script>" % ((" " + attrs) if attrs else "", body)
+
+    def style(match):
+        return "<style>%s</style>" % read_text(base, match.group(1))
+
+    html = SCRIPT.sub(script, html)
+    html = STYLE.sub(style, html)
+
+    # Without a link the browser asks for /favicon.ico, one more request
+    if icon:
+        with open(os.path.join(base, icon), "rb") as f:
+            data = base64.b64encode(f.read()).decode("ascii")
+        html = HEAD_END.sub(lambda _: '\t<link rel="icon" href="data:image/x-icon;base64,%s">\n\t</head>'
+                            % data, html, count=1)
+
+    return html.encode("utf-8")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    parser.add_argument("page", help="HTML page to bundle")
+    parser.add_argument("-o", "--output", required=True, help="gzip file to write")
+    parser.add_argument("--icon", default="favicon.ico",
+                        help="icon next to the page to inline, '' for none")
+    args = parser.parse_args()
+
+    html = bundle(args.page, args.icon)
+
+    with open(args.output, "wb") as f:
+        f.write(gzip.compress(html, compresslevel=9, mtime=0))
+
+    print("%s: %u bytes, %u gzipped" % (args.output, len(html), os.path.getsize(args.output)))
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())